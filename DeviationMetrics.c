@@ -31,67 +31,94 @@ THE SOFTWARE.
 // This file uses lines up to 100 characters long. If this 100 character line fits then you're good.
 
 #include "PathCompacter.h"
+#include "PathCompacterInternal.h"
+
+#include <stddef.h> // For NULL
 
 // This one just returns the shortest distance to the infinite extension of the line segment.
 static double perpendicularDistance(DVector2D start, DVector2D end, DVector2D mid,
                                     double dSquareSegmentLength)
    {
-   double dArea;
-
-   dArea = start.dX * (mid.dY - end.dY) +
-                  mid.dX * (end.dY - start.dY) +
-                  end.dX * (start.dY - mid.dY);
-
-   return dArea * dArea / dSquareSegmentLength;
+   return compactPathPerpendicularDistance(&start, &end, &mid, dSquareSegmentLength);
    }
 DeviationMetric perpendicularDistanceDeviationMetric = &perpendicularDistance;
 
 static double shortestDistanceToSegment(DVector2D start, DVector2D end, DVector2D mid,
                                         double dSquareSegmentLength)
    {
-   double dAX, dAY, dBX, dBY, dCX, dCY, dAdotB, dBdotC, dArea;
+   return compactPathShortestDistanceToSegment(&start, &end, &mid, dSquareSegmentLength);
+   }
+DeviationMetric shortestDistanceToSegmentDeviationMetric = &shortestDistanceToSegment;
 
-   // Start->End forms vector A.
-   dAX = end.dX - start.dX;
-   dAY = end.dY - start.dY;
+// The geodesic metrics have no use for the planar square segment length, which is worked out from
+// degrees. They prepare their own chord terms on every call here, and once per subproblem in the
+// scans below.
+static double crossTrackDistance(DVector2D start, DVector2D end, DVector2D mid,
+                                 double dSquareSegmentLength)
+   {
+   CompactPathCrossTrackChord chord;
 
-   // Start->Mid forms vector B.
-   dBX = mid.dX - start.dX;
-   dBY = mid.dY - start.dY;
+   (void)dSquareSegmentLength;
 
-   // End->Mid forms vector C;
-   dCX = mid.dX - end.dX;
-   dCY = mid.dY - end.dY;
+   compactPathCrossTrackPrepare(&start, &end, &chord);
+   return compactPathCrossTrackDistance(&chord, &mid);
+   }
+DeviationMetric crossTrackDistanceDeviationMetric = &crossTrackDistance;
 
-   // Find the dot product of A and B.
-   dAdotB = dAX * dBX + dAY * dBY;
+static double ellipsoidalCrossTrackDistance(DVector2D start, DVector2D end, DVector2D mid,
+                                            double dSquareSegmentLength)
+   {
+   CompactPathEllipsoidalChord chord;
 
-   // Find the dot product of B and C;
-   dBdotC = dBX * dCX + dBY * dCY;
+   (void)dSquareSegmentLength;
 
-   // If the signs are different, the closest point on the segment is not an endpoint.
-   if (dAdotB > 0.0 && dBdotC < 0.0)
-      {
-      dArea = 0.5 * (start.dX * (mid.dY - end.dY) +
-                     mid.dX * (end.dY - start.dY) +
-                     end.dX * (start.dY - mid.dY));
+   compactPathEllipsoidalPrepare(&start, &end, &chord);
+   return compactPathEllipsoidalCrossTrackDistance(&chord, &mid);
+   }
+DeviationMetric ellipsoidalCrossTrackDistanceDeviationMetric = &ellipsoidalCrossTrackDistance;
+
+// The callbacks above are only called from compacters that were handed a metric they don't
+// recognize. The compacters look up one of these scans instead, which is the hot loop with the
+// metric inlined and no call per point.
+COMPACT_PATH_DEFINE_MAX_DEVIATION_SCAN(perpendicularDistanceScan, compactPathPerpendicularDistance)
+COMPACT_PATH_DEFINE_MAX_DEVIATION_SCAN(shortestDistanceToSegmentScan,
+                                       compactPathShortestDistanceToSegment)
+COMPACT_PATH_DEFINE_CHORD_MAX_DEVIATION_SCAN(crossTrackDistanceScan, CompactPathCrossTrackChord,
+                                             compactPathCrossTrackPrepare,
+                                             compactPathCrossTrackDistance)
+COMPACT_PATH_DEFINE_CHORD_MAX_DEVIATION_SCAN(ellipsoidalCrossTrackDistanceScan,
+                                             CompactPathEllipsoidalChord,
+                                             compactPathEllipsoidalPrepare,
+                                             compactPathEllipsoidalCrossTrackDistance)
+
+CompactPathMaxDeviationScan compactPathSelectMaxDeviationScan(DeviationMetric deviationMetric)
+   {
+   CompactPathMaxDeviationScan simdScan;
 
-      return dArea * dArea / dSquareSegmentLength;
+   simdScan = compactPathSelectSimdMaxDeviationScan(deviationMetric, compactPathDetectSimdLevel());
+   if (simdScan != NULL)
+      {
+      return simdScan;
       }
 
-   // Otherwise, figure out which endpoint it is closer to.
+   if (deviationMetric == perpendicularDistanceDeviationMetric)
+      {
+      return &perpendicularDistanceScan;
+      }
+   else if (deviationMetric == shortestDistanceToSegmentDeviationMetric)
+      {
+      return &shortestDistanceToSegmentScan;
+      }
+   else if (deviationMetric == crossTrackDistanceDeviationMetric)
+      {
+      return &crossTrackDistanceScan;
+      }
+   else if (deviationMetric == ellipsoidalCrossTrackDistanceDeviationMetric)
+      {
+      return &ellipsoidalCrossTrackDistanceScan;
+      }
    else
       {
-      if (dAdotB < 0.0 && dBdotC < 0.0)
-         {
-         // It is closer to the start point.
-         return dAX * dAX + dAY * dAY;
-         }
-      else
-         {
-         // It is closer to the end point.
-         return dCX * dCX + dCY * dCY;
-         }
+      return &compactPathFindMaxDeviation;
       }
    }
-DeviationMetric shortestDistanceToSegmentDeviationMetric = &shortestDistanceToSegment;
@@ -31,18 +31,21 @@ THE SOFTWARE.
 // This file uses lines up to 100 characters long. If this 100 character line fits then you're good.
 
 #include "PathCompacter.h"
+#include "PathCompacterInternal.h"
 
 #include <stdlib.h> // For memory management
 #include <errno.h> // For the errno global and checking ENOMEM
 #include <string.h> // For memmove and memcpy
-#include <math.h> // For sqrt and fabs
+#include <math.h> // For sqrt, fabs and isfinite
+#include <limits.h> // For INT_MAX
+#include <time.h> // For clock_gettime
 
 // These are out of order for the purposes of struct packing.
 typedef struct CompactPathSubproblemCall
    {
    DVector2D *pPointArray;
    DVector2D *pResultPointArray;
-   int uPointsInCurrentPath;
+   int iPointsInCurrentPath;
    } CompactPathSubproblemCall;
    
 typedef enum CompactPathResultCode
@@ -54,33 +57,41 @@ typedef enum CompactPathResultCode
 
 #define FAILURE 0
 #define SUCCESS 1
+
+// The planar metrics square an area made of products of coordinates, which is at most 6 times the
+// square of the largest coordinate. Below this magnitude the square of that can't overflow, so
+// neither can anything else they compute, and they can't come out as inf divided by inf.
+#define COMPACT_PATH_VALIDATED_MAX_COORDINATE 1e76
    
 static CompactPathResultCode compactPathSubproblemSolver(DVector2D *pPointArray,
-      unsigned int uPointsInCurrentPath, DVector2D *pResultPointArray,
-      unsigneed int *puPointsInResultPath, int *piDivisionIndex, double dEpsilon,
-      DeviationMetric deviationMetric);
+      int iPointsInCurrentPath, DVector2D *pResultPointArray,
+      int *piPointsInResultPath, int *piDivisionIndex, double dEpsilon,
+      CompactPathMaxDeviationScan maxDeviationScan, DeviationMetric deviationMetric,
+      const PathCompacterMetric *pMetric);
 
 // The call stack will start able to hold this many calls and grow by this amount whenever it needs
 // to grow in size.
 #define COMPACT_PATH_CALL_STACK_UNIT 2048
 
-// callStackBase is a double pointer because realloc might move the base pointer.
-static int compactPathCallStackPush(CompactPathSubproblemCall **ppCallStackBase,
+// callStackBase is a double pointer because growing the scratch memory might move the base pointer.
+static int compactPathCallStackPush(PathCompacterContext *pContext,
+                                    CompactPathSubproblemCall **ppCallStackBase,
                                     int *piCallStackCapacity, int *piNumCallsInStack,
                                     CompactPathSubproblemCall *pCall)
    {
    // Check if the stack is full.
    if (*piNumCallsInStack >= *piCallStackCapacity)
       {
-      // Grow the stack by a unit.
-      *piCallStackCapacity += COMPACT_PATH_CALL_STACK_UNIT;
-      *ppCallStackBase = realloc(*ppCallStackBase,
-                                 sizeof(CompactPathSubproblemCall) * *piCallStackCapacity);
-      if (errno || *ppCallStackBase == NULL)
+      // Grow the stack by a unit, keeping the calls that are already in it.
+      *ppCallStackBase = (CompactPathSubproblemCall *)compactPathContextGrowScratch(pContext,
+         sizeof(CompactPathSubproblemCall) * (*piCallStackCapacity + COMPACT_PATH_CALL_STACK_UNIT),
+         sizeof(CompactPathSubproblemCall) * *piNumCallsInStack);
+      if (*ppCallStackBase == NULL)
          {
          // The stack can't grow.
          return FAILURE;
          }
+      *piCallStackCapacity = (int)(pContext->uScratchBytes / sizeof(CompactPathSubproblemCall));
       }
       
       // Add the new call
@@ -107,12 +118,23 @@ static int compactPathCallStackPop(CompactPathSubproblemCall *pCallStackBase,
       }
    }
 
+// Only used when statistics are being collected.
+static double compactPathSecondsNow(void)
+   {
+   struct timespec now;
+
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   return (double)now.tv_sec + 1e-9 * (double)now.tv_nsec;
+   }
+
 // This is the cleanup macro for the CompactPath function.
-// Free the only allocated memory and return the parameter
-// as the return value.
+// The call stack belongs to the context, which outlives the call, so there is nothing to free.
 #define COMPACT_PATH_RETURN(iReturnValue)\
    {\
-   free(pCallStackBase);\
+   if (pStats != NULL)\
+      {\
+      pStats->dTotalSeconds = compactPathSecondsNow() - dStartSeconds;\
+      }\
    return iReturnValue;\
    }
    
@@ -129,17 +151,177 @@ int compactPath(DVector2D *pPointArray, unsigned int uPointsInCurrentPath,
                 DVector2D *pResultPointArray, unsigned int *puPointsInResultPath,
                 double dEpsilon, DeviationMetric deviationMetric)
    {
+   PathCompacterContext context;
+   int iSuccess;
+
+   // A context that lives just for this call behaves like the old call stack did: it gets
+   // allocated with malloc at the start and freed at the end.
+   compactPathContextInit(&context, NULL, NULL, NULL);
+
+   iSuccess = compactPathWithContext(&context, pPointArray, uPointsInCurrentPath,
+                                     pResultPointArray, puPointsInResultPath, dEpsilon,
+                                     deviationMetric);
+
+   compactPathContextRelease(&context);
+
+   return iSuccess;
+   }
+
+int compactPathValidated(DVector2D *pPointArray, unsigned int uPointsInCurrentPath,
+                         DVector2D *pResultPointArray, unsigned int *puPointsInResultPath,
+                         double dEpsilon, DeviationMetric deviationMetric)
+   {
+   unsigned int u;
+
+   if (uPointsInCurrentPath > INT_MAX || pPointArray == NULL || pResultPointArray == NULL ||
+       puPointsInResultPath == NULL || deviationMetric == NULL || !isfinite(dEpsilon) ||
+       dEpsilon < 0.0)
+      {
+      errno = EINVAL;
+      return FAILURE;
+      }
+
+   // With every coordinate finite and small enough that the squares can't overflow, the built in
+   // metrics can't produce a NaN, so compactPath doesn't have to look out for them point by point.
+   // The comparisons are false for NaNs, so they are caught here as well.
+   for (u = 0; u < uPointsInCurrentPath; ++u)
+      {
+      if (!(fabs(pPointArray[u].dX) <= COMPACT_PATH_VALIDATED_MAX_COORDINATE) ||
+          !(fabs(pPointArray[u].dY) <= COMPACT_PATH_VALIDATED_MAX_COORDINATE))
+         {
+         errno = EINVAL;
+         return FAILURE;
+         }
+      }
+
+   return compactPath(pPointArray, uPointsInCurrentPath, pResultPointArray,
+                      puPointsInResultPath, dEpsilon, deviationMetric);
+   }
+
+int compactPathWithStats(DVector2D *pPointArray, unsigned int uPointsInCurrentPath,
+                         DVector2D *pResultPointArray, unsigned int *puPointsInResultPath,
+                         double dEpsilon, DeviationMetric deviationMetric,
+                         PathCompacterStats *pStats)
+   {
+   PathCompacterContext context;
+   int iSuccess;
+
+   compactPathContextInit(&context, NULL, NULL, NULL);
+   compactPathContextSetStats(&context, pStats);
+
+   iSuccess = compactPathWithContext(&context, pPointArray, uPointsInCurrentPath,
+                                     pResultPointArray, puPointsInResultPath, dEpsilon,
+                                     deviationMetric);
+
+   compactPathContextRelease(&context);
+
+   return iSuccess;
+   }
+
+int compactPathWithMetric(DVector2D *pPointArray, unsigned int uPointsInCurrentPath,
+                          DVector2D *pResultPointArray, unsigned int *puPointsInResultPath,
+                          double dEpsilon, const PathCompacterMetric *pMetric)
+   {
+   PathCompacterContext context;
+   int iSuccess;
+
+   if (pMetric == NULL || pMetric->prepare == NULL || pMetric->evaluate == NULL)
+      {
+      return FAILURE;
+      }
+
+   compactPathContextInit(&context, NULL, NULL, NULL);
+   compactPathContextSetMetric(&context, pMetric);
+
+   iSuccess = compactPathWithContext(&context, pPointArray, uPointsInCurrentPath,
+                                     pResultPointArray, puPointsInResultPath, dEpsilon, NULL);
+
+   compactPathContextRelease(&context);
+
+   return iSuccess;
+   }
+
+int compactPathWithEngine(PathCompacterEngine engine, DVector2D *pPointArray,
+                          unsigned int uPointsInCurrentPath, DVector2D *pResultPointArray,
+                          unsigned int *puPointsInResultPath, double dEpsilon,
+                          DeviationMetric deviationMetric)
+   {
+   switch (engine)
+      {
+      case PATH_COMPACTER_ENGINE_ITERATIVE:
+         return compactPath(pPointArray, uPointsInCurrentPath, pResultPointArray,
+                            puPointsInResultPath, dEpsilon, deviationMetric);
+      case PATH_COMPACTER_ENGINE_RECURSIVE:
+         return compactPathRecursive(pPointArray, uPointsInCurrentPath, pResultPointArray,
+                                     puPointsInResultPath, dEpsilon, deviationMetric);
+      case PATH_COMPACTER_ENGINE_HULL:
+         return compactPathHull(pPointArray, uPointsInCurrentPath, pResultPointArray,
+                                puPointsInResultPath, dEpsilon, deviationMetric);
+      case PATH_COMPACTER_ENGINE_BOUNDED:
+         return compactPathBounded(pPointArray, uPointsInCurrentPath, pResultPointArray,
+                                   puPointsInResultPath, dEpsilon, deviationMetric);
+      case PATH_COMPACTER_ENGINE_VISVALINGAM:
+         return compactPathVisvalingam(pPointArray, uPointsInCurrentPath, pResultPointArray,
+                                       puPointsInResultPath, dEpsilon);
+      case PATH_COMPACTER_ENGINE_REUMANN_WITKAM:
+         return compactPathReumannWitkam(pPointArray, uPointsInCurrentPath, pResultPointArray,
+                                         puPointsInResultPath, dEpsilon, deviationMetric);
+      case PATH_COMPACTER_ENGINE_RADIAL_THEN_RDP:
+         return compactPathRadialThenRdp(pPointArray, uPointsInCurrentPath, pResultPointArray,
+                                         puPointsInResultPath, dEpsilon, deviationMetric);
+      default:
+         return FAILURE;
+      }
+   }
+
+int compactPathWithContext(PathCompacterContext *pContext, DVector2D *pPointArray,
+                           unsigned int uPointsInCurrentPath, DVector2D *pResultPointArray,
+                           unsigned int *puPointsInResultPath, double dEpsilon,
+                           DeviationMetric deviationMetric)
+   {
    CompactPathSubproblemCall current, firstSubproblem, secondSubproblem;
    int iDivisionIndex; // Where should we split the problem into subproblems?
    CompactPathResultCode subproblemResultCode; // The status of the most recent subproblem call
    int iNumSolvedPoints; // Keep track of how much of the result array is solved and in place.
-   int uPointsInResultPath; // Number of valid points in the result array after a subproblem call
+   int iPointsInResultPath; // Number of valid points in the result array after a subproblem call
    int iCallStackCapacity; // How many calls can the call stack hold right now?
    int iNumCallsInStack; // How many calls are in the call stack right now?
-   
+   CompactPathMaxDeviationScan maxDeviationScan; // The scan that goes with deviationMetric
+   PathCompacterStats *pStats; // Where to collect statistics, or NULL to not collect them
+   double dStartSeconds, dPhaseStartSeconds; // Only used for the statistics
+
    // Clear errno so that we can be sure that a nonzero value is caused by this function.
    errno = 0;
 
+   pStats = pContext->pStats;
+   dStartSeconds = 0.0;
+   dPhaseStartSeconds = 0.0;
+   if (pStats != NULL)
+      {
+      memset(pStats, 0, sizeof(PathCompacterStats));
+      dStartSeconds = compactPathSecondsNow();
+      }
+
+   // Check for invalid values. The subproblems count their points with an int, and there has to be
+   // a metric, either from the context or from the argument.
+   if (uPointsInCurrentPath > INT_MAX || pPointArray == NULL || pResultPointArray == NULL ||
+       puPointsInResultPath == NULL || !(dEpsilon >= 0.0) ||
+       (pContext->pMetric == NULL && deviationMetric == NULL))
+      {
+      COMPACT_PATH_RETURN(FAILURE);
+      }
+
+   // An empty path doesn't even have a first point to copy.
+   if (uPointsInCurrentPath == 0)
+      {
+      *puPointsInResultPath = 0;
+      COMPACT_PATH_RETURN(SUCCESS);
+      }
+
+   // Look up the scan for the metric once, so the subproblems don't have to. It goes unused if
+   // the context has a PathCompacterMetric.
+   maxDeviationScan = compactPathSelectMaxDeviationScan(deviationMetric);
+
    // Copy the first point into the result. This can be done because its final location is
    // known (it will still be the first point), and it will certainly be in the final array
    // (it can never be removed).
@@ -149,27 +331,36 @@ int compactPath(DVector2D *pPointArray, unsigned int uPointsInCurrentPath,
    *pResultPointArray = *pPointArray;
    iNumSolvedPoints = 1;
    
-   // Allocate a call stack.
-   iCallStackCapacity = COMPACT_PATH_CALL_STACK_UNIT;
+   // Get a call stack from the context. A context that has been used before already has one that
+   // is big enough for most paths, so this usually doesn't allocate anything.
    iNumCallsInStack = 0;
    CompactPathSubproblemCall *pCallStackBase = (CompactPathSubproblemCall *)
-      malloc(sizeof(CompactPathSubproblemCall) * COMPACT_PATH_CALL_STACK_UNIT);
+      compactPathContextGrowScratch(pContext,
+         sizeof(CompactPathSubproblemCall) * COMPACT_PATH_CALL_STACK_UNIT, 0);
    
-   if (errno || pCallStackBase == NULL)
+   if (pCallStackBase == NULL)
       {
       COMPACT_PATH_RETURN(FAILURE);
       }
+   iCallStackCapacity = (int)(pContext->uScratchBytes / sizeof(CompactPathSubproblemCall));
 
    // Set up the first instance of the problem, representing the whole problem.
    current.pPointArray = pPointArray; 
    current.pResultPointArray = pResultPointArray;
-   current.uPointsInCurrentPath = uPointsInCurrentPath;
+   current.iPointsInCurrentPath = uPointsInCurrentPath;
    
    // Add the first instance to the stack
-   if (!compactPathCallStackPush(&pCallStackBase, &iCallStackCapacity, &iNumCallsInStack, &current))
+   if (!compactPathCallStackPush(pContext, &pCallStackBase, &iCallStackCapacity,
+                                 &iNumCallsInStack, &current))
       {
       COMPACT_PATH_RETURN(FAILURE);
       }
+
+   if (pStats != NULL)
+      {
+      pStats->uMaxStackDepth = 1;
+      pStats->dSetupSeconds = compactPathSecondsNow() - dStartSeconds;
+      }
    
    // As long as there are calls on the stack, pop one and process it.
    while (iNumCallsInStack > 0)
@@ -179,13 +370,39 @@ int compactPath(DVector2D *pPointArray, unsigned int uPointsInCurrentPath,
          COMPACT_PATH_RETURN(FAILURE);
          }
       
+      if (pStats != NULL)
+         {
+         dPhaseStartSeconds = compactPathSecondsNow();
+         }
+
       subproblemResultCode = compactPathSubproblemSolver(current.pPointArray,
-         current.uPointsInCurrentPath, current.pResultPointArray, &uPointsInResultPath,
-         &iDivisionIndex, dEpsilon, deviationMetric);
+         current.iPointsInCurrentPath, current.pResultPointArray, &iPointsInResultPath,
+         &iDivisionIndex, dEpsilon, maxDeviationScan, deviationMetric, pContext->pMetric);
+
+      if (pStats != NULL)
+         {
+         pStats->dScanSeconds += compactPathSecondsNow() - dPhaseStartSeconds;
+         if (current.iPointsInCurrentPath >= 3)
+            {
+            pStats->uMetricEvaluations += (unsigned long long)(current.iPointsInCurrentPath - 2);
+            }
+         if (subproblemResultCode == COMPACT_PATH_RESULT_CODE_DIVIDE)
+            {
+            ++pStats->uDivides;
+            }
+         else if (subproblemResultCode == COMPACT_PATH_RESULT_CODE_LINEARIZE)
+            {
+            ++pStats->uLinearizes;
+            }
+         else
+            {
+            ++pStats->uSolved;
+            }
+         }
 
       if (subproblemResultCode == COMPACT_PATH_RESULT_CODE_DIVIDE)
          {
-         if (iDivisionIndex <= 0 || iDivisionIndex >= current.uPointsInCurrentPath)
+         if (iDivisionIndex <= 0 || iDivisionIndex >= current.iPointsInCurrentPath)
             {
             COMPACT_PATH_RETURN(FAILURE);
             }
@@ -200,8 +417,8 @@ int compactPath(DVector2D *pPointArray, unsigned int uPointsInCurrentPath,
 
             secondSubproblem.pPointArray = current.pPointArray + iDivisionIndex;
             secondSubproblem.pResultPointArray = current.pResultPointArray + iDivisionIndex;
-            secondSubproblem.uPointsInCurrentPath = current.uPointsInCurrentPath - iDivisionIndex;
-            if (!compactPathCallStackPush(&pCallStackBase, &iCallStackCapacity,
+            secondSubproblem.iPointsInCurrentPath = current.iPointsInCurrentPath - iDivisionIndex;
+            if (!compactPathCallStackPush(pContext, &pCallStackBase, &iCallStackCapacity,
                                           &iNumCallsInStack, &secondSubproblem))
                {
                COMPACT_PATH_RETURN(FAILURE);
@@ -209,12 +426,17 @@ int compactPath(DVector2D *pPointArray, unsigned int uPointsInCurrentPath,
             
             firstSubproblem.pPointArray = current.pPointArray;
             firstSubproblem.pResultPointArray = current.pResultPointArray;
-            firstSubproblem.uPointsInCurrentPath = iDivisionIndex + 1;
-            if (!compactPathCallStackPush(&pCallStackBase, &iCallStackCapacity,
+            firstSubproblem.iPointsInCurrentPath = iDivisionIndex + 1;
+            if (!compactPathCallStackPush(pContext, &pCallStackBase, &iCallStackCapacity,
                                           &iNumCallsInStack, &firstSubproblem))
                {
                COMPACT_PATH_RETURN(FAILURE);
                }
+
+            if (pStats != NULL && (unsigned long long)iNumCallsInStack > pStats->uMaxStackDepth)
+               {
+               pStats->uMaxStackDepth = (unsigned long long)iNumCallsInStack;
+               }
             }
          }
       else if (subproblemResultCode == COMPACT_PATH_RESULT_CODE_LINEARIZE ||
@@ -224,13 +446,24 @@ int compactPath(DVector2D *pPointArray, unsigned int uPointsInCurrentPath,
 
          // Always skip copying the first point.
          ++current.pResultPointArray;
-         --uPointsInResultPath;
+         --iPointsInResultPath;
          
+         if (pStats != NULL)
+            {
+            dPhaseStartSeconds = compactPathSecondsNow();
+            }
+
          // There's a good chance that the memory regions will overlap at some point.
          memmove(pResultPointArray + iNumSolvedPoints, current.pResultPointArray,
-                 sizeof(DVector2D) * uPointsInResultPath);
+                 sizeof(DVector2D) * iPointsInResultPath);
+
+         if (pStats != NULL)
+            {
+            pStats->dMoveSeconds += compactPathSecondsNow() - dPhaseStartSeconds;
+            pStats->uBytesMoved += sizeof(DVector2D) * (unsigned long long)iPointsInResultPath;
+            }
          
-         iNumSolvedPoints += uPointsInResultPath;
+         iNumSolvedPoints += iPointsInResultPath;
          }
       else
          {
@@ -254,35 +487,73 @@ int compactPath(DVector2D *pPointArray, unsigned int uPointsInCurrentPath,
 // do any further work on the subproblem, because it is already solved. In this case, divisionIndex
 // is not set.
 static CompactPathResultCode compactPathSubproblemSolver(DVector2D *pPointArray,
-      int uPointsInCurrentPath, DVector2D *pResultPointArray,
-      int *puPointsInResultPath, int *piDivisionIndex, double dEpsilon,
-      DeviationMetric deviationMetric)
+      int iPointsInCurrentPath, DVector2D *pResultPointArray,
+      int *piPointsInResultPath, int *piDivisionIndex, double dEpsilon,
+      CompactPathMaxDeviationScan maxDeviationScan, DeviationMetric deviationMetric,
+      const PathCompacterMetric *pMetric)
    {
-   double dSquareSegLen, dSquareDeviation, dMaxSquareDeviationInThisSegment, dDX, dDY;
-   int i, iMaxPointIndex;
+   double dMaxSquareDeviationInThisSegment;
+   int iMaxPointIndex;
    
    // If there are fewer than three points provided, the problem is solved already.
-   if (uPointsInCurrentPath < 3)
+   if (iPointsInCurrentPath < 3)
       {
       // Just copy pointArray into resultPointArray.
-      if (uPointsInCurrentPath > 0)
+      if (iPointsInCurrentPath > 0)
          {
-            memcpy(pResultPointArray, pPointArray, sizeof(DVector2D) * uPointsInCurrentPath);
+            memcpy(pResultPointArray, pPointArray, sizeof(DVector2D) * iPointsInCurrentPath);
          }
-      *puPointsInResultPath = uPointsInCurrentPath;
+      *piPointsInResultPath = iPointsInCurrentPath;
       return COMPACT_PATH_RESULT_CODE_SOLVED;
       }
    
+   if (pMetric != NULL)
+      {
+      iMaxPointIndex = compactPathFindMaxDeviationWithMetric(pPointArray, iPointsInCurrentPath,
+                                                             pMetric,
+                                                             &dMaxSquareDeviationInThisSegment);
+      }
+   else
+      {
+      iMaxPointIndex = maxDeviationScan(pPointArray, iPointsInCurrentPath, deviationMetric,
+                                        &dMaxSquareDeviationInThisSegment);
+      }
+   
+   // A subproblem whose points all lie on the segment linearizes even when epsilon is zero.
+   if (dMaxSquareDeviationInThisSegment < dEpsilon * dEpsilon || iMaxPointIndex <= 0)
+      {
+      // Linearize the points in the subproblem.
+      // To do this, we just copy the first and last points to the result array.
+      pResultPointArray[0] = pPointArray[0];
+      pResultPointArray[1] = pPointArray[iPointsInCurrentPath - 1];
+      *piPointsInResultPath = 2;
+      return COMPACT_PATH_RESULT_CODE_LINEARIZE;
+      }
+   else
+      {
+      // Split the subproblem.
+      *piDivisionIndex = iMaxPointIndex;
+      return COMPACT_PATH_RESULT_CODE_DIVIDE;
+      }
+   }
+
+int compactPathFindMaxDeviation(const DVector2D *pPointArray, int iPointsInCurrentPath,
+                                DeviationMetric deviationMetric, double *pdMaxSquareDeviation)
+   {
+   double dSquareSegLen, dSquareDeviation, dMaxSquareDeviationInThisSegment, dDX, dDY;
+   int i, iMaxPointIndex;
+
    dMaxSquareDeviationInThisSegment = 0.0;
+   iMaxPointIndex = 0;
 
-   dDX = pPointArray[uPointsInCurrentPath - 1].dX - pPointArray[0].dX;
-   dDY = pPointArray[uPointsInCurrentPath - 1].dY - pPointArray[0].dY;
+   dDX = pPointArray[iPointsInCurrentPath - 1].dX - pPointArray[0].dX;
+   dDY = pPointArray[iPointsInCurrentPath - 1].dY - pPointArray[0].dY;
    dSquareSegLen = dDX * dDX + dDY * dDY;
    
-   for (i = 1; i < uPointsInCurrentPath - 1; ++i)
+   for (i = 1; i < iPointsInCurrentPath - 1; ++i)
       {
       dSquareDeviation = deviationMetric(pPointArray[0],
-         pPointArray[uPointsInCurrentPath - 1], pPointArray[i], dSquareSegLen);
+         pPointArray[iPointsInCurrentPath - 1], pPointArray[i], dSquareSegLen);
 
       if (dSquareDeviation > dMaxSquareDeviationInThisSegment)
          {
@@ -290,20 +561,142 @@ static CompactPathResultCode compactPathSubproblemSolver(DVector2D *pPointArray,
          dMaxSquareDeviationInThisSegment = dSquareDeviation;
          }
       }
-   
-   if (dMaxSquareDeviationInThisSegment < dEpsilon * dEpsilon)
+
+   *pdMaxSquareDeviation = dMaxSquareDeviationInThisSegment;
+   return iMaxPointIndex;
+   }
+
+int compactPathFindMaxDeviationWithMetric(const DVector2D *pPointArray, int iPointsInCurrentPath,
+                                          const PathCompacterMetric *pMetric,
+                                          double *pdMaxSquareDeviation)
+   {
+   double adState[PATH_COMPACTER_METRIC_STATE_DOUBLES];
+   double dMaxSquareDeviationInThisSegment;
+   unsigned int uMaxIndex;
+
+   pMetric->prepare(pMetric->pUserData, pPointArray, pPointArray + iPointsInCurrentPath - 1,
+                    adState);
+
+   dMaxSquareDeviationInThisSegment = 0.0;
+   uMaxIndex = 0;
+   pMetric->evaluate(pMetric->pUserData, adState, pPointArray + 1,
+                     (unsigned int)(iPointsInCurrentPath - 2), &uMaxIndex,
+                     &dMaxSquareDeviationInThisSegment);
+
+   // Hold the metric to the same contract as the scans. An index past the end becomes one that
+   // the caller rejects, rather than one that reads outside the subproblem.
+   if (!(dMaxSquareDeviationInThisSegment > 0.0))
       {
-      // Linearize the points in the subproblem.
-      // To do this, we just copy the first and last points to the result array.
-      pResultPointArray[0] = pPointArray[0];
-      pResultPointArray[1] = pPointArray[uPointsInCurrentPath - 1];
-      *puPointsInResultPath = 2;
-      return COMPACT_PATH_RESULT_CODE_LINEARIZE;
+      *pdMaxSquareDeviation = 0.0;
+      return 0;
       }
-   else
+
+   *pdMaxSquareDeviation = dMaxSquareDeviationInThisSegment;
+   if (uMaxIndex >= (unsigned int)(iPointsInCurrentPath - 2))
       {
-      // Split the subproblem.
-      *piDivisionIndex = iMaxPointIndex;
-      return COMPACT_PATH_RESULT_CODE_DIVIDE;
+      return iPointsInCurrentPath;
       }
+   return (int)uMaxIndex + 1;
+   }
+
+// The marker's stack only ever holds the larger halves of the subproblems it has divided, so
+// each entry is at most half the size of the one below it. 64 entries covers any int-sized path.
+#define COMPACT_PATH_MARK_STACK_DEPTH 64
+
+typedef struct CompactPathMarkCall
+   {
+   int iStart;
+   int iPointsInCurrentPath;
+   } CompactPathMarkCall;
+
+// Both kinds of marking share this. With iBitmap set, pKeep holds one bit per point instead of
+// one byte, and bit i is (pKeep[i / 8] >> (i % 8)) & 1.
+static int compactPathMarkKeptPoints(const DVector2D *pPointArray, int iPointsInCurrentPath,
+                                     unsigned char *pKeep, int iBitmap, double dEpsilon,
+                                     CompactPathMaxDeviationScan maxDeviationScan,
+                                     DeviationMetric deviationMetric)
+   {
+   CompactPathMarkCall callStack[COMPACT_PATH_MARK_STACK_DEPTH];
+   CompactPathMarkCall current;
+   int iNumCallsInStack, iDivisionIndex, iFirstPoints, iSecondPoints;
+   double dMaxSquareDeviation;
+
+   iNumCallsInStack = 0;
+   current.iStart = 0;
+   current.iPointsInCurrentPath = iPointsInCurrentPath;
+
+   for (;;)
+      {
+      // Subproblems with fewer than three points are already solved, and the ones that are
+      // linearized lose all of their intermediate points. Neither has anything to mark.
+      if (current.iPointsInCurrentPath >= 3)
+         {
+         iDivisionIndex = maxDeviationScan(pPointArray + current.iStart,
+            current.iPointsInCurrentPath, deviationMetric, &dMaxSquareDeviation);
+
+         if (!(dMaxSquareDeviation < dEpsilon * dEpsilon) && iDivisionIndex > 0)
+            {
+            if (iBitmap)
+               {
+               pKeep[(current.iStart + iDivisionIndex) >> 3] |=
+                  (unsigned char)(1 << ((current.iStart + iDivisionIndex) & 7));
+               }
+            else
+               {
+               pKeep[current.iStart + iDivisionIndex] = 1;
+               }
+
+            iFirstPoints = iDivisionIndex + 1;
+            iSecondPoints = current.iPointsInCurrentPath - iDivisionIndex;
+
+            // Save the larger side and keep going with the smaller one.
+            if (iNumCallsInStack >= COMPACT_PATH_MARK_STACK_DEPTH)
+               {
+               return FAILURE;
+               }
+
+            if (iFirstPoints > iSecondPoints)
+               {
+               callStack[iNumCallsInStack].iStart = current.iStart;
+               callStack[iNumCallsInStack].iPointsInCurrentPath = iFirstPoints;
+               current.iStart += iDivisionIndex;
+               current.iPointsInCurrentPath = iSecondPoints;
+               }
+            else
+               {
+               callStack[iNumCallsInStack].iStart = current.iStart + iDivisionIndex;
+               callStack[iNumCallsInStack].iPointsInCurrentPath = iSecondPoints;
+               current.iPointsInCurrentPath = iFirstPoints;
+               }
+            ++iNumCallsInStack;
+            continue;
+            }
+         }
+
+      if (iNumCallsInStack == 0)
+         {
+         return SUCCESS;
+         }
+
+      --iNumCallsInStack;
+      current = callStack[iNumCallsInStack];
+      }
+   }
+
+int compactPathMarkSubproblem(const DVector2D *pPointArray, int iPointsInCurrentPath,
+                              unsigned char *pKeepFlags, double dEpsilon,
+                              CompactPathMaxDeviationScan maxDeviationScan,
+                              DeviationMetric deviationMetric)
+   {
+   return compactPathMarkKeptPoints(pPointArray, iPointsInCurrentPath, pKeepFlags, 0, dEpsilon,
+                                    maxDeviationScan, deviationMetric);
+   }
+
+int compactPathMarkSubproblemBits(const DVector2D *pPointArray, int iPointsInCurrentPath,
+                                  unsigned char *pKeepBitmap, double dEpsilon,
+                                  CompactPathMaxDeviationScan maxDeviationScan,
+                                  DeviationMetric deviationMetric)
+   {
+   return compactPathMarkKeptPoints(pPointArray, iPointsInCurrentPath, pKeepBitmap, 1, dEpsilon,
+                                    maxDeviationScan, deviationMetric);
    }
@@ -31,6 +31,9 @@ THE SOFTWARE.
 #ifndef PATH_COMPACTER_HEADER_INCLUDED
 #define PATH_COMPACTER_HEADER_INCLUDED
 
+#include <stddef.h> // For size_t
+#include <stdint.h> // For uint32_t
+
 // The following struct represents a double precision 2D point.
 typedef struct DVector2D
    {
@@ -47,6 +50,53 @@ typedef struct DVector2D
 typedef double (*DeviationMetric)(DVector2D /*startOfSegment*/, DVector2D /*endOfSegment*/,
                                   DVector2D /*point*/, double /*dSquareSegmentLength*/);
 
+// A DeviationMetric gets called once per point and has to redo any work that only depends on the
+// segment every time. A PathCompacterMetric splits that work off instead, so that custom metrics
+// can be as fast as the built in ones.
+// prepare gets called once per subproblem with its start and end points. It can keep whatever it
+// likes in the PATH_COMPACTER_METRIC_STATE_DOUBLES doubles at pdState.
+// evaluate then gets that state and the uPoints intermediate points of the subproblem, which are
+// the ones strictly between the start and end points, and finds the largest square deviation
+// among them. It writes that deviation to *pdMaxSquareDeviation and its index in pPoints to
+// *puMaxIndex. Ties have to go to the lowest index, and if no deviation is greater than zero,
+// the deviation written should be 0.0, like the scans of the built in metrics. That keeps the
+// result independent of how the loop is written, so evaluate is free to vectorize it.
+// pUserData is passed to both of them untouched.
+#define PATH_COMPACTER_METRIC_STATE_DOUBLES 32
+
+typedef void (*PathCompacterMetricPrepare)(void * /*pUserData*/, const DVector2D * /*pStart*/,
+                                           const DVector2D * /*pEnd*/, double * /*pdState*/);
+typedef void (*PathCompacterMetricEvaluate)(void * /*pUserData*/, const double * /*pdState*/,
+                                            const DVector2D * /*pPoints*/,
+                                            unsigned int /*uPoints*/,
+                                            unsigned int * /*puMaxIndex*/,
+                                            double * /*pdMaxSquareDeviation*/);
+
+typedef struct PathCompacterMetric
+   {
+   PathCompacterMetricPrepare prepare;
+   PathCompacterMetricEvaluate evaluate;
+   void *pUserData;
+   } PathCompacterMetric;
+
+// The following struct represents a double precision 3D point. For the synchronized Euclidean
+// distance metric, dZ is the timestamp instead.
+typedef struct DVector3D
+   {
+   double dX;
+   double dY;
+   double dZ;
+   } DVector3D;
+
+// These are the same as DeviationMetric, but for 3D points and for points with any number of
+// coordinates.
+typedef double (*DeviationMetric3D)(DVector3D /*startOfSegment*/, DVector3D /*endOfSegment*/,
+                                    DVector3D /*point*/, double /*dSquareSegmentLength*/);
+typedef double (*DeviationMetricND)(const double * /*pdStartOfSegment*/,
+                                    const double * /*pdEndOfSegment*/,
+                                    const double * /*pdPoint*/, unsigned int /*uDimensions*/,
+                                    double /*dSquareSegmentLength*/);
+
 // This function iteratively simulates the recursive Ramer-Douglas-Peucker algorithm.
 // https://en.wikipedia.org/wiki/Ramer%E2%80%93Douglas%E2%80%93Peucker_algorithm
 // Please allocate the resultPointArray to be as large as the pointArray passed in.
@@ -60,9 +110,577 @@ int compactPath(DVector2D *pPointArray, unsigned int uPointsInCurrentPath,
                 DVector2D *pResultPointArray, unsigned int *puPointsInResultPath,
                 double dEpsilon, DeviationMetric deviationMetric);
 
+// This is compactPath for input that hasn't been checked. It makes sure that there are no more
+// than INT_MAX points, that none of the pointers are NULL, that epsilon is finite and not
+// negative, and that every coordinate is finite and no bigger than 1e76 in magnitude, then calls
+// compactPath. Otherwise it fails with errno set to EINVAL. Larger coordinates would overflow the
+// squares in the metrics. The check is one pass over the points. The compaction itself does no
+// per-point checking.
+// All of the Ramer-Douglas-Peucker compacters handle the edge cases the same way. An empty path
+// compacts to an empty path. A subproblem whose intermediate points all lie exactly on its segment
+// loses all of them, even when epsilon is zero. The built in metrics measure from the start point
+// when a subproblem's endpoints are in the same place, as they are for a closed loop, so such a
+// subproblem divides at the point farthest from them.
+int compactPathValidated(DVector2D *pPointArray, unsigned int uPointsInCurrentPath,
+                         DVector2D *pResultPointArray, unsigned int *puPointsInResultPath,
+                         double dEpsilon, DeviationMetric deviationMetric);
+
+// This is the same algorithm as compactPath, written recursively, with the same allocation and
+// in-place rules and exactly the same result. It recurses into the smaller side of every division
+// and loops on the larger one, so the recursion depth stays below about 32 calls. It keeps all of
+// its state on the stack, so any number of threads can call it at the same time.
+// Returns a true value (1) on successful completion, and returns a false value (0) otherwise.
+int compactPathRecursive(DVector2D *pPointArray, unsigned int uPointsInCurrentPath,
+                         DVector2D *pResultPointArray, unsigned int *puPointsInResultPath,
+                         double dEpsilon, DeviationMetric deviationMetric);
+
+// This is compactPath with another way of finding the point to divide at. It builds a tree of
+// hulls over the path up front and finds each division point by walking down the tree, skipping
+// the parts of the subproblem whose hulls show that they can't hold the farthest point. This is a
+// bound-pruned search without a worst-case guarantee: it is still quadratic on the paths that make
+// compactPath quadratic, and it can be slower than compactPath. It helps on some of them, like
+// finely sampled spirals at small epsilons, where most of each subproblem gets skipped.
+// It returns exactly the same points as compactPath, and works in-place the same way.
+// Only perpendicularDistanceDeviationMetric uses the tree. Other metrics go to compactPath.
+// Returns a true value (1) on successful completion, and returns a false value (0) otherwise.
+int compactPathHull(DVector2D *pPointArray, unsigned int uPointsInCurrentPath,
+                    DVector2D *pResultPointArray, unsigned int *puPointsInResultPath,
+                    double dEpsilon, DeviationMetric deviationMetric);
+
+// This is compactPath for paths that are mostly straight. Before scanning a subproblem, it checks
+// a bound on how far its points could possibly be from the segment, which costs the same however
+// many points there are. When the bound is already within epsilon, the subproblem linearizes
+// without measuring any of its points. Otherwise it gets scanned as usual.
+// It returns exactly the same points as compactPath, and works in-place the same way.
+// Only perpendicularDistanceDeviationMetric has a bound. Other metrics scan every subproblem.
+// Returns a true value (1) on successful completion, and returns a false value (0) otherwise.
+int compactPathBounded(DVector2D *pPointArray, unsigned int uPointsInCurrentPath,
+                       DVector2D *pResultPointArray, unsigned int *puPointsInResultPath,
+                       double dEpsilon, DeviationMetric deviationMetric);
+
+// The following functions simplify a path with algorithms other than Ramer-Douglas-Peucker, so
+// their results differ from compactPath's. They take the same arguments, though, with the same
+// allocation and in-place rules: please allocate resultPointArray to be as large as pointArray,
+// or pass pointArray itself. The first and last points of the path are always kept.
+// They return a true value (1) on successful completion, and a false value (0) otherwise.
+
+// This is the Visvalingam-Whyatt algorithm. It keeps removing the point that forms the triangle
+// with the smallest area with its neighbours, for as long as that area is less than
+// dEpsilon * dEpsilon. It takes O(n log n) time and 24 bytes of scratch memory per point.
+int compactPathVisvalingam(DVector2D *pPointArray, unsigned int uPointsInCurrentPath,
+                           DVector2D *pResultPointArray, unsigned int *puPointsInResultPath,
+                           double dEpsilon);
+
+// This is the Reumann-Witkam algorithm. Starting from a kept point, it follows the path for as
+// long as deviationMetric, measured from the line through the kept point and the point after it,
+// stays below epsilon. The last point before that line is left becomes the next kept point. It
+// makes a single pass and needs no memory. Every dropped point is within epsilon of the line its
+// run started on, but not necessarily of the result segment that replaces it.
+// deviationMetric has to measure from the whole line, like perpendicularDistanceDeviationMetric
+// and the geodesic metrics do, for there to be a strip. shortestDistanceToSegmentDeviationMetric
+// is measured as perpendicularDistanceDeviationMetric here.
+int compactPathReumannWitkam(DVector2D *pPointArray, unsigned int uPointsInCurrentPath,
+                             DVector2D *pResultPointArray, unsigned int *puPointsInResultPath,
+                             double dEpsilon, DeviationMetric deviationMetric);
+
+// This is the radial distance filter. It drops every point that is closer than dRadius to the
+// last point it kept. It makes a single pass and needs no memory, which makes it a cheap way to
+// thin out a densely sampled path before running one of the other algorithms on the result in
+// place.
+int compactPathRadialDistance(DVector2D *pPointArray, unsigned int uPointsInCurrentPath,
+                              DVector2D *pResultPointArray, unsigned int *puPointsInResultPath,
+                              double dRadius);
+
+// This chains the two: compactPathRadialDistance with half of epsilon as the radius, and then
+// compactPath. A point dropped by the filter is within half of epsilon of a point that
+// compactPath measured, so with the built in metrics, every dropped point is within 1.5 times
+// epsilon of the result.
+int compactPathRadialThenRdp(DVector2D *pPointArray, unsigned int uPointsInCurrentPath,
+                             DVector2D *pResultPointArray, unsigned int *puPointsInResultPath,
+                             double dEpsilon, DeviationMetric deviationMetric);
+
+// The implementations that compactPathWithEngine can choose between. The Ramer-Douglas-Peucker
+// ones all produce the same result for the same input.
+typedef enum PathCompacterEngine
+   {
+   PATH_COMPACTER_ENGINE_ITERATIVE, // compactPath
+   PATH_COMPACTER_ENGINE_RECURSIVE, // compactPathRecursive
+   PATH_COMPACTER_ENGINE_HULL, // compactPathHull
+   PATH_COMPACTER_ENGINE_BOUNDED, // compactPathBounded
+   PATH_COMPACTER_ENGINE_VISVALINGAM, // compactPathVisvalingam, which ignores deviationMetric
+   PATH_COMPACTER_ENGINE_REUMANN_WITKAM, // compactPathReumannWitkam
+   PATH_COMPACTER_ENGINE_RADIAL_THEN_RDP // compactPathRadialThenRdp
+   } PathCompacterEngine;
+
+// Runs the implementation picked by engine. The arguments mean the same as for compactPath.
+// Returns a false value (0) for an engine it doesn't know about.
+int compactPathWithEngine(PathCompacterEngine engine, DVector2D *pPointArray,
+                          unsigned int uPointsInCurrentPath, DVector2D *pResultPointArray,
+                          unsigned int *puPointsInResultPath, double dEpsilon,
+                          DeviationMetric deviationMetric);
+
+// These let a context get its scratch memory from somewhere other than malloc and free.
+typedef void *(*PathCompacterAllocFunction)(void * /*pAllocatorData*/, size_t /*uBytes*/);
+typedef void (*PathCompacterFreeFunction)(void * /*pAllocatorData*/, void * /*pMemory*/);
+
+// These are the statistics that compactPath can collect about a call, to find out where its time
+// went. Collecting them costs a few branches per subproblem and two clock reads per scan and
+// copy, so leave them off unless they are wanted.
+typedef struct PathCompacterStats
+   {
+   // The number of times the metric was evaluated, which is the number of intermediate points
+   // of all the subproblems that were scanned. Far more of these than points means that the
+   // divisions are lopsided, which is what makes the algorithm take quadratic time.
+   unsigned long long uMetricEvaluations;
+
+   // How many subproblems were divided, linearized and found to be solved already.
+   unsigned long long uDivides;
+   unsigned long long uLinearizes;
+   unsigned long long uSolved;
+
+   // The deepest the call stack got, and how many times its memory had to be allocated.
+   unsigned long long uMaxStackDepth;
+   unsigned long long uStackReallocations;
+
+   // The number of bytes moved into place in the result array.
+   unsigned long long uBytesMoved;
+
+   // Wall clock time in seconds: getting ready (picking the scan and getting the call stack),
+   // scanning for the largest deviations, moving points into place, and the whole call.
+   double dSetupSeconds;
+   double dScanSeconds;
+   double dMoveSeconds;
+   double dTotalSeconds;
+   } PathCompacterStats;
+
+// A context owns the scratch memory that compactPath would otherwise allocate and free on every
+// call. Set one up once, pass it to as many calls as you like, and release it at the end.
+// The scratch memory only grows, so after the first few calls there are no more allocations.
+// A context must not be used by two threads at the same time, but each thread can have its own.
+// The fields are only public so that a context can live on the stack or inside another struct.
+// Please don't touch them directly.
+typedef struct PathCompacterContext
+   {
+   PathCompacterAllocFunction allocFunction;
+   PathCompacterFreeFunction freeFunction;
+   void *pAllocatorData;
+   void *pScratch;
+   size_t uScratchBytes;
+   size_t uHighWaterMark;
+   int iOwnsScratch;
+   PathCompacterStats *pStats;
+   const PathCompacterMetric *pMetric;
+   } PathCompacterContext;
+
+// Sets up a context that gets its memory from allocFunction and gives it back through
+// freeFunction. Pass NULL for both to use malloc and free.
+void compactPathContextInit(PathCompacterContext *pContext,
+                            PathCompacterAllocFunction allocFunction,
+                            PathCompacterFreeFunction freeFunction, void *pAllocatorData);
+
+// Sets up a context that uses the uArenaBytes bytes at pArena as its scratch memory and never
+// allocates anything. A call that needs more than that fails (with errno set to ENOMEM), so use
+// compactPathContextHighWaterMark on typical inputs to find out how much to give it.
+void compactPathContextInitWithArena(PathCompacterContext *pContext, void *pArena,
+                                     size_t uArenaBytes);
+
+// Makes sure the context has at least uBytes of scratch memory, so that the allocation happens
+// now instead of during a call.
+// Returns a true value (1) on success, and returns a false value (0) otherwise.
+int compactPathContextReserve(PathCompacterContext *pContext, size_t uBytes);
+
+// Makes every call that uses this context fill in *pStats, starting from zero each time. Pass NULL
+// to stop collecting statistics, which is how a context starts out.
+void compactPathContextSetStats(PathCompacterContext *pContext, PathCompacterStats *pStats);
+
+// Makes compactPathWithContext measure deviations with *pMetric, which has to stay around for as
+// long as it is set, instead of its deviationMetric argument. Pass NULL to go back to the argument,
+// which is how a context starts out.
+void compactPathContextSetMetric(PathCompacterContext *pContext,
+                                 const PathCompacterMetric *pMetric);
+
+// Returns the most scratch memory, in bytes, that any call using this context has needed.
+size_t compactPathContextHighWaterMark(const PathCompacterContext *pContext);
+
+// Frees the scratch memory that the context allocated. An arena is left alone.
+// The context can be used again afterwards, and will allocate again when it needs to.
+void compactPathContextRelease(PathCompacterContext *pContext);
+
+// This function is compactPath, except that the call stack comes from pContext.
+int compactPathWithContext(PathCompacterContext *pContext, DVector2D *pPointArray,
+                           unsigned int uPointsInCurrentPath, DVector2D *pResultPointArray,
+                           unsigned int *puPointsInResultPath, double dEpsilon,
+                           DeviationMetric deviationMetric);
+
+// This function is compactPath with a PathCompacterMetric instead of a DeviationMetric.
+int compactPathWithMetric(DVector2D *pPointArray, unsigned int uPointsInCurrentPath,
+                          DVector2D *pResultPointArray, unsigned int *puPointsInResultPath,
+                          double dEpsilon, const PathCompacterMetric *pMetric);
+
+// This function is compactPathVisvalingam, except that the scratch memory comes from pContext.
+// The statistics of the context only get their scratch memory counts filled in.
+int compactPathVisvalingamWithContext(PathCompacterContext *pContext, DVector2D *pPointArray,
+                                      unsigned int uPointsInCurrentPath,
+                                      DVector2D *pResultPointArray,
+                                      unsigned int *puPointsInResultPath, double dEpsilon);
+
+// This function is compactPath, except that it fills in *pStats as well.
+int compactPathWithStats(DVector2D *pPointArray, unsigned int uPointsInCurrentPath,
+                         DVector2D *pResultPointArray, unsigned int *puPointsInResultPath,
+                         double dEpsilon, DeviationMetric deviationMetric,
+                         PathCompacterStats *pStats);
+
+// This function produces exactly the same result as compactPath, but spreads the work over
+// uThreads threads. Once a subproblem has been divided, its two sides don't depend on each other,
+// so every side that is still large enough gets handed to a work-stealing pool of threads.
+// Instead of compacting the points as it goes, it flags the points that survive and gathers them
+// into resultPointArray at the end. The same allocation and in-place rules as for compactPath
+// apply. Small paths and uThreads values below 2 just call compactPath.
+// Returns a true value (1) on successful completion, and returns a false value (0) otherwise.
+int compactPathParallel(DVector2D *pPointArray, unsigned int uPointsInCurrentPath,
+                        DVector2D *pResultPointArray, unsigned int *puPointsInResultPath,
+                        double dEpsilon, DeviationMetric deviationMetric, unsigned int uThreads);
+
+// This function compacts many independent paths in one call. The paths are stored back to back
+// in pPointArray, and path i is made up of the points from puPathOffsets[i] up to (but not
+// including) puPathOffsets[i + 1], so puPathOffsets has uPaths + 1 entries.
+// Each path uses pdEpsilons[i] as its epsilon, or dEpsilon for all of them if pdEpsilons is NULL.
+// The compacted paths are written back to back into pResultPointArray, starting at its beginning,
+// and their offsets are written into puResultOffsets the same way, so it needs uPaths + 1 entries
+// too. Please allocate pResultPointArray to hold puPathOffsets[uPaths] points. Just like with
+// compactPath, the result array may be the same as pPointArray.
+// The paths are spread over uThreads threads. Each thread allocates its scratch memory once and
+// reuses it for every path it handles, so there is no allocation per path.
+// Returns a true value (1) on successful completion, and returns a false value (0) otherwise.
+// Like compactPath, it fails without writing anything if an epsilon is negative or NaN, or if a
+// pointer or the metric is NULL.
+int compactPathBatch(DVector2D *pPointArray, const unsigned int *puPathOffsets,
+                     unsigned int uPaths, const double *pdEpsilons, double dEpsilon,
+                     DeviationMetric deviationMetric, DVector2D *pResultPointArray,
+                     unsigned int *puResultOffsets, unsigned int uThreads);
+
+// These two find the same points that compactPath keeps, but only report which ones they are
+// instead of copying them. The input is never written to, so it can be read-only (memory mapped,
+// for example), and the indices can be used to pick out the matching entries of any other arrays
+// that go along with the points, like timestamps or IDs.
+// Returns a true value (1) on successful completion, and returns a false value (0) otherwise.
+// Like compactPath, they fail if dEpsilon is negative or NaN, or if a pointer or the metric is
+// NULL. So do the 3D, ND and SoA versions below.
+
+// Writes the indices of the kept points into puKeptIndices in increasing order. Please allocate
+// puKeptIndices to hold uPointsInCurrentPath entries. Until the function returns, the end of the
+// array is also used as scratch space, so this doesn't allocate anything.
+int compactPathKeptIndices(const DVector2D *pPointArray, unsigned int uPointsInCurrentPath,
+                           uint32_t *puKeptIndices, unsigned int *puPointsInResultPath,
+                           double dEpsilon, DeviationMetric deviationMetric);
+
+// Sets bit i of pKeepBitmap if point i is kept and clears it otherwise. Bit i is
+// (pKeepBitmap[i / 8] >> (i % 8)) & 1, so please allocate (uPointsInCurrentPath + 7) / 8 bytes.
+// The number of kept points is passed back through puPointsInResultPath.
+int compactPathKeepBitmap(const DVector2D *pPointArray, unsigned int uPointsInCurrentPath,
+                          unsigned char *pKeepBitmap, unsigned int *puPointsInResultPath,
+                          double dEpsilon, DeviationMetric deviationMetric);
+
+// These are compactPathKeptIndices for points whose coordinates are stored in two separate
+// arrays instead of a DVector2D array. The built in metrics are computed in the precision of the
+// input, so the float version works in single precision and can keep slightly different points
+// than compactPath would on the same values converted to double. The int32 version measures the
+// points at piX[i] * dScale, piY[i] * dScale, but computes the deviations on the unscaled values
+// and scales them afterwards, and fails if dScale isn't positive.
+// Any other metric gets each point converted to a DVector2D, scaled the same way.
+// Returns a true value (1) on successful completion, and returns a false value (0) otherwise.
+int compactPathKeptIndicesSoa(const double *pdX, const double *pdY,
+                              unsigned int uPointsInCurrentPath, uint32_t *puKeptIndices,
+                              unsigned int *puPointsInResultPath, double dEpsilon,
+                              DeviationMetric deviationMetric);
+int compactPathKeptIndicesSoaFloat(const float *pfX, const float *pfY,
+                                   unsigned int uPointsInCurrentPath, uint32_t *puKeptIndices,
+                                   unsigned int *puPointsInResultPath, double dEpsilon,
+                                   DeviationMetric deviationMetric);
+int compactPathKeptIndicesSoaInt32(const int32_t *piX, const int32_t *piY, double dScale,
+                                   unsigned int uPointsInCurrentPath, uint32_t *puKeptIndices,
+                                   unsigned int *puPointsInResultPath, double dEpsilon,
+                                   DeviationMetric deviationMetric);
+
+// These are compactPath and compactPathKeptIndices for 3D points, with the same rules.
+// Returns a true value (1) on successful completion, and returns a false value (0) otherwise.
+int compactPath3D(DVector3D *pPointArray, unsigned int uPointsInCurrentPath,
+                  DVector3D *pResultPointArray, unsigned int *puPointsInResultPath,
+                  double dEpsilon, DeviationMetric3D deviationMetric);
+int compactPathKeptIndices3D(const DVector3D *pPointArray, unsigned int uPointsInCurrentPath,
+                             uint32_t *puKeptIndices, unsigned int *puPointsInResultPath,
+                             double dEpsilon, DeviationMetric3D deviationMetric);
+
+// This function is compactPath3D, except that the scratch memory comes from pContext.
+// The statistics of the context only get their scratch memory counts filled in.
+int compactPath3DWithContext(PathCompacterContext *pContext, DVector3D *pPointArray,
+                             unsigned int uPointsInCurrentPath, DVector3D *pResultPointArray,
+                             unsigned int *puPointsInResultPath, double dEpsilon,
+                             DeviationMetric3D deviationMetric);
+
+// These are compactPath and compactPathKeptIndices for points with uDimensions coordinates each,
+// stored one point after another in pdPointArray. The result array holds the kept points the
+// same way. uDimensions has to be at least 1.
+// Returns a true value (1) on successful completion, and returns a false value (0) otherwise.
+int compactPathND(double *pdPointArray, unsigned int uDimensions,
+                  unsigned int uPointsInCurrentPath, double *pdResultPointArray,
+                  unsigned int *puPointsInResultPath, double dEpsilon,
+                  DeviationMetricND deviationMetric);
+int compactPathKeptIndicesND(const double *pdPointArray, unsigned int uDimensions,
+                             unsigned int uPointsInCurrentPath, uint32_t *puKeptIndices,
+                             unsigned int *puPointsInResultPath, double dEpsilon,
+                             DeviationMetricND deviationMetric);
+
+// This function is compactPathND, except that the scratch memory comes from pContext.
+// The statistics of the context only get their scratch memory counts filled in.
+int compactPathNDWithContext(PathCompacterContext *pContext, double *pdPointArray,
+                             unsigned int uDimensions, unsigned int uPointsInCurrentPath,
+                             double *pdResultPointArray, unsigned int *puPointsInResultPath,
+                             double dEpsilon, DeviationMetricND deviationMetric);
+
+// These let the vertex budget be picked after the work is done, instead of searching for the
+// epsilon that hits it. compactPathRankVertices divides the path all the way down once, always
+// at the most significant subproblem first, and the selection functions then pick out any number
+// of points, or the points for any epsilon, without computing a single deviation.
+// Returns a true value (1) on successful completion, and returns a false value (0) otherwise.
+
+// Writes the significance of every point into pdSignificance, which needs uPointsInCurrentPath
+// entries. The significance of a point is the square deviation (as returned by deviationMetric)
+// it had when its subproblem was divided at it, capped at the significance of that subproblem's
+// own division. Points that are never divided at get 0.0, and the endpoints get HUGE_VAL.
+// The division points are also written into puRankedIndices, most significant first, and their
+// number is passed back through puRankedVertices. Please allocate puRankedIndices to hold
+// uPointsInCurrentPath entries.
+int compactPathRankVertices(const DVector2D *pPointArray, unsigned int uPointsInCurrentPath,
+                            double *pdSignificance, uint32_t *puRankedIndices,
+                            unsigned int *puRankedVertices, DeviationMetric deviationMetric);
+
+// Writes the indices of the uMaxPoints most significant points, endpoints included, into
+// puKeptIndices in increasing order. This takes O(K log K) time for K points. Every point that is
+// picked comes with the points its subproblem depended on, so the result is always a path that
+// compactPath could have produced, except when equally significant points get split up.
+// No more than uMaxPoints entries are written. The endpoints are always kept, so a budget of less
+// than 2 fails for paths of 2 or more points.
+int compactPathSelectTopK(const uint32_t *puRankedIndices, unsigned int uRankedVertices,
+                          unsigned int uPointsInCurrentPath, unsigned int uMaxPoints,
+                          uint32_t *puKeptIndices, unsigned int *puPointsInResultPath);
+
+// Writes the indices of the points that compactPath would keep for dEpsilon into puKeptIndices
+// in increasing order, in O(n) time.
+int compactPathSelectByEpsilon(const double *pdSignificance, unsigned int uPointsInCurrentPath,
+                               double dEpsilon, uint32_t *puKeptIndices,
+                               unsigned int *puPointsInResultPath);
+
+// An index holds the significance ranking of one path, so that the path can be simplified for
+// any epsilon or point budget later on without looking at its points again. It can be written
+// out to a compact binary form (16 bytes plus 12 bytes per vertex that can ever be kept) and
+// read back in, so that the work can be done once and stored alongside the path.
+typedef struct PathCompacterIndex PathCompacterIndex;
+
+// Builds the index with compactPathRankVertices. Returns NULL if memory runs out, or if the points
+// or the metric are NULL.
+PathCompacterIndex *compactPathIndexBuild(const DVector2D *pPointArray,
+                                          unsigned int uPointsInCurrentPath,
+                                          DeviationMetric deviationMetric);
+
+void compactPathIndexDestroy(PathCompacterIndex *pIndex);
+
+// Returns the number of points in the path the index was built for.
+unsigned int compactPathIndexPoints(const PathCompacterIndex *pIndex);
+
+// Returns the number of points that compactPath would keep for dEpsilon, in O(log n) time.
+unsigned int compactPathIndexPointsForEpsilon(const PathCompacterIndex *pIndex, double dEpsilon);
+
+// These write the indices of the kept points into puKeptIndices in increasing order, just like
+// compactPathSelectByEpsilon and compactPathSelectTopK do. Please allocate puKeptIndices to hold
+// as many entries as the path has points (or uMaxPoints, if that is less). No more than that is
+// written: compactPathIndexExtractTopK has the same rules as compactPathSelectTopK, so a budget
+// of less than 2 fails for paths of 2 or more points.
+// For a small result, compactPathIndexExtractTopK with the count from
+// compactPathIndexPointsForEpsilon gives the same points as compactPathIndexExtract, but only
+// reads the front of the ranking.
+// These return a true value (1) on success and a false value (0) otherwise.
+int compactPathIndexExtract(const PathCompacterIndex *pIndex, double dEpsilon,
+                            uint32_t *puKeptIndices, unsigned int *puPointsInResultPath);
+int compactPathIndexExtractTopK(const PathCompacterIndex *pIndex, unsigned int uMaxPoints,
+                                uint32_t *puKeptIndices, unsigned int *puPointsInResultPath);
+
+// Returns the number of bytes compactPathIndexSerialize needs.
+size_t compactPathIndexSerializedSize(const PathCompacterIndex *pIndex);
+
+// Writes the index into pBuffer. The format is the same on every platform.
+// Returns the number of bytes written, or 0 if uBufferBytes is too small.
+size_t compactPathIndexSerialize(const PathCompacterIndex *pIndex, void *pBuffer,
+                                 size_t uBufferBytes);
+
+// Reads an index back in. The buffer is checked, so a truncated or corrupt one is turned down.
+// Returns NULL if the buffer isn't a valid index or if memory runs out.
+PathCompacterIndex *compactPathIndexDeserialize(const void *pBuffer, size_t uBufferBytes);
+
+// The streaming and chunked compacters hand every point of the result to one of these as soon as
+// the point is final. Points arrive in path order.
+typedef void (*PathCompacterEmitCallback)(void * /*pUserData*/, DVector2D /*point*/);
+
+// A streaming compacter simplifies a path that arrives one point at a time, using a fixed window
+// of uWindowSize points instead of the whole path. Create one with compactPathStreamCreate, feed
+// it points with compactPathStreamPush, and call compactPathStreamFlush at the end of each path.
+// Every point that gets dropped is within epsilon (as measured by deviationMetric) of the result
+// segment that replaces it, just like with compactPath, and the first and last points of the path
+// are always kept. A path that fits in the window comes out exactly as compactPath would produce
+// it. Once the window fills up, it is compacted and everything up to the last kept intermediate
+// point is emitted. If that point is in the first half of the window, the midpoint gets pinned
+// instead, so no more than uWindowSize points are ever held back. Those extra boundaries mean
+// that a long path can keep some points that compactPath would have dropped.
+// Memory use is about 17 bytes per window point, no matter how long the path is.
+typedef struct PathCompacterStream PathCompacterStream;
+
+// Returns NULL if memory runs out, if there is no metric or no callback, if dEpsilon is negative
+// or NaN, or if uWindowSize is less than 4 or more than INT_MAX.
+PathCompacterStream *compactPathStreamCreate(unsigned int uWindowSize, double dEpsilon,
+                                             DeviationMetric deviationMetric,
+                                             PathCompacterEmitCallback emitCallback,
+                                             void *pUserData);
+
+// These return a true value (1) on success and a false value (0) otherwise.
+int compactPathStreamPush(PathCompacterStream *pStream, DVector2D point);
+int compactPathStreamFlush(PathCompacterStream *pStream);
+
+void compactPathStreamDestroy(PathCompacterStream *pStream);
+
+// An incremental compacter holds on to a path that keeps changing, such as a track that is still
+// being recorded or a line that is being edited, and keeps its compacted form up to date. Create
+// one with compactPathIncrementalCreate, then add points to the end of the path with
+// compactPathIncrementalAppend and move existing ones with compactPathIncrementalReplace. After
+// every call, the kept points are exactly the ones that compactPath would keep for the whole path.
+// The compacter remembers how the path was divided last time, and only divides again the parts
+// that contain changed points. Appending a few points usually redoes a few dozen divisions down
+// the right edge of the path, and moving a point redoes the ones on the way down to it. With
+// perpendicularDistanceDeviationMetric, those divisions are found with the hull tree of
+// compactPathHull, which usually skips most of each part but has no better worst case than a
+// scan. Other metrics have to scan every point of a part that is divided again, so an update
+// costs at least a pass over the path, but still saves the divisions that it doesn't redo.
+// Memory use is about 100 bytes per point.
+typedef struct PathCompacterIncremental PathCompacterIncremental;
+
+// Returns NULL if memory runs out, if there is no metric, or if dEpsilon is negative.
+PathCompacterIncremental *compactPathIncrementalCreate(double dEpsilon,
+                                                       DeviationMetric deviationMetric);
+
+// These copy the points in. compactPathIncrementalReplace overwrites uPoints points starting at
+// uFirstPoint, which all have to be in the path already.
+// They return a true value (1) on success and a false value (0) otherwise, in which case the
+// path hasn't changed.
+int compactPathIncrementalAppend(PathCompacterIncremental *pIncremental,
+                                 const DVector2D *pPointArray, unsigned int uPoints);
+int compactPathIncrementalReplace(PathCompacterIncremental *pIncremental, unsigned int uFirstPoint,
+                                  const DVector2D *pPointArray, unsigned int uPoints);
+
+unsigned int compactPathIncrementalPointCount(const PathCompacterIncremental *pIncremental);
+
+// Returns the lowest index at which the last append or replace added, dropped or moved a kept
+// point, or the number of points if the result didn't change. Everything kept below it is the
+// same as before, so a copy of the result only needs to be redone from there.
+unsigned int compactPathIncrementalFirstChange(const PathCompacterIncremental *pIncremental);
+
+// Writes the indices of the kept points from uFromPoint on into puKeptIndices, in increasing
+// order. Please allocate puKeptIndices to hold one entry per point from uFromPoint on.
+// Returns a true value (1) on success and a false value (0) otherwise.
+int compactPathIncrementalKeptIndices(const PathCompacterIncremental *pIncremental,
+                                      unsigned int uFromPoint, uint32_t *puKeptIndices,
+                                      unsigned int *puPointsInResultPath);
+
+void compactPathIncrementalDestroy(PathCompacterIncremental *pIncremental);
+
+// This function simplifies closed rings, like the outlines and holes of polygons. The rings are
+// stored back to back in pPointArray, and ring i is made up of the points from puRingOffsets[i]
+// up to (but not including) puRingOffsets[i + 1], so puRingOffsets has uRings + 1 entries. A ring
+// may repeat its first point at the end or not, and its result does the same.
+// Instead of keeping the first point like compactPath would, each ring is anchored at its leftmost
+// point and the point furthest from that, and the two chains between them are compacted. A ring
+// always keeps at least three points (unless it had fewer to begin with), and the kept points stay
+// in their original order.
+// If iPreserveTopology is true, segments of the result that would cross or touch another segment,
+// of the same ring or of any other, are divided again until none of them do. The crossings are
+// found with a grid over the result. Crossings that were already in the input are left alone,
+// since their segments can't be divided any further. A result with a point that isn't finite, or
+// with points so far apart that its extent overflows, can't be checked, and then this fails.
+// The results are written back to back into pResultPointArray and their offsets into
+// puResultOffsets, just like with compactPathBatch, and pResultPointArray may be the same as
+// pPointArray. Memory use is about 17 bytes per point, plus the grid in the topology preserving
+// mode.
+// Returns a true value (1) on successful completion, and returns a false value (0) otherwise.
+int compactPathRings(DVector2D *pPointArray, const unsigned int *puRingOffsets,
+                     unsigned int uRings, DVector2D *pResultPointArray,
+                     unsigned int *puResultOffsets, double dEpsilon,
+                     DeviationMetric deviationMetric, int iPreserveTopology);
+
+// The chunked compacter pulls the points of a path from one of these. It should read up to
+// uMaxPoints points into pPointArray and set *puPointsRead to the number it read. Reading fewer is
+// fine, and reading none means that the path is over.
+// Return a true value (1) on success and a false value (0) to stop the compaction.
+typedef int (*PathCompacterReadCallback)(void * /*pUserData*/, DVector2D * /*pPointArray*/,
+                                         unsigned int /*uMaxPoints*/,
+                                         unsigned int * /*puPointsRead*/);
+
+// This function compacts a path that is too long to hold in memory, such as one being read from a
+// file. It reads the path uChunkPoints points at a time and compacts uThreads chunks at once, one
+// per thread, with the points at the seams between chunks pinned. Then it stitches the chunks
+// together in order: a seam point is dropped if the run from the last point emitted before it to
+// the first kept point after it linearizes on its own. The result goes to emitCallback in path
+// order as soon as it is final.
+// Every point that gets dropped is within epsilon (as measured by deviationMetric) of the result
+// segment that replaces it, just like with compactPath, and the first and last points of the path
+// are always kept. A path of up to uChunkPoints + 1 points comes out exactly as compactPath would
+// produce it. In a longer one, the chunks are compacted without seeing each other, so at most one
+// extra point per chunk can be kept where compactPath would have dropped it.
+// Memory use is about 17 * uThreads * uChunkPoints + 32 * uChunkPoints bytes, however long the
+// path is, and the time taken grows linearly with its length.
+// The number of points emitted is written to *puPointsInResultPath, even on failure.
+// Returns a true value (1) on success and a false value (0) if a callback asked to stop, if memory
+// runs out, if uChunkPoints is less than 2, or if compactPath would have failed on a chunk.
+int compactPathChunked(PathCompacterReadCallback readCallback, void *pReadUserData,
+                       unsigned int uChunkPoints, unsigned int uThreads, double dEpsilon,
+                       DeviationMetric deviationMetric, PathCompacterEmitCallback emitCallback,
+                       void *pEmitUserData, unsigned long long *puPointsInResultPath);
+
 // Declare several metric function implementations.
 
-DeviationMetric perpendicularDistanceDeviationMetric;
-DeviationMetric shortestDistanceToSegmentDeviationMetric;
+extern DeviationMetric perpendicularDistanceDeviationMetric;
+extern DeviationMetric shortestDistanceToSegmentDeviationMetric;
+
+// The geodesic metrics are for raw longitude and latitude, in degrees, in dX and dY. They return
+// square meters, so epsilon is in meters. The first is the cross-track distance from the great
+// circle through the segment on a sphere with the Earth's mean radius. The second is for when the
+// error of the sphere (up to half a percent) matters, and it needs no trigonometry per point. It
+// measures in a plane tangent to the WGS84 ellipsoid at the middle of the segment, which is off by
+// about a centimeter for 10 km segments, 20 cm for 50 km and a meter for 100 km, but it breaks
+// down within a few degrees of the poles.
+// If the endpoints are in the same place, both measure the distance from the start point.
+extern DeviationMetric crossTrackDistanceDeviationMetric;
+extern DeviationMetric ellipsoidalCrossTrackDistanceDeviationMetric;
+
+// The 3D metrics measure the distance to the infinite line through the segment, the distance to
+// the segment itself, and the synchronized Euclidean distance. The last one treats dZ as a
+// timestamp and measures how far a point is in X and Y from where it would have been at that
+// time, moving at a constant speed along the segment.
+// The perpendicular distance comes out bit for bit the same as perpendicularDistanceDeviationMetric
+// when dZ = 0, so compactPath3D on such points keeps the same points as compactPath as long as
+// the differences between their coordinates are finite. The distance to the segment is not
+// the same as shortestDistanceToSegmentDeviationMetric, which is kept the way it has always been:
+// it comes out at a quarter of the square distance for points alongside the segment, and at the
+// square distance to the end point for points beyond either end. The 3D and N dimensional ones
+// measure the square distance to the segment itself.
+extern DeviationMetric3D perpendicularDistanceDeviationMetric3D;
+extern DeviationMetric3D shortestDistanceToSegmentDeviationMetric3D;
+extern DeviationMetric3D synchronizedEuclideanDistanceDeviationMetric3D;
+
+// The same metrics as the 3D ones, for any number of coordinates. For the synchronized Euclidean
+// distance, the last coordinate is the timestamp and all of the others are measured, so a point of
+// an aircraft track could be X, Y, altitude, time. The perpendicular distance is worked out from a
+// projection rather than a cross product, so it can differ from the 2D and 3D ones in the last bits
+// and keep slightly different points when a distance lands right on epsilon.
+extern DeviationMetricND perpendicularDistanceDeviationMetricND;
+extern DeviationMetricND shortestDistanceToSegmentDeviationMetricND;
+extern DeviationMetricND synchronizedEuclideanDistanceDeviationMetricND;
 
 #endif
@@ -0,0 +1,311 @@
+/*
+   PathCompacter3D.c
+   10/15/2026
+   Authors: Michael Casebolt, Brett Casebolt
+*/
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Michael Casebolt and Brett Casebolt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// This file uses lines up to 100 characters long. If this 100 character line fits then you're good.
+
+#include "PathCompacter.h"
+#include "PathCompacterInternal.h"
+
+#include <string.h> // For memset
+#include <limits.h> // For INT_MAX
+
+#define FAILURE 0
+#define SUCCESS 1
+
+// The square of the distance from mid to the infinite line through start and end, from the
+// length of the cross product. If start and end are in the same place, it is the square distance
+// from start instead. The Z part of the cross product is worked out with the same expression as
+// compactPathPerpendicularDistance, so that points with dZ = 0 get exactly the same distances.
+static inline double compactPathPerpendicularDistance3D(const DVector3D *pStart,
+                                                        const DVector3D *pEnd,
+                                                        const DVector3D *pMid,
+                                                        double dSquareSegmentLength)
+   {
+   double dAX, dAY, dAZ, dBX, dBY, dBZ, dCrossX, dCrossY, dCrossZ;
+
+   dAX = pEnd->dX - pStart->dX;
+   dAY = pEnd->dY - pStart->dY;
+   dAZ = pEnd->dZ - pStart->dZ;
+
+   dBX = pMid->dX - pStart->dX;
+   dBY = pMid->dY - pStart->dY;
+   dBZ = pMid->dZ - pStart->dZ;
+
+   dCrossX = dAY * dBZ - dAZ * dBY;
+   dCrossY = dAZ * dBX - dAX * dBZ;
+   dCrossZ = pStart->dX * (pMid->dY - pEnd->dY) +
+             pMid->dX * (pEnd->dY - pStart->dY) +
+             pEnd->dX * (pStart->dY - pMid->dY);
+
+   if (dSquareSegmentLength == 0.0)
+      {
+      return dBX * dBX + dBY * dBY + dBZ * dBZ;
+      }
+
+   return (dCrossX * dCrossX + dCrossY * dCrossY + dCrossZ * dCrossZ) / dSquareSegmentLength;
+   }
+
+// The square of the distance from mid to the closest point of the segment from start to end.
+static inline double compactPathShortestDistanceToSegment3D(const DVector3D *pStart,
+                                                            const DVector3D *pEnd,
+                                                            const DVector3D *pMid,
+                                                            double dSquareSegmentLength)
+   {
+   double dAX, dAY, dAZ, dBX, dBY, dBZ, dCX, dCY, dCZ, dAdotB;
+
+   // Start->End forms vector A.
+   dAX = pEnd->dX - pStart->dX;
+   dAY = pEnd->dY - pStart->dY;
+   dAZ = pEnd->dZ - pStart->dZ;
+
+   // Start->Mid forms vector B.
+   dBX = pMid->dX - pStart->dX;
+   dBY = pMid->dY - pStart->dY;
+   dBZ = pMid->dZ - pStart->dZ;
+
+   dAdotB = dAX * dBX + dAY * dBY + dAZ * dBZ;
+
+   if (dAdotB <= 0.0)
+      {
+      // It is closest to the start point.
+      return dBX * dBX + dBY * dBY + dBZ * dBZ;
+      }
+   else if (dAdotB >= dSquareSegmentLength)
+      {
+      // It is closest to the end point.
+      dCX = pMid->dX - pEnd->dX;
+      dCY = pMid->dY - pEnd->dY;
+      dCZ = pMid->dZ - pEnd->dZ;
+      return dCX * dCX + dCY * dCY + dCZ * dCZ;
+      }
+   else
+      {
+      return compactPathPerpendicularDistance3D(pStart, pEnd, pMid, dSquareSegmentLength);
+      }
+   }
+
+// The square of the distance from mid to where an object moving at a constant speed from start
+// to end would have been at the time of mid. dZ is the timestamp, so only dX and dY are measured.
+static inline double compactPathSynchronizedEuclideanDistance3D(const DVector3D *pStart,
+                                                                const DVector3D *pEnd,
+                                                                const DVector3D *pMid,
+                                                                double dSquareSegmentLength)
+   {
+   double dDuration, dRatio, dDX, dDY;
+
+   (void)dSquareSegmentLength;
+
+   dDuration = pEnd->dZ - pStart->dZ;
+   dRatio = dDuration != 0.0 ? (pMid->dZ - pStart->dZ) / dDuration : 0.0;
+
+   dDX = pStart->dX + dRatio * (pEnd->dX - pStart->dX) - pMid->dX;
+   dDY = pStart->dY + dRatio * (pEnd->dY - pStart->dY) - pMid->dY;
+
+   return dDX * dDX + dDY * dDY;
+   }
+
+static double perpendicularDistance3D(DVector3D start, DVector3D end, DVector3D mid,
+                                      double dSquareSegmentLength)
+   {
+   return compactPathPerpendicularDistance3D(&start, &end, &mid, dSquareSegmentLength);
+   }
+DeviationMetric3D perpendicularDistanceDeviationMetric3D = &perpendicularDistance3D;
+
+static double shortestDistanceToSegment3D(DVector3D start, DVector3D end, DVector3D mid,
+                                          double dSquareSegmentLength)
+   {
+   return compactPathShortestDistanceToSegment3D(&start, &end, &mid, dSquareSegmentLength);
+   }
+DeviationMetric3D shortestDistanceToSegmentDeviationMetric3D = &shortestDistanceToSegment3D;
+
+static double synchronizedEuclideanDistance3D(DVector3D start, DVector3D end, DVector3D mid,
+                                              double dSquareSegmentLength)
+   {
+   return compactPathSynchronizedEuclideanDistance3D(&start, &end, &mid, dSquareSegmentLength);
+   }
+DeviationMetric3D synchronizedEuclideanDistanceDeviationMetric3D =
+   &synchronizedEuclideanDistance3D;
+
+typedef struct CompactPath3DPath
+   {
+   const DVector3D *pPointArray;
+   DeviationMetric3D deviationMetric;
+   } CompactPath3DPath;
+
+// This stamps out a range scan with metricBody inlined, or with a call to the metric callback
+// when metricBody is compactPath3DCallMetric. It is the same loop as compactPathFindMaxDeviation.
+#define COMPACT_PATH_DEFINE_3D_SCAN(scanName, metricBody)\
+   static int scanName(const void *pPath, unsigned int uStart, int iPointsInCurrentPath,\
+                       double *pdMaxSquareDeviation)\
+      {\
+      const CompactPath3DPath *p3DPath;\
+      const DVector3D *pPointArray, *pStart, *pEnd;\
+      double dSquareSegLen, dSquareDeviation, dMaxSquareDeviationInThisSegment, dDX, dDY, dDZ;\
+      int i, iMaxPointIndex;\
+      \
+      p3DPath = (const CompactPath3DPath *)pPath;\
+      pPointArray = p3DPath->pPointArray + uStart;\
+      \
+      dMaxSquareDeviationInThisSegment = 0.0;\
+      iMaxPointIndex = 0;\
+      \
+      pStart = pPointArray;\
+      pEnd = pPointArray + iPointsInCurrentPath - 1;\
+      dDX = pEnd->dX - pStart->dX;\
+      dDY = pEnd->dY - pStart->dY;\
+      dDZ = pEnd->dZ - pStart->dZ;\
+      dSquareSegLen = dDX * dDX + dDY * dDY + dDZ * dDZ;\
+      \
+      for (i = 1; i < iPointsInCurrentPath - 1; ++i)\
+         {\
+         dSquareDeviation = metricBody(pStart, pEnd, pPointArray + i, dSquareSegLen);\
+         \
+         if (dSquareDeviation > dMaxSquareDeviationInThisSegment)\
+            {\
+            iMaxPointIndex = i;\
+            dMaxSquareDeviationInThisSegment = dSquareDeviation;\
+            }\
+         }\
+      \
+      *pdMaxSquareDeviation = dMaxSquareDeviationInThisSegment;\
+      return iMaxPointIndex;\
+      }
+
+#define compactPath3DCallMetric(pStart, pEnd, pMid, dSquareSegLen)\
+   p3DPath->deviationMetric(*(pStart), *(pEnd), *(pMid), (dSquareSegLen))
+
+COMPACT_PATH_DEFINE_3D_SCAN(perpendicularDistance3DScan, compactPathPerpendicularDistance3D)
+COMPACT_PATH_DEFINE_3D_SCAN(shortestDistanceToSegment3DScan,
+                            compactPathShortestDistanceToSegment3D)
+COMPACT_PATH_DEFINE_3D_SCAN(synchronizedEuclideanDistance3DScan,
+                            compactPathSynchronizedEuclideanDistance3D)
+COMPACT_PATH_DEFINE_3D_SCAN(generic3DScan, compactPath3DCallMetric)
+
+static CompactPathRangeScan compactPathSelect3DScan(DeviationMetric3D deviationMetric)
+   {
+   if (deviationMetric == perpendicularDistanceDeviationMetric3D)
+      {
+      return &perpendicularDistance3DScan;
+      }
+   else if (deviationMetric == shortestDistanceToSegmentDeviationMetric3D)
+      {
+      return &shortestDistanceToSegment3DScan;
+      }
+   else if (deviationMetric == synchronizedEuclideanDistanceDeviationMetric3D)
+      {
+      return &synchronizedEuclideanDistance3DScan;
+      }
+   else
+      {
+      return &generic3DScan;
+      }
+   }
+
+int compactPathKeptIndices3D(const DVector3D *pPointArray, unsigned int uPointsInCurrentPath,
+                             uint32_t *puKeptIndices, unsigned int *puPointsInResultPath,
+                             double dEpsilon, DeviationMetric3D deviationMetric)
+   {
+   CompactPath3DPath path;
+
+   if (pPointArray == NULL || deviationMetric == NULL)
+      {
+      return FAILURE;
+      }
+
+   path.pPointArray = pPointArray;
+   path.deviationMetric = deviationMetric;
+
+   return compactPathKeptIndicesWithRangeScan(&path, uPointsInCurrentPath, puKeptIndices,
+                                              puPointsInResultPath, dEpsilon,
+                                              compactPathSelect3DScan(deviationMetric));
+   }
+
+int compactPath3DWithContext(PathCompacterContext *pContext, DVector3D *pPointArray,
+                             unsigned int uPointsInCurrentPath, DVector3D *pResultPointArray,
+                             unsigned int *puPointsInResultPath, double dEpsilon,
+                             DeviationMetric3D deviationMetric)
+   {
+   uint32_t *puKeptIndices;
+   unsigned int u, uNumKept;
+
+   // Check for invalid values.
+   if (uPointsInCurrentPath > INT_MAX || pPointArray == NULL || pResultPointArray == NULL ||
+       puPointsInResultPath == NULL || !(dEpsilon >= 0.0) || deviationMetric == NULL)
+      {
+      return FAILURE;
+      }
+
+   if (pContext->pStats != NULL)
+      {
+      memset(pContext->pStats, 0, sizeof(PathCompacterStats));
+      }
+
+   puKeptIndices = (uint32_t *)compactPathContextGrowScratch(
+      pContext, sizeof(uint32_t) * ((size_t)uPointsInCurrentPath + 1), 0);
+   if (puKeptIndices == NULL)
+      {
+      return FAILURE;
+      }
+
+   if (!compactPathKeptIndices3D(pPointArray, uPointsInCurrentPath, puKeptIndices, &uNumKept,
+                                 dEpsilon, deviationMetric))
+      {
+      return FAILURE;
+      }
+
+   // The indices are increasing, so no kept point moves to a higher index and this is safe in
+   // place.
+   for (u = 0; u < uNumKept; ++u)
+      {
+      pResultPointArray[u] = pPointArray[puKeptIndices[u]];
+      }
+
+   *puPointsInResultPath = uNumKept;
+
+   return SUCCESS;
+   }
+
+int compactPath3D(DVector3D *pPointArray, unsigned int uPointsInCurrentPath,
+                  DVector3D *pResultPointArray, unsigned int *puPointsInResultPath,
+                  double dEpsilon, DeviationMetric3D deviationMetric)
+   {
+   PathCompacterContext context;
+   int iSuccess;
+
+   compactPathContextInit(&context, NULL, NULL, NULL);
+
+   iSuccess = compactPath3DWithContext(&context, pPointArray, uPointsInCurrentPath,
+                                       pResultPointArray, puPointsInResultPath, dEpsilon,
+                                       deviationMetric);
+
+   compactPathContextRelease(&context);
+
+   return iSuccess;
+   }
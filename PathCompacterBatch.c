@@ -0,0 +1,288 @@
+/*
+   PathCompacterBatch.c
+   10/15/2026
+   Authors: Michael Casebolt, Brett Casebolt
+*/
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Michael Casebolt and Brett Casebolt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// This file uses lines up to 100 characters long. If this 100 character line fits then you're good.
+
+#include "PathCompacter.h"
+#include "PathCompacterInternal.h"
+
+#include <stdlib.h> // For memory management
+#include <string.h> // For memmove and memset
+#include <limits.h> // For INT_MAX
+#include <pthread.h> // For the lock around the next path
+
+#define FAILURE 0
+#define SUCCESS 1
+
+// Threads take this many paths at a time, so that short paths don't spend all their time waiting
+// on the lock.
+#define COMPACT_PATH_BATCH_PATHS_PER_TAKE 64
+
+typedef struct CompactPathBatch
+   {
+   DVector2D *pPointArray;
+   const unsigned int *puPathOffsets;
+   unsigned int uPaths;
+   const double *pdEpsilons;
+   double dEpsilon;
+   CompactPathMaxDeviationScan maxDeviationScan;
+   DeviationMetric deviationMetric;
+   DVector2D *pResultPointArray;
+
+   // Until the final packing pass, this holds the number of points in each compacted path.
+   unsigned int *puResultOffsets;
+
+   pthread_mutex_t mutex;
+   unsigned int uNextPath;
+   int iFailed;
+   } CompactPathBatch;
+
+// Each thread keeps its own keep flags, sized for the longest path, and reuses them for every
+// path it compacts.
+typedef struct CompactPathBatchWorker
+   {
+   CompactPathBatch *pBatch;
+   unsigned char *pKeepFlags;
+   } CompactPathBatchWorker;
+
+// Compacts one path into the part of the result array that lines up with its input.
+static int compactPathBatchSolve(CompactPathBatch *pBatch, unsigned char *pKeepFlags,
+                                 unsigned int uPath)
+   {
+   DVector2D *pPoints, *pResult;
+   unsigned int u, uPoints, uKept;
+   double dEpsilon;
+
+   pPoints = pBatch->pPointArray + pBatch->puPathOffsets[uPath];
+   pResult = pBatch->pResultPointArray + pBatch->puPathOffsets[uPath];
+   uPoints = pBatch->puPathOffsets[uPath + 1] - pBatch->puPathOffsets[uPath];
+   dEpsilon = pBatch->pdEpsilons != NULL ? pBatch->pdEpsilons[uPath] : pBatch->dEpsilon;
+
+   // Paths with fewer than three points are already solved.
+   if (uPoints < 3)
+      {
+      if (pResult != pPoints && uPoints > 0)
+         {
+         memmove(pResult, pPoints, sizeof(DVector2D) * uPoints);
+         }
+      pBatch->puResultOffsets[uPath] = uPoints;
+      return SUCCESS;
+      }
+
+   memset(pKeepFlags, 0, uPoints);
+   pKeepFlags[0] = 1;
+   pKeepFlags[uPoints - 1] = 1;
+
+   if (!compactPathMarkSubproblem(pPoints, (int)uPoints, pKeepFlags, dEpsilon,
+                                  pBatch->maxDeviationScan, pBatch->deviationMetric))
+      {
+      return FAILURE;
+      }
+
+   // No kept point ever moves to a higher index, so this is safe in place.
+   uKept = 0;
+   for (u = 0; u < uPoints; ++u)
+      {
+      if (pKeepFlags[u])
+         {
+         pResult[uKept] = pPoints[u];
+         ++uKept;
+         }
+      }
+
+   pBatch->puResultOffsets[uPath] = uKept;
+
+   return SUCCESS;
+   }
+
+static void *compactPathBatchWorkerMain(void *pArgument)
+   {
+   CompactPathBatchWorker *pWorker;
+   CompactPathBatch *pBatch;
+   unsigned int uPath, uEnd;
+
+   pWorker = (CompactPathBatchWorker *)pArgument;
+   pBatch = pWorker->pBatch;
+
+   for (;;)
+      {
+      pthread_mutex_lock(&pBatch->mutex);
+      uPath = pBatch->uNextPath;
+      uEnd = pBatch->iFailed ? uPath : uPath + COMPACT_PATH_BATCH_PATHS_PER_TAKE;
+      if (uEnd > pBatch->uPaths)
+         {
+         uEnd = pBatch->uPaths;
+         }
+      pBatch->uNextPath = uEnd;
+      pthread_mutex_unlock(&pBatch->mutex);
+
+      if (uPath == uEnd)
+         {
+         return NULL;
+         }
+
+      for (; uPath < uEnd; ++uPath)
+         {
+         if (!compactPathBatchSolve(pBatch, pWorker->pKeepFlags, uPath))
+            {
+            pthread_mutex_lock(&pBatch->mutex);
+            pBatch->iFailed = 1;
+            pthread_mutex_unlock(&pBatch->mutex);
+            return NULL;
+            }
+         }
+      }
+   }
+
+// This is the cleanup macro for the compactPathBatch function.
+#define COMPACT_PATH_BATCH_RETURN(iReturnValue)\
+   {\
+   if (pWorkers != NULL)\
+      {\
+      for (u = 0; u < uThreads; ++u)\
+         {\
+         free(pWorkers[u].pKeepFlags);\
+         }\
+      free(pWorkers);\
+      }\
+   if (iMutexInitialized)\
+      {\
+      pthread_mutex_destroy(&batch.mutex);\
+      }\
+   return iReturnValue;\
+   }
+
+int compactPathBatch(DVector2D *pPointArray, const unsigned int *puPathOffsets,
+                     unsigned int uPaths, const double *pdEpsilons, double dEpsilon,
+                     DeviationMetric deviationMetric, DVector2D *pResultPointArray,
+                     unsigned int *puResultOffsets, unsigned int uThreads)
+   {
+   CompactPathBatch batch;
+   CompactPathBatchWorker *pWorkers;
+   unsigned int u, uLongestPath, uNumSolvedPoints, uPointsInPath;
+   int iMutexInitialized;
+
+   pWorkers = NULL;
+   iMutexInitialized = 0;
+
+   // Check for invalid values.
+   if (pPointArray == NULL || puPathOffsets == NULL || pResultPointArray == NULL ||
+       puResultOffsets == NULL || deviationMetric == NULL ||
+       (pdEpsilons == NULL && !(dEpsilon >= 0.0)))
+      {
+      return FAILURE;
+      }
+
+   if (uThreads < 1)
+      {
+      uThreads = 1;
+      }
+   if (uThreads > uPaths / COMPACT_PATH_BATCH_PATHS_PER_TAKE + 1)
+      {
+      // Don't start threads that would never get any paths.
+      uThreads = uPaths / COMPACT_PATH_BATCH_PATHS_PER_TAKE + 1;
+      }
+
+   // The paths are compacted one at a time, and each one counts its points with an int. They are
+   // all checked before any of them is written.
+   uLongestPath = 0;
+   for (u = 0; u < uPaths; ++u)
+      {
+      if (puPathOffsets[u + 1] < puPathOffsets[u] ||
+          puPathOffsets[u + 1] - puPathOffsets[u] > INT_MAX ||
+          (pdEpsilons != NULL && !(pdEpsilons[u] >= 0.0)))
+         {
+         return FAILURE;
+         }
+      if (puPathOffsets[u + 1] - puPathOffsets[u] > uLongestPath)
+         {
+         uLongestPath = puPathOffsets[u + 1] - puPathOffsets[u];
+         }
+      }
+
+   batch.pPointArray = pPointArray;
+   batch.puPathOffsets = puPathOffsets;
+   batch.uPaths = uPaths;
+   batch.pdEpsilons = pdEpsilons;
+   batch.dEpsilon = dEpsilon;
+   batch.maxDeviationScan = compactPathSelectMaxDeviationScan(deviationMetric);
+   batch.deviationMetric = deviationMetric;
+   batch.pResultPointArray = pResultPointArray;
+   batch.puResultOffsets = puResultOffsets;
+   batch.uNextPath = 0;
+   batch.iFailed = 0;
+
+   if (pthread_mutex_init(&batch.mutex, NULL) != 0)
+      {
+      COMPACT_PATH_BATCH_RETURN(FAILURE);
+      }
+   iMutexInitialized = 1;
+
+   pWorkers = (CompactPathBatchWorker *)calloc(uThreads, sizeof(CompactPathBatchWorker));
+   if (pWorkers == NULL)
+      {
+      COMPACT_PATH_BATCH_RETURN(FAILURE);
+      }
+
+   for (u = 0; u < uThreads; ++u)
+      {
+      pWorkers[u].pBatch = &batch;
+      pWorkers[u].pKeepFlags = (unsigned char *)malloc(uLongestPath + 1);
+      if (pWorkers[u].pKeepFlags == NULL)
+         {
+         COMPACT_PATH_BATCH_RETURN(FAILURE);
+         }
+      }
+
+   if (!compactPathRunThreads(compactPathBatchWorkerMain, pWorkers,
+                              sizeof(CompactPathBatchWorker), uThreads) || batch.iFailed)
+      {
+      COMPACT_PATH_BATCH_RETURN(FAILURE);
+      }
+
+   // Every compacted path sits at the start of its input's slot. Pack them together front to back,
+   // turning the point counts into offsets along the way. A path never moves to a higher index,
+   // so it can't overwrite one that hasn't been packed yet.
+   uNumSolvedPoints = 0;
+   for (u = 0; u < uPaths; ++u)
+      {
+      uPointsInPath = puResultOffsets[u];
+      if (uNumSolvedPoints != puPathOffsets[u] && uPointsInPath > 0)
+         {
+         memmove(pResultPointArray + uNumSolvedPoints, pResultPointArray + puPathOffsets[u],
+                 sizeof(DVector2D) * uPointsInPath);
+         }
+      puResultOffsets[u] = uNumSolvedPoints;
+      uNumSolvedPoints += uPointsInPath;
+      }
+   puResultOffsets[uPaths] = uNumSolvedPoints;
+
+   COMPACT_PATH_BATCH_RETURN(SUCCESS);
+   }
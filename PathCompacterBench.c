@@ -0,0 +1,404 @@
+/*
+   PathCompacterBench.c
+   10/15/2026
+   Authors: Michael Casebolt, Brett Casebolt
+*/
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Michael Casebolt and Brett Casebolt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// This file uses lines up to 100 characters long. If this 100 character line fits then you're good.
+
+// This is the pathcompact-bench benchmark. It runs every engine that compactPathWithEngine knows
+// about on synthetic paths of several shapes and sizes, for several epsilons and both metrics,
+// and writes one CSV line per run to stdout so that results can be compared between builds.
+//
+//    pathcompact-bench [-n largest size] [-t seconds per run]
+//
+// Sizes go up by factors of ten from 100 to the largest size (1000000 by default, up to
+// 100000000). Every run is repeated until it has taken at least the given time (0.2 seconds by
+// default), and the fastest repetition is reported.
+// The benchmark is linked with the allocation functions wrapped (see the Makefile), so it can
+// count how many times the library allocates and how much heap memory it holds at its peak.
+
+#include "PathCompacter.h"
+
+#include <stdio.h> // For printf
+#include <stdlib.h> // For memory management and strtod
+#include <string.h> // For memcpy
+#include <math.h> // For sin, cos and sqrt
+#include <time.h> // For clock_gettime
+#include <unistd.h> // For getopt
+#include <malloc.h> // For malloc_usable_size
+
+#define BENCH_SMALLEST_SIZE 100
+#define BENCH_DEFAULT_LARGEST_SIZE 1000000
+#define BENCH_LARGEST_SIZE 100000000
+#define BENCH_DEFAULT_SECONDS_PER_RUN 0.2
+
+// The allocation counters. Only the library's calls are counted, because counting is switched on
+// just around the calls to it.
+static int iCountAllocations;
+static unsigned long long uAllocations;
+static size_t uHeapBytes, uPeakHeapBytes;
+
+void *__real_malloc(size_t uBytes);
+void *__real_calloc(size_t uCount, size_t uBytes);
+void *__real_realloc(void *pMemory, size_t uBytes);
+void __real_free(void *pMemory);
+
+static void countAllocation(void *pMemory)
+   {
+   if (iCountAllocations && pMemory != NULL)
+      {
+      ++uAllocations;
+      uHeapBytes += malloc_usable_size(pMemory);
+      if (uHeapBytes > uPeakHeapBytes)
+         {
+         uPeakHeapBytes = uHeapBytes;
+         }
+      }
+   }
+
+static void countFree(void *pMemory)
+   {
+   size_t uBytes;
+
+   if (iCountAllocations && pMemory != NULL)
+      {
+      uBytes = malloc_usable_size(pMemory);
+      uHeapBytes = uBytes < uHeapBytes ? uHeapBytes - uBytes : 0;
+      }
+   }
+
+void *__wrap_malloc(size_t uBytes)
+   {
+   void *pMemory;
+
+   pMemory = __real_malloc(uBytes);
+   countAllocation(pMemory);
+   return pMemory;
+   }
+
+void *__wrap_calloc(size_t uCount, size_t uBytes)
+   {
+   void *pMemory;
+
+   pMemory = __real_calloc(uCount, uBytes);
+   countAllocation(pMemory);
+   return pMemory;
+   }
+
+void *__wrap_realloc(void *pMemory, size_t uBytes)
+   {
+   void *pNewMemory;
+
+   countFree(pMemory);
+   pNewMemory = __real_realloc(pMemory, uBytes);
+   if (pNewMemory == NULL && pMemory != NULL && uBytes > 0)
+      {
+      // The old block is still there.
+      countAllocation(pMemory);
+      --uAllocations;
+      }
+   countAllocation(pNewMemory);
+   return pNewMemory;
+   }
+
+void __wrap_free(void *pMemory)
+   {
+   countFree(pMemory);
+   __real_free(pMemory);
+   }
+
+// A small xorshift generator, so that every platform benchmarks the same paths.
+static unsigned long long uRandomState;
+
+static double randomUniform(void)
+   {
+   uRandomState ^= uRandomState << 13;
+   uRandomState ^= uRandomState >> 7;
+   uRandomState ^= uRandomState << 17;
+   return (double)(uRandomState >> 11) / 9007199254740992.0;
+   }
+
+static double randomNormal(void)
+   {
+   double dU;
+
+   // Box-Muller, keeping one of the two values.
+   dU = randomUniform();
+   return sqrt(-2.0 * log(dU > 0.0 ? dU : 1e-300)) * cos(6.283185307179586 * randomUniform());
+   }
+
+static void generateRandomWalk(DVector2D *pPoints, unsigned int uPoints)
+   {
+   unsigned int u;
+
+   pPoints[0].dX = 0.0;
+   pPoints[0].dY = 0.0;
+   for (u = 1; u < uPoints; ++u)
+      {
+      pPoints[u].dX = pPoints[u - 1].dX + randomUniform() - 0.5;
+      pPoints[u].dY = pPoints[u - 1].dY + randomUniform() - 0.5;
+      }
+   }
+
+// A line with a little noise on it. The smallest epsilon is below the noise, so nearly every
+// point has to be divided at, while the larger ones settle the whole path with one scan.
+static void generateNearStraightLine(DVector2D *pPoints, unsigned int uPoints)
+   {
+   unsigned int u;
+
+   for (u = 0; u < uPoints; ++u)
+      {
+      pPoints[u].dX = (double)u;
+      pPoints[u].dY = 0.5 * (double)u + 0.05 * (randomUniform() - 0.5);
+      }
+   }
+
+static void generateSinusoid(DVector2D *pPoints, unsigned int uPoints)
+   {
+   unsigned int u;
+
+   for (u = 0; u < uPoints; ++u)
+      {
+      pPoints[u].dX = 0.01 * (double)u;
+      pPoints[u].dY = 10.0 * sin(0.01 * (double)u);
+      }
+   }
+
+static void generateSpiral(DVector2D *pPoints, unsigned int uPoints)
+   {
+   double dAngle;
+   unsigned int u;
+
+   for (u = 0; u < uPoints; ++u)
+      {
+      dAngle = 0.001 * (double)u;
+      pPoints[u].dX = dAngle * cos(dAngle);
+      pPoints[u].dY = dAngle * sin(dAngle);
+      }
+   }
+
+// A vehicle that drives along, turning now and then, sampled once a second with a few meters of
+// receiver noise.
+static void generateGpsTrack(DVector2D *pPoints, unsigned int uPoints)
+   {
+   double dX, dY, dHeading, dSpeed;
+   unsigned int u;
+
+   dX = 0.0;
+   dY = 0.0;
+   dHeading = 0.0;
+   dSpeed = 15.0;
+   for (u = 0; u < uPoints; ++u)
+      {
+      if (randomUniform() < 0.02)
+         {
+         dHeading += (randomUniform() - 0.5) * 3.0;
+         }
+      dSpeed += (randomUniform() - 0.5) * 0.5;
+      dSpeed = dSpeed < 0.0 ? 0.0 : dSpeed > 35.0 ? 35.0 : dSpeed;
+      dX += dSpeed * cos(dHeading);
+      dY += dSpeed * sin(dHeading);
+      pPoints[u].dX = dX + 3.0 * randomNormal();
+      pPoints[u].dY = dY + 3.0 * randomNormal();
+      }
+   }
+
+typedef struct BenchGenerator
+   {
+   const char *pszName;
+   void (*generate)(DVector2D *, unsigned int);
+   } BenchGenerator;
+
+static const BenchGenerator aGenerators[] =
+   {
+   {"random_walk", generateRandomWalk},
+   {"near_straight_line", generateNearStraightLine},
+   {"sinusoid", generateSinusoid},
+   {"spiral", generateSpiral},
+   {"gps_track", generateGpsTrack}
+   };
+
+typedef struct BenchEngine
+   {
+   const char *pszName;
+   PathCompacterEngine engine;
+   } BenchEngine;
+
+static const BenchEngine aEngines[] =
+   {
+   {"iterative", PATH_COMPACTER_ENGINE_ITERATIVE},
+   {"recursive", PATH_COMPACTER_ENGINE_RECURSIVE},
+   {"hull", PATH_COMPACTER_ENGINE_HULL},
+   {"bounded", PATH_COMPACTER_ENGINE_BOUNDED},
+   {"visvalingam", PATH_COMPACTER_ENGINE_VISVALINGAM},
+   {"reumann_witkam", PATH_COMPACTER_ENGINE_REUMANN_WITKAM},
+   {"radial_then_rdp", PATH_COMPACTER_ENGINE_RADIAL_THEN_RDP}
+   };
+
+static const double adEpsilons[] = {0.01, 0.1, 1.0, 10.0};
+
+#define BENCH_COUNT(aArray) (sizeof(aArray) / sizeof((aArray)[0]))
+
+static double secondsNow(void)
+   {
+   struct timespec now;
+
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   return (double)now.tv_sec + 1e-9 * (double)now.tv_nsec;
+   }
+
+int main(int argc, char **argv)
+   {
+   DeviationMetric aMetrics[2];
+   const char *apszMetricNames[2];
+   DVector2D *pPoints, *pResult;
+   unsigned long long uRunAllocations;
+   unsigned int uLargestSize, uSize, uKept, uGenerator, uEngine, uEpsilon, uMetric, uRepetitions;
+   double dSecondsPerRun, dStart, dElapsed, dBest, dTotal;
+   size_t uRunPeakHeapBytes;
+   char *pszEnd;
+   int iOption, iSuccess;
+
+   uLargestSize = BENCH_DEFAULT_LARGEST_SIZE;
+   dSecondsPerRun = BENCH_DEFAULT_SECONDS_PER_RUN;
+
+   while ((iOption = getopt(argc, argv, "n:t:")) != -1)
+      {
+      switch (iOption)
+         {
+         case 'n':
+            uLargestSize = (unsigned int)strtoul(optarg, &pszEnd, 10);
+            if (*pszEnd != '\0' || uLargestSize < BENCH_SMALLEST_SIZE ||
+                uLargestSize > BENCH_LARGEST_SIZE)
+               {
+               fprintf(stderr, "pathcompact-bench: the largest size has to be from %d to %d\n",
+                       BENCH_SMALLEST_SIZE, BENCH_LARGEST_SIZE);
+               return 2;
+               }
+            break;
+
+         case 't':
+            dSecondsPerRun = strtod(optarg, &pszEnd);
+            if (*pszEnd != '\0' || !(dSecondsPerRun >= 0.0))
+               {
+               fprintf(stderr, "pathcompact-bench: bad time '%s'\n", optarg);
+               return 2;
+               }
+            break;
+
+         default:
+            fprintf(stderr, "usage: pathcompact-bench [-n largest size] [-t seconds per run]\n");
+            return 2;
+         }
+      }
+
+   aMetrics[0] = perpendicularDistanceDeviationMetric;
+   apszMetricNames[0] = "perpendicular";
+   aMetrics[1] = shortestDistanceToSegmentDeviationMetric;
+   apszMetricNames[1] = "segment";
+
+   pPoints = (DVector2D *)malloc(sizeof(DVector2D) * uLargestSize);
+   pResult = (DVector2D *)malloc(sizeof(DVector2D) * uLargestSize);
+   if (pPoints == NULL || pResult == NULL)
+      {
+      fprintf(stderr, "pathcompact-bench: out of memory\n");
+      return 1;
+      }
+
+   printf("generator,points,epsilon,metric,engine,kept,repetitions,seconds,points_per_second,"
+          "allocations,peak_heap_bytes\n");
+
+   for (uGenerator = 0; uGenerator < BENCH_COUNT(aGenerators); ++uGenerator)
+      {
+      for (uSize = BENCH_SMALLEST_SIZE; uSize <= uLargestSize; uSize *= 10)
+         {
+         uRandomState = 0x9e3779b97f4a7c15ull;
+         aGenerators[uGenerator].generate(pPoints, uSize);
+
+         for (uEpsilon = 0; uEpsilon < BENCH_COUNT(adEpsilons); ++uEpsilon)
+            {
+            for (uMetric = 0; uMetric < BENCH_COUNT(aMetrics); ++uMetric)
+               {
+               for (uEngine = 0; uEngine < BENCH_COUNT(aEngines); ++uEngine)
+                  {
+                  dBest = 0.0;
+                  dTotal = 0.0;
+                  uKept = 0;
+                  iSuccess = 1;
+                  uRunAllocations = 0;
+                  uRunPeakHeapBytes = 0;
+
+                  for (uRepetitions = 0; iSuccess && (uRepetitions == 0 ||
+                       dTotal < dSecondsPerRun); ++uRepetitions)
+                     {
+                     uAllocations = 0;
+                     uHeapBytes = 0;
+                     uPeakHeapBytes = 0;
+                     iCountAllocations = 1;
+
+                     dStart = secondsNow();
+                     iSuccess = compactPathWithEngine(aEngines[uEngine].engine, pPoints, uSize,
+                                                      pResult, &uKept, adEpsilons[uEpsilon],
+                                                      aMetrics[uMetric]);
+                     dElapsed = secondsNow() - dStart;
+
+                     iCountAllocations = 0;
+
+                     dTotal += dElapsed;
+                     if (uRepetitions == 0 || dElapsed < dBest)
+                        {
+                        dBest = dElapsed;
+                        }
+                     uRunAllocations = uAllocations;
+                     uRunPeakHeapBytes = uPeakHeapBytes;
+                     }
+
+                  if (!iSuccess)
+                     {
+                     fprintf(stderr, "pathcompact-bench: %s failed on %s with %u points\n",
+                             aEngines[uEngine].pszName, aGenerators[uGenerator].pszName, uSize);
+                     return 1;
+                     }
+
+                  printf("%s,%u,%g,%s,%s,%u,%u,%.9f,%.0f,%llu,%lu\n",
+                         aGenerators[uGenerator].pszName, uSize, adEpsilons[uEpsilon],
+                         apszMetricNames[uMetric], aEngines[uEngine].pszName, uKept,
+                         uRepetitions, dBest, dBest > 0.0 ? (double)uSize / dBest : 0.0,
+                         uRunAllocations, (unsigned long)uRunPeakHeapBytes);
+                  fflush(stdout);
+                  }
+               }
+            }
+         }
+      }
+
+   free(pPoints);
+   free(pResult);
+
+   return 0;
+   }
@@ -0,0 +1,241 @@
+/*
+   PathCompacterBounded.c
+   10/15/2026
+   Authors: Michael Casebolt, Brett Casebolt
+*/
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Michael Casebolt and Brett Casebolt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// This file uses lines up to 100 characters long. If this 100 character line fits then you're good.
+
+// This engine tries to prove that a subproblem linearizes before scanning it.
+//
+// Every intermediate point of a subproblem is reached by walking along the path from the start
+// point and on to the end point, so the distances from the point to the two endpoints add up to
+// no more than the length of the path between them. That puts the point inside an ellipse with
+// the endpoints as its foci, and no point of that ellipse is further from the line through the
+// endpoints than its semi-minor axis. With the lengths of the path summed up front, that bound
+// costs a subtraction and a few multiplications, however many points the subproblem has.
+//
+// On a run that is nearly straight, the path is barely longer than the segment, so the bound
+// proves the run linearizes and none of its points get measured. Where the bound isn't good
+// enough, the subproblem is scanned as usual, so the result is always the same as compactPath's.
+// A bound can't stand in for the scan when the subproblem divides, because the division needs the
+// actual farthest point.
+
+#include "PathCompacter.h"
+#include "PathCompacterInternal.h"
+
+#include <stdlib.h> // For memory management
+#include <float.h> // For DBL_EPSILON
+#include <limits.h> // For INT_MAX
+#include <math.h> // For sqrt, fabs and HUGE_VAL
+
+#define FAILURE 0
+#define SUCCESS 1
+
+// A unit of rounding error.
+#define COMPACT_PATH_BOUNDED_ROUNDING (0.5 * DBL_EPSILON)
+
+// The metric's area is at most 6 times the largest coordinate times the path length. Past this
+// product, the square of the area can overflow, and the metric comes out infinite however close
+// the points are to the line, which the bound has no way of following.
+#define COMPACT_PATH_BOUNDED_MAX_AREA 1e150
+
+typedef struct CompactPathBoundedPath
+   {
+   const DVector2D *pPointArray;
+
+   // pdPathLengths[i] is the length of the path from the first point to point i.
+   double *pdPathLengths;
+
+   // How much of the total length the rounding errors in pdPathLengths could add up to.
+   double dPathLengthError;
+
+   double dSquareEpsilon;
+   CompactPathMaxDeviationScan maxDeviationScan;
+   DeviationMetric deviationMetric;
+   } CompactPathBoundedPath;
+
+// Returns a value that the perpendicular distance metric can't reach for any intermediate point
+// of the subproblem from uStart to uEnd, rounding included. The value is NaN or infinite when the
+// path has NaNs or infinities in it, when the endpoints are in the same place, or when the
+// coordinates are so large that the metric could overflow.
+static double compactPathBoundedDeviation(const CompactPathBoundedPath *pPath, unsigned int uStart,
+                                          unsigned int uEnd)
+   {
+   const DVector2D *pStart, *pEnd;
+   double dDX, dDY, dSquareSegLen, dPathLength, dSquareMinorAxis, dMagnitude, dAreaError, dBound;
+
+   pStart = pPath->pPointArray + uStart;
+   pEnd = pPath->pPointArray + uEnd;
+
+   // The scan gets the same segment length from the same differences.
+   dDX = pEnd->dX - pStart->dX;
+   dDY = pEnd->dY - pStart->dY;
+   dSquareSegLen = dDX * dDX + dDY * dDY;
+
+   dPathLength = (pPath->pdPathLengths[uEnd] - pPath->pdPathLengths[uStart]) +
+                 pPath->dPathLengthError;
+
+   // The square of the semi-minor axis is (length^2 - segment length^2) / 4. The segment length
+   // is shrunk a little for its rounding, and the subtraction gets room for its own.
+   dSquareMinorAxis = (dPathLength * dPathLength -
+                       dSquareSegLen * (1.0 - 4.0 * COMPACT_PATH_BOUNDED_ROUNDING)) * 0.25 +
+                      4.0 * COMPACT_PATH_BOUNDED_ROUNDING * dPathLength * dPathLength;
+   if (dSquareMinorAxis < 0.0)
+      {
+      dSquareMinorAxis = 0.0;
+      }
+
+   // Every coordinate of the subproblem is within the path length of the start point. That
+   // bounds the products in the metric's area, and so how far off its rounding can make it.
+   dMagnitude = (fabs(pStart->dX) > fabs(pStart->dY) ? fabs(pStart->dX) : fabs(pStart->dY)) +
+                dPathLength;
+   if (dMagnitude * dPathLength > COMPACT_PATH_BOUNDED_MAX_AREA)
+      {
+      return HUGE_VAL;
+      }
+   dAreaError = 32.0 * COMPACT_PATH_BOUNDED_ROUNDING * dMagnitude * dPathLength;
+
+   dBound = sqrt(dSquareMinorAxis) * (1.0 + 4.0 * COMPACT_PATH_BOUNDED_ROUNDING) +
+            dAreaError / sqrt(dSquareSegLen);
+
+   return dBound * dBound * (1.0 + 64.0 * COMPACT_PATH_BOUNDED_ROUNDING);
+   }
+
+// This is a CompactPathRangeScan. When the bound proves that the subproblem linearizes, it
+// returns 0 and passes back the bound, which is then below the square of epsilon just like the
+// actual largest deviation would have been. Otherwise it returns what the scan returns.
+static int compactPathBoundedRangeScan(const void *pPath, unsigned int uStart,
+                                       int iPointsInCurrentPath, double *pdMaxSquareDeviation)
+   {
+   const CompactPathBoundedPath *pBoundedPath;
+   double dBound;
+
+   pBoundedPath = (const CompactPathBoundedPath *)pPath;
+
+   if (pBoundedPath->pdPathLengths != NULL)
+      {
+      dBound = compactPathBoundedDeviation(pBoundedPath, uStart,
+                                           uStart + (unsigned int)iPointsInCurrentPath - 1);
+      if (dBound < pBoundedPath->dSquareEpsilon)
+         {
+         *pdMaxSquareDeviation = dBound;
+         return 0;
+         }
+      }
+
+   return pBoundedPath->maxDeviationScan(pBoundedPath->pPointArray + uStart, iPointsInCurrentPath,
+                                         pBoundedPath->deviationMetric, pdMaxSquareDeviation);
+   }
+
+// This function runs the Ramer-Douglas-Peucker algorithm, skipping the scan of every subproblem
+// that the bound described at the top of this file proves will linearize. The arguments and the
+// result are the same as for compactPath, and so is the output, point for point. It works
+// in-place too.
+// The bound only holds for perpendicularDistanceDeviationMetric. Any other metric scans every
+// subproblem, like compactPath does.
+// The path lengths and the kept indices take about 8 + 4 bytes per point of memory.
+int compactPathBounded(DVector2D *pPointArray, unsigned int uPointsInCurrentPath,
+                       DVector2D *pResultPointArray, unsigned int *puPointsInResultPath,
+                       double dEpsilon, DeviationMetric deviationMetric)
+   {
+   CompactPathBoundedPath boundedPath;
+   uint32_t *puKeptIndices;
+   unsigned int u, uNumKept;
+   double dDX, dDY;
+   int iSuccess;
+
+   // Check for invalid values.
+   if (uPointsInCurrentPath > INT_MAX || pPointArray == NULL || pResultPointArray == NULL ||
+       puPointsInResultPath == NULL || !(dEpsilon >= 0.0) || deviationMetric == NULL)
+      {
+      return FAILURE;
+      }
+
+   boundedPath.pPointArray = pPointArray;
+   boundedPath.pdPathLengths = NULL;
+   boundedPath.dPathLengthError = 0.0;
+   boundedPath.dSquareEpsilon = dEpsilon * dEpsilon;
+   boundedPath.maxDeviationScan = compactPathSelectMaxDeviationScan(deviationMetric);
+   boundedPath.deviationMetric = deviationMetric;
+
+   puKeptIndices = (uint32_t *)malloc(sizeof(uint32_t) * (uPointsInCurrentPath + 1));
+   if (puKeptIndices == NULL)
+      {
+      return FAILURE;
+      }
+
+   if (deviationMetric == perpendicularDistanceDeviationMetric && uPointsInCurrentPath >= 3)
+      {
+      boundedPath.pdPathLengths = (double *)malloc(sizeof(double) * uPointsInCurrentPath);
+      if (boundedPath.pdPathLengths == NULL)
+         {
+         free(puKeptIndices);
+         return FAILURE;
+         }
+
+      boundedPath.pdPathLengths[0] = 0.0;
+      for (u = 1; u < uPointsInCurrentPath; ++u)
+         {
+         dDX = pPointArray[u].dX - pPointArray[u - 1].dX;
+         dDY = pPointArray[u].dY - pPointArray[u - 1].dY;
+         boundedPath.pdPathLengths[u] = boundedPath.pdPathLengths[u - 1] +
+                                        sqrt(dDX * dDX + dDY * dDY);
+         }
+
+      // Each step of the sum rounds once and each segment length rounds a few times, and none of
+      // those errors are larger than a rounding of the whole length.
+      boundedPath.dPathLengthError = 2.0 * ((double)uPointsInCurrentPath + 8.0) *
+                                     COMPACT_PATH_BOUNDED_ROUNDING *
+                                     boundedPath.pdPathLengths[uPointsInCurrentPath - 1];
+      }
+
+   iSuccess = compactPathKeptIndicesWithRangeScan(&boundedPath, uPointsInCurrentPath,
+                                                  puKeptIndices, &uNumKept, dEpsilon,
+                                                  compactPathBoundedRangeScan);
+
+   free(boundedPath.pdPathLengths);
+
+   if (!iSuccess)
+      {
+      free(puKeptIndices);
+      return FAILURE;
+      }
+
+   // The indices are increasing, so no kept point moves to a higher index and this is safe in
+   // place.
+   for (u = 0; u < uNumKept; ++u)
+      {
+      pResultPointArray[u] = pPointArray[puKeptIndices[u]];
+      }
+
+   free(puKeptIndices);
+
+   *puPointsInResultPath = uNumKept;
+
+   return SUCCESS;
+   }
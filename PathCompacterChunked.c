@@ -0,0 +1,339 @@
+/*
+   PathCompacterChunked.c
+   10/15/2026
+   Authors: Michael Casebolt, Brett Casebolt
+*/
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Michael Casebolt and Brett Casebolt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// This file uses lines up to 100 characters long. If this 100 character line fits then you're good.
+
+#include "PathCompacter.h"
+#include "PathCompacterInternal.h"
+
+#include <stdlib.h> // For memory management
+#include <string.h> // For memcpy and memmove
+#include <limits.h> // For INT_MAX
+
+#define FAILURE 0
+#define SUCCESS 1
+
+// One chunk of the path. Its first point is the last point of the chunk before it, so the two
+// share the seam point between them.
+typedef struct CompactPathChunk
+   {
+   DVector2D *pPointArray;
+   unsigned char *pKeepFlags;
+   unsigned int uPoints;
+   double dEpsilon;
+   CompactPathMaxDeviationScan maxDeviationScan;
+   DeviationMetric deviationMetric;
+   int iSuccess;
+   } CompactPathChunk;
+
+// Everything the stitching needs to carry from one chunk to the next.
+typedef struct CompactPathChunkedStitch
+   {
+   // The points of the path from the last point that was emitted up to the seam point that the
+   // next chunk starts with. All of them are original points, so a seam can be checked against
+   // everything it would replace.
+   DVector2D *pTail;
+   unsigned int uTailPoints;
+   unsigned int uTailCapacity;
+
+   double dEpsilon;
+   CompactPathMaxDeviationScan maxDeviationScan;
+   DeviationMetric deviationMetric;
+   PathCompacterEmitCallback emitCallback;
+   void *pUserData;
+   unsigned long long uPointsEmitted;
+   } CompactPathChunkedStitch;
+
+static void *compactPathChunkedMarkMain(void *pArgument)
+   {
+   CompactPathChunk *pChunk;
+
+   pChunk = (CompactPathChunk *)pArgument;
+
+   memset(pChunk->pKeepFlags, 0, pChunk->uPoints);
+   pChunk->pKeepFlags[0] = 1;
+   pChunk->pKeepFlags[pChunk->uPoints - 1] = 1;
+
+   pChunk->iSuccess = pChunk->uPoints < 3 ||
+                      compactPathMarkSubproblem(pChunk->pPointArray, (int)pChunk->uPoints,
+                                                pChunk->pKeepFlags, pChunk->dEpsilon,
+                                                pChunk->maxDeviationScan, pChunk->deviationMetric);
+
+   return NULL;
+   }
+
+// Reads points until uMaxPoints have been read or the callback runs out.
+static int compactPathChunkedFill(PathCompacterReadCallback readCallback, void *pUserData,
+                                  DVector2D *pPointArray, unsigned int uMaxPoints,
+                                  unsigned int *puPointsRead)
+   {
+   unsigned int uPointsRead, uPointsInCall;
+
+   uPointsRead = 0;
+   while (uPointsRead < uMaxPoints)
+      {
+      uPointsInCall = 0;
+      if (!readCallback(pUserData, pPointArray + uPointsRead, uMaxPoints - uPointsRead,
+                        &uPointsInCall) || uPointsInCall > uMaxPoints - uPointsRead)
+         {
+         return FAILURE;
+         }
+      if (uPointsInCall == 0)
+         {
+         break;
+         }
+      uPointsRead += uPointsInCall;
+      }
+
+   *puPointsRead = uPointsRead;
+
+   return SUCCESS;
+   }
+
+static void compactPathChunkedEmit(CompactPathChunkedStitch *pStitch, DVector2D point)
+   {
+   pStitch->emitCallback(pStitch->pUserData, point);
+   ++pStitch->uPointsEmitted;
+   }
+
+// Emits the kept points of a chunk that has been marked. The chunk's first point is the seam
+// with the one before it, which was pinned while the chunks were compacted. If the run from the
+// last emitted point, across the seam, to the first kept point in this chunk linearizes on its
+// own, the seam point gets dropped. Otherwise it is emitted.
+static void compactPathChunkedStitch(CompactPathChunkedStitch *pStitch,
+                                     const CompactPathChunk *pChunk)
+   {
+   double dMaxSquareDeviation;
+   unsigned int u, uFirstKept, uLastPoint, uLastKept;
+   int iMerged;
+
+   uLastPoint = pChunk->uPoints - 1;
+   for (uFirstKept = 1; !pChunk->pKeepFlags[uFirstKept]; ++uFirstKept)
+      {
+      }
+
+   // The run has to fit in the tail, so that memory use stays fixed even when whole chunks keep
+   // merging into it.
+   iMerged = 0;
+   if (pStitch->uTailPoints >= 2 && pStitch->uTailPoints + uFirstKept <= pStitch->uTailCapacity)
+      {
+      memcpy(pStitch->pTail + pStitch->uTailPoints, pChunk->pPointArray + 1,
+             sizeof(DVector2D) * uFirstKept);
+      pStitch->maxDeviationScan(pStitch->pTail, (int)(pStitch->uTailPoints + uFirstKept),
+                                pStitch->deviationMetric, &dMaxSquareDeviation);
+      if (dMaxSquareDeviation < pStitch->dEpsilon * pStitch->dEpsilon)
+         {
+         pStitch->uTailPoints += uFirstKept;
+         iMerged = 1;
+         }
+      }
+
+   if (!iMerged)
+      {
+      // With a single point in the tail, the seam is the last emitted point already.
+      if (pStitch->uTailPoints >= 2)
+         {
+         compactPathChunkedEmit(pStitch, pChunk->pPointArray[0]);
+         }
+      memcpy(pStitch->pTail, pChunk->pPointArray, sizeof(DVector2D) * (uFirstKept + 1));
+      pStitch->uTailPoints = uFirstKept + 1;
+      }
+
+   // If the first kept point is the next seam, the whole chunk is part of the tail now.
+   if (uFirstKept == uLastPoint)
+      {
+      return;
+      }
+
+   uLastKept = uFirstKept;
+   for (u = uFirstKept; u < uLastPoint; ++u)
+      {
+      if (pChunk->pKeepFlags[u])
+         {
+         compactPathChunkedEmit(pStitch, pChunk->pPointArray[u]);
+         uLastKept = u;
+         }
+      }
+
+   pStitch->uTailPoints = uLastPoint - uLastKept + 1;
+   memcpy(pStitch->pTail, pChunk->pPointArray + uLastKept,
+          sizeof(DVector2D) * pStitch->uTailPoints);
+   }
+
+// This is the cleanup macro for the compactPathChunked function.
+#define COMPACT_PATH_CHUNKED_RETURN(iReturnValue)\
+   {\
+   if (pChunks != NULL)\
+      {\
+      for (u = 0; u < uThreads; ++u)\
+         {\
+         free(pChunks[u].pPointArray);\
+         free(pChunks[u].pKeepFlags);\
+         }\
+      free(pChunks);\
+      }\
+   free(stitch.pTail);\
+   *puPointsInResultPath = stitch.uPointsEmitted;\
+   return iReturnValue;\
+   }
+
+int compactPathChunked(PathCompacterReadCallback readCallback, void *pReadUserData,
+                       unsigned int uChunkPoints, unsigned int uThreads, double dEpsilon,
+                       DeviationMetric deviationMetric, PathCompacterEmitCallback emitCallback,
+                       void *pEmitUserData, unsigned long long *puPointsInResultPath)
+   {
+   CompactPathChunkedStitch stitch;
+   CompactPathChunk *pChunks;
+   DVector2D carry;
+   unsigned int u, uChunks, uPointsRead;
+   int iFinished;
+
+   if (puPointsInResultPath == NULL)
+      {
+      return FAILURE;
+      }
+
+   pChunks = NULL;
+   stitch.pTail = NULL;
+   stitch.uPointsEmitted = 0;
+
+   if (uThreads < 1)
+      {
+      uThreads = 1;
+      }
+
+   // Check for invalid values.
+   if (readCallback == NULL || emitCallback == NULL || uChunkPoints < 2 ||
+       uChunkPoints > INT_MAX / 2 - 1 || !(dEpsilon >= 0.0) || deviationMetric == NULL)
+      {
+      COMPACT_PATH_CHUNKED_RETURN(FAILURE);
+      }
+
+   stitch.uTailCapacity = 2 * (uChunkPoints + 1);
+   stitch.uTailPoints = 0;
+   stitch.dEpsilon = dEpsilon;
+   stitch.maxDeviationScan = compactPathSelectMaxDeviationScan(deviationMetric);
+   stitch.deviationMetric = deviationMetric;
+   stitch.emitCallback = emitCallback;
+   stitch.pUserData = pEmitUserData;
+
+   stitch.pTail = (DVector2D *)malloc(sizeof(DVector2D) * stitch.uTailCapacity);
+   pChunks = (CompactPathChunk *)calloc(uThreads, sizeof(CompactPathChunk));
+   if (stitch.pTail == NULL || pChunks == NULL)
+      {
+      COMPACT_PATH_CHUNKED_RETURN(FAILURE);
+      }
+
+   for (u = 0; u < uThreads; ++u)
+      {
+      pChunks[u].pPointArray = (DVector2D *)malloc(sizeof(DVector2D) * (uChunkPoints + 1));
+      pChunks[u].pKeepFlags = (unsigned char *)malloc(uChunkPoints + 1);
+      if (pChunks[u].pPointArray == NULL || pChunks[u].pKeepFlags == NULL)
+         {
+         COMPACT_PATH_CHUNKED_RETURN(FAILURE);
+         }
+      pChunks[u].dEpsilon = dEpsilon;
+      pChunks[u].maxDeviationScan = stitch.maxDeviationScan;
+      pChunks[u].deviationMetric = deviationMetric;
+      }
+
+   // The first point is always kept, so it can go out right away.
+   if (!compactPathChunkedFill(readCallback, pReadUserData, &carry, 1, &uPointsRead))
+      {
+      COMPACT_PATH_CHUNKED_RETURN(FAILURE);
+      }
+   if (uPointsRead == 0)
+      {
+      COMPACT_PATH_CHUNKED_RETURN(SUCCESS);
+      }
+   compactPathChunkedEmit(&stitch, carry);
+   stitch.pTail[0] = carry;
+   stitch.uTailPoints = 1;
+
+   iFinished = 0;
+   while (!iFinished)
+      {
+      // Read a chunk for every thread.
+      for (uChunks = 0; uChunks < uThreads; ++uChunks)
+         {
+         pChunks[uChunks].pPointArray[0] = carry;
+         if (!compactPathChunkedFill(readCallback, pReadUserData,
+                                     pChunks[uChunks].pPointArray + 1, uChunkPoints,
+                                     &uPointsRead))
+            {
+            COMPACT_PATH_CHUNKED_RETURN(FAILURE);
+            }
+         if (uPointsRead == 0)
+            {
+            iFinished = 1;
+            break;
+            }
+
+         pChunks[uChunks].uPoints = uPointsRead + 1;
+         carry = pChunks[uChunks].pPointArray[uPointsRead];
+
+         if (uPointsRead < uChunkPoints)
+            {
+            iFinished = 1;
+            ++uChunks;
+            break;
+            }
+         }
+
+      if (uChunks == 0)
+         {
+         break;
+         }
+
+      // Compact them all at once, each with both of its ends pinned.
+      if (!compactPathRunThreads(compactPathChunkedMarkMain, pChunks, sizeof(CompactPathChunk),
+                                 uChunks))
+         {
+         COMPACT_PATH_CHUNKED_RETURN(FAILURE);
+         }
+
+      for (u = 0; u < uChunks; ++u)
+         {
+         if (!pChunks[u].iSuccess)
+            {
+            COMPACT_PATH_CHUNKED_RETURN(FAILURE);
+            }
+         compactPathChunkedStitch(&stitch, pChunks + u);
+         }
+      }
+
+   // The last point is always kept.
+   if (stitch.uTailPoints >= 2)
+      {
+      compactPathChunkedEmit(&stitch, stitch.pTail[stitch.uTailPoints - 1]);
+      }
+
+   COMPACT_PATH_CHUNKED_RETURN(SUCCESS);
+   }
@@ -0,0 +1,408 @@
+/*
+   PathCompacterCli.c
+   10/15/2026
+   Authors: Michael Casebolt, Brett Casebolt
+*/
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Michael Casebolt and Brett Casebolt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// This file uses lines up to 100 characters long. If this 100 character line fits then you're good.
+
+// This is the pathcompact command line tool. It compacts one path stored in a file and writes the
+// result to another file.
+//
+//    pathcompact [-e epsilon] [-m perpendicular|segment] [-f raw|csv] input output
+//
+// A raw file is nothing but DVector2D points (pairs of native doubles, X then Y) back to back.
+// It is memory mapped read only and never copied onto the heap. The kept points are found with
+// compactPathKeepBitmap, which needs one bit per point, and are then written out in one
+// sequential pass, so a path of several gigabytes only needs a few hundred megabytes of memory.
+// A CSV file has one "x,y" point per line. It has to be parsed, so its points do end up on the
+// heap, but the file itself is still mapped rather than read.
+
+#include "PathCompacter.h"
+
+#include <stdio.h> // For the output file and error messages
+#include <stdlib.h> // For memory management and strtod
+#include <string.h> // For strcmp and strerror
+#include <errno.h> // For errno
+#include <unistd.h> // For getopt and close
+#include <fcntl.h> // For open
+#include <sys/mman.h> // For mmap and madvise
+#include <sys/stat.h> // For fstat
+
+#define FAILURE 0
+#define SUCCESS 1
+
+// The output file gets written through a buffer this big.
+#define PATH_COMPACTER_CLI_OUTPUT_BUFFER_BYTES (1 << 20)
+
+typedef enum PathCompacterCliFormat
+   {
+   PATH_COMPACTER_CLI_FORMAT_RAW,
+   PATH_COMPACTER_CLI_FORMAT_CSV
+   } PathCompacterCliFormat;
+
+// A file that is mapped into memory read only.
+typedef struct PathCompacterCliMapping
+   {
+   const unsigned char *pBytes;
+   size_t uBytes;
+   } PathCompacterCliMapping;
+
+static void printUsage(FILE *pFile)
+   {
+   fprintf(pFile,
+           "usage: pathcompact [-e epsilon] [-m perpendicular|segment|crosstrack|ellipsoidal] "
+           "[-f raw|csv] input output\n"
+           "  -e  the largest deviation a dropped point can have (default 1.0)\n"
+           "  -m  the deviation metric (default perpendicular). crosstrack and ellipsoidal\n"
+           "      take longitude,latitude in degrees and epsilon in meters\n"
+           "  -f  the file format: raw DVector2D points or x,y lines (default raw)\n");
+   }
+
+static int mapFile(const char *pszPath, PathCompacterCliMapping *pMapping)
+   {
+   struct stat fileStatus;
+   void *pMemory;
+   int iFile;
+
+   pMapping->pBytes = NULL;
+   pMapping->uBytes = 0;
+
+   iFile = open(pszPath, O_RDONLY);
+   if (iFile < 0)
+      {
+      return FAILURE;
+      }
+
+   if (fstat(iFile, &fileStatus) != 0)
+      {
+      close(iFile);
+      return FAILURE;
+      }
+
+   // An empty file can't be mapped, but it is a valid empty path.
+   if (fileStatus.st_size == 0)
+      {
+      close(iFile);
+      return SUCCESS;
+      }
+
+   pMemory = mmap(NULL, (size_t)fileStatus.st_size, PROT_READ, MAP_PRIVATE, iFile, 0);
+   close(iFile);
+   if (pMemory == MAP_FAILED)
+      {
+      return FAILURE;
+      }
+
+   pMapping->pBytes = (const unsigned char *)pMemory;
+   pMapping->uBytes = (size_t)fileStatus.st_size;
+
+   return SUCCESS;
+   }
+
+static void unmapFile(PathCompacterCliMapping *pMapping)
+   {
+   if (pMapping->pBytes != NULL)
+      {
+      munmap((void *)pMapping->pBytes, pMapping->uBytes);
+      }
+   }
+
+// Parses "x,y" lines straight out of the mapping. Blank lines are skipped.
+// Returns NULL and sets errno if a line can't be parsed or if memory runs out.
+static DVector2D *parseCsv(const PathCompacterCliMapping *pMapping, unsigned int *puPoints)
+   {
+   DVector2D *pPoints, *pGrown;
+   const char *pszLine, *pszEnd;
+   char *pszNumberEnd, szNumber[64];
+   size_t uCapacity, uPoints, uLength;
+   double adCoordinates[2];
+   int i;
+
+   pPoints = NULL;
+   uCapacity = 0;
+   uPoints = 0;
+
+   pszLine = (const char *)pMapping->pBytes;
+   pszEnd = pszLine + pMapping->uBytes;
+
+   while (pszLine < pszEnd)
+      {
+      while (pszLine < pszEnd && (*pszLine == '\n' || *pszLine == '\r'))
+         {
+         ++pszLine;
+         }
+      if (pszLine == pszEnd)
+         {
+         break;
+         }
+
+      // strtod needs a terminated string and the mapping isn't one, so each number is copied
+      // into a small buffer first.
+      for (i = 0; i < 2; ++i)
+         {
+         for (uLength = 0; pszLine + uLength < pszEnd && pszLine[uLength] != ',' &&
+              pszLine[uLength] != '\n' && pszLine[uLength] != '\r'; ++uLength)
+            {
+            }
+         if (uLength == 0 || uLength >= sizeof(szNumber) ||
+             (i == 0 && (pszLine + uLength == pszEnd || pszLine[uLength] != ',')))
+            {
+            free(pPoints);
+            errno = EINVAL;
+            return NULL;
+            }
+         memcpy(szNumber, pszLine, uLength);
+         szNumber[uLength] = '\0';
+         adCoordinates[i] = strtod(szNumber, &pszNumberEnd);
+         if (*pszNumberEnd != '\0' && *pszNumberEnd != ' ')
+            {
+            free(pPoints);
+            errno = EINVAL;
+            return NULL;
+            }
+         pszLine += uLength + (i == 0);
+         }
+
+      if (uPoints == uCapacity)
+         {
+         uCapacity = uCapacity == 0 ? 4096 : uCapacity * 2;
+         pGrown = uCapacity > 0xffffffffu ? NULL :
+            (DVector2D *)realloc(pPoints, sizeof(DVector2D) * uCapacity);
+         if (pGrown == NULL)
+            {
+            free(pPoints);
+            errno = ENOMEM;
+            return NULL;
+            }
+         pPoints = pGrown;
+         }
+
+      pPoints[uPoints].dX = adCoordinates[0];
+      pPoints[uPoints].dY = adCoordinates[1];
+      ++uPoints;
+      }
+
+   *puPoints = (unsigned int)uPoints;
+
+   // Hand back something that can be freed even for an empty file.
+   return pPoints != NULL ? pPoints : (DVector2D *)malloc(sizeof(DVector2D));
+   }
+
+static int writePoint(FILE *pOutput, DVector2D point, PathCompacterCliFormat format)
+   {
+   if (format == PATH_COMPACTER_CLI_FORMAT_CSV)
+      {
+      return fprintf(pOutput, "%.17g,%.17g\n", point.dX, point.dY) > 0;
+      }
+   else
+      {
+      return fwrite(&point, sizeof(DVector2D), 1, pOutput) == 1;
+      }
+   }
+
+int main(int argc, char **argv)
+   {
+   PathCompacterCliMapping mapping;
+   PathCompacterCliFormat format;
+   DeviationMetric deviationMetric;
+   const DVector2D *pPoints;
+   DVector2D *pParsedPoints;
+   unsigned char *pKeepBitmap;
+   unsigned int u, uPoints, uKept;
+   double dEpsilon;
+   char *pszEnd;
+   FILE *pOutput;
+   int iOption, iSuccess;
+
+   dEpsilon = 1.0;
+   deviationMetric = perpendicularDistanceDeviationMetric;
+   format = PATH_COMPACTER_CLI_FORMAT_RAW;
+
+   while ((iOption = getopt(argc, argv, "e:m:f:h")) != -1)
+      {
+      switch (iOption)
+         {
+         case 'e':
+            dEpsilon = strtod(optarg, &pszEnd);
+            if (*pszEnd != '\0' || !(dEpsilon >= 0.0))
+               {
+               fprintf(stderr, "pathcompact: bad epsilon '%s'\n", optarg);
+               return 2;
+               }
+            break;
+
+         case 'm':
+            if (strcmp(optarg, "perpendicular") == 0)
+               {
+               deviationMetric = perpendicularDistanceDeviationMetric;
+               }
+            else if (strcmp(optarg, "segment") == 0)
+               {
+               deviationMetric = shortestDistanceToSegmentDeviationMetric;
+               }
+            else if (strcmp(optarg, "crosstrack") == 0)
+               {
+               deviationMetric = crossTrackDistanceDeviationMetric;
+               }
+            else if (strcmp(optarg, "ellipsoidal") == 0)
+               {
+               deviationMetric = ellipsoidalCrossTrackDistanceDeviationMetric;
+               }
+            else
+               {
+               fprintf(stderr, "pathcompact: unknown metric '%s'\n", optarg);
+               return 2;
+               }
+            break;
+
+         case 'f':
+            if (strcmp(optarg, "raw") == 0)
+               {
+               format = PATH_COMPACTER_CLI_FORMAT_RAW;
+               }
+            else if (strcmp(optarg, "csv") == 0)
+               {
+               format = PATH_COMPACTER_CLI_FORMAT_CSV;
+               }
+            else
+               {
+               fprintf(stderr, "pathcompact: unknown format '%s'\n", optarg);
+               return 2;
+               }
+            break;
+
+         case 'h':
+            printUsage(stdout);
+            return 0;
+
+         default:
+            printUsage(stderr);
+            return 2;
+         }
+      }
+
+   if (argc - optind != 2)
+      {
+      printUsage(stderr);
+      return 2;
+      }
+
+   if (!mapFile(argv[optind], &mapping))
+      {
+      fprintf(stderr, "pathcompact: can't map '%s': %s\n", argv[optind], strerror(errno));
+      return 1;
+      }
+
+   pParsedPoints = NULL;
+   if (format == PATH_COMPACTER_CLI_FORMAT_CSV)
+      {
+      // The text is parsed in one pass from front to back, so aggressive read ahead helps, and the
+      // kernel can reclaim the pages behind it sooner. The points get copied out, so the mapping
+      // is let go as soon as they are.
+      if (mapping.pBytes != NULL)
+         {
+         madvise((void *)mapping.pBytes, mapping.uBytes, MADV_SEQUENTIAL);
+         }
+      pParsedPoints = parseCsv(&mapping, &uPoints);
+      if (pParsedPoints == NULL)
+         {
+         fprintf(stderr, "pathcompact: can't read '%s': %s\n", argv[optind], strerror(errno));
+         unmapFile(&mapping);
+         return 1;
+         }
+      unmapFile(&mapping);
+      mapping.pBytes = NULL;
+      pPoints = pParsedPoints;
+      }
+   else
+      {
+      if (mapping.uBytes % sizeof(DVector2D) != 0 ||
+          mapping.uBytes / sizeof(DVector2D) > 0x7fffffff)
+         {
+         fprintf(stderr, "pathcompact: '%s' isn't a whole number of points\n", argv[optind]);
+         unmapFile(&mapping);
+         return 1;
+         }
+      // The compaction reads the points in place. Its first scan reads all of them, and later ones
+      // go back over parts of the path in no fixed order, so ask for the whole file up front
+      // rather than hinting at sequential access.
+      if (mapping.pBytes != NULL)
+         {
+         madvise((void *)mapping.pBytes, mapping.uBytes, MADV_WILLNEED);
+         }
+      pPoints = (const DVector2D *)mapping.pBytes;
+      uPoints = (unsigned int)(mapping.uBytes / sizeof(DVector2D));
+      }
+
+   pKeepBitmap = (unsigned char *)malloc((uPoints + 7) / 8 + 1);
+   if (pKeepBitmap == NULL ||
+       !compactPathKeepBitmap(pPoints, uPoints, pKeepBitmap, &uKept, dEpsilon, deviationMetric))
+      {
+      fprintf(stderr, "pathcompact: compaction failed\n");
+      free(pKeepBitmap);
+      free(pParsedPoints);
+      unmapFile(&mapping);
+      return 1;
+      }
+
+   pOutput = fopen(argv[optind + 1], format == PATH_COMPACTER_CLI_FORMAT_CSV ? "w" : "wb");
+   if (pOutput == NULL)
+      {
+      fprintf(stderr, "pathcompact: can't open '%s': %s\n", argv[optind + 1], strerror(errno));
+      free(pKeepBitmap);
+      free(pParsedPoints);
+      unmapFile(&mapping);
+      return 1;
+      }
+   setvbuf(pOutput, NULL, _IOFBF, PATH_COMPACTER_CLI_OUTPUT_BUFFER_BYTES);
+
+   iSuccess = SUCCESS;
+   for (u = 0; u < uPoints && iSuccess; ++u)
+      {
+      if ((pKeepBitmap[u >> 3] >> (u & 7)) & 1)
+         {
+         iSuccess = writePoint(pOutput, pPoints[u], format);
+         }
+      }
+   if (fclose(pOutput) != 0)
+      {
+      iSuccess = FAILURE;
+      }
+
+   free(pKeepBitmap);
+   free(pParsedPoints);
+   unmapFile(&mapping);
+
+   if (!iSuccess)
+      {
+      fprintf(stderr, "pathcompact: can't write '%s'\n", argv[optind + 1]);
+      return 1;
+      }
+
+   return 0;
+   }
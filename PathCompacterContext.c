@@ -0,0 +1,185 @@
+/*
+   PathCompacterContext.c
+   10/15/2026
+   Authors: Michael Casebolt, Brett Casebolt
+*/
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Michael Casebolt and Brett Casebolt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// This file uses lines up to 100 characters long. If this 100 character line fits then you're good.
+
+#include "PathCompacter.h"
+#include "PathCompacterInternal.h"
+
+#include <stdlib.h> // For memory management
+#include <errno.h> // For ENOMEM
+#include <string.h> // For memcpy
+
+#define FAILURE 0
+#define SUCCESS 1
+
+static void *compactPathContextDefaultAlloc(void *pAllocatorData, size_t uBytes)
+   {
+   (void)pAllocatorData;
+   return malloc(uBytes);
+   }
+
+static void compactPathContextDefaultFree(void *pAllocatorData, void *pMemory)
+   {
+   (void)pAllocatorData;
+   free(pMemory);
+   }
+
+void compactPathContextInit(PathCompacterContext *pContext,
+                            PathCompacterAllocFunction allocFunction,
+                            PathCompacterFreeFunction freeFunction, void *pAllocatorData)
+   {
+   if (allocFunction == NULL || freeFunction == NULL)
+      {
+      allocFunction = &compactPathContextDefaultAlloc;
+      freeFunction = &compactPathContextDefaultFree;
+      }
+
+   pContext->allocFunction = allocFunction;
+   pContext->freeFunction = freeFunction;
+   pContext->pAllocatorData = pAllocatorData;
+   pContext->pScratch = NULL;
+   pContext->uScratchBytes = 0;
+   pContext->uHighWaterMark = 0;
+   pContext->iOwnsScratch = 1;
+   pContext->pStats = NULL;
+   pContext->pMetric = NULL;
+   }
+
+void compactPathContextInitWithArena(PathCompacterContext *pContext, void *pArena,
+                                     size_t uArenaBytes)
+   {
+   // Without allocation functions, the context can't grow past the arena.
+   pContext->allocFunction = NULL;
+   pContext->freeFunction = NULL;
+   pContext->pAllocatorData = NULL;
+   pContext->pScratch = pArena;
+   pContext->uScratchBytes = pArena != NULL ? uArenaBytes : 0;
+   pContext->uHighWaterMark = 0;
+   pContext->iOwnsScratch = 0;
+   pContext->pStats = NULL;
+   pContext->pMetric = NULL;
+   }
+
+void *compactPathContextGrowScratch(PathCompacterContext *pContext, size_t uBytes,
+                                    size_t uBytesToKeep)
+   {
+   void *pGrownScratch;
+
+   if (uBytes > pContext->uHighWaterMark)
+      {
+      pContext->uHighWaterMark = uBytes;
+      }
+
+   if (uBytes <= pContext->uScratchBytes)
+      {
+      return pContext->pScratch;
+      }
+
+   if (pContext->allocFunction == NULL)
+      {
+      // This is an arena, and it is too small.
+      errno = ENOMEM;
+      return NULL;
+      }
+
+   pGrownScratch = pContext->allocFunction(pContext->pAllocatorData, uBytes);
+   if (pGrownScratch == NULL)
+      {
+      return NULL;
+      }
+
+   if (uBytesToKeep > 0)
+      {
+      memcpy(pGrownScratch, pContext->pScratch, uBytesToKeep);
+      }
+
+   if (pContext->iOwnsScratch && pContext->pScratch != NULL)
+      {
+      pContext->freeFunction(pContext->pAllocatorData, pContext->pScratch);
+      }
+
+   pContext->pScratch = pGrownScratch;
+   pContext->uScratchBytes = uBytes;
+   pContext->iOwnsScratch = 1;
+
+   if (pContext->pStats != NULL)
+      {
+      ++pContext->pStats->uStackReallocations;
+      }
+
+   return pGrownScratch;
+   }
+
+int compactPathContextReserve(PathCompacterContext *pContext, size_t uBytes)
+   {
+   size_t uHighWaterMark;
+
+   // Reserving isn't the same as needing, so leave the high water mark alone.
+   uHighWaterMark = pContext->uHighWaterMark;
+
+   if (compactPathContextGrowScratch(pContext, uBytes, 0) == NULL)
+      {
+      pContext->uHighWaterMark = uHighWaterMark;
+      return FAILURE;
+      }
+
+   pContext->uHighWaterMark = uHighWaterMark;
+   return SUCCESS;
+   }
+
+void compactPathContextSetStats(PathCompacterContext *pContext, PathCompacterStats *pStats)
+   {
+   pContext->pStats = pStats;
+   }
+
+void compactPathContextSetMetric(PathCompacterContext *pContext, const PathCompacterMetric *pMetric)
+   {
+   pContext->pMetric = pMetric;
+   }
+
+size_t compactPathContextHighWaterMark(const PathCompacterContext *pContext)
+   {
+   return pContext->uHighWaterMark;
+   }
+
+void compactPathContextRelease(PathCompacterContext *pContext)
+   {
+   if (pContext->iOwnsScratch && pContext->pScratch != NULL)
+      {
+      pContext->freeFunction(pContext->pAllocatorData, pContext->pScratch);
+      }
+
+   if (pContext->iOwnsScratch)
+      {
+      pContext->pScratch = NULL;
+      pContext->uScratchBytes = 0;
+      }
+   }
@@ -0,0 +1,1404 @@
+/*
+   PathCompacterFuzz.c
+   10/15/2026
+   Authors: Michael Casebolt, Brett Casebolt
+*/
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Michael Casebolt and Brett Casebolt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// This file uses lines up to 100 characters long. If this 100 character line fits then you're good.
+
+// This is the pathcompact-fuzz differential tester. Every Ramer-Douglas-Peucker engine promises to
+// keep exactly the points that compactPath keeps, so it runs all of them on the same path and
+// stops with a report as soon as one of them keeps anything else, or fails. The other algorithms
+// have nothing to be compared with, so they are only checked for keeping the end points and
+// keeping the points in order.
+//
+// The path, epsilon, metric and the rest are all decoded from a string of bytes, which makes
+// LLVMFuzzerTestOneInput a libFuzzer target as it is (see make libfuzzer). The decoding is meant
+// to reach the inputs that are hard on the engines: collinear runs, repeated points, closed
+// loops, huge and tiny coordinates, coordinates far from the origin, epsilons of zero and of
+// DBL_MAX, and paths of one and two points.
+//
+// Built without libFuzzer, it is a program of its own:
+//
+//    pathcompact-fuzz [-n runs] [-s seed] [file ...]
+//
+// Given files, it runs each of them as an input, so that anything libFuzzer finds can be replayed.
+// Otherwise it runs a fixed set of inputs made of every option byte with short and repetitive
+// points, and then random inputs until there have been runs of them (8000 by default).
+// make check builds it with the address and undefined behaviour sanitizers and runs it.
+
+#include "PathCompacter.h"
+#include "PathCompacterInternal.h"
+
+#include <stdio.h> // For printf, fprintf and reading files
+#include <stdlib.h> // For memory management, abort and strtoul
+#include <string.h> // For memcpy and memcmp
+#include <math.h> // For ldexp, fabs, isfinite and NAN
+#include <float.h> // For DBL_MAX
+#include <unistd.h> // For getopt
+
+// Longer paths would only slow the fuzzer down without reaching anything new.
+#define FUZZ_MAX_POINTS 2048
+
+#define FUZZ_DEFAULT_RUNS 8000
+
+// How the points are read from the input bytes.
+typedef enum FuzzEncoding
+   {
+   FUZZ_ENCODING_GRID, // One byte per point, on a 16 by 16 grid, so there are repeats.
+   FUZZ_ENCODING_WALK, // Two bytes per point, each a signed step from the last point.
+   FUZZ_ENCODING_LINE, // One byte per point, mostly exactly on one line.
+   FUZZ_ENCODING_RAW, // Sixteen bytes per point, taken as two doubles.
+   FUZZ_ENCODING_FLOAT, // Eight bytes per point, taken as two floats.
+   FUZZ_ENCODING_SCALED, // A walk, scaled by a power of two anywhere in the range of doubles.
+   FUZZ_ENCODING_OFFSET, // A walk, moved so far from the origin that the steps get rounded.
+   FUZZ_ENCODING_LOOP // A walk that ends where it started.
+   } FuzzEncoding;
+
+typedef struct FuzzReader
+   {
+   const uint8_t *pData;
+   size_t uSize;
+   size_t uOffset;
+   } FuzzReader;
+
+typedef struct FuzzCase
+   {
+   DVector2D *pPoints;
+   unsigned int uPoints;
+   double dEpsilon;
+   DeviationMetric deviationMetric;
+   const char *pMetricName;
+   unsigned int uThreads;
+
+   // The incremental compacter gets the path in pieces of this many points.
+   unsigned int uPieceSize;
+
+   // Whether every coordinate is an integer that fits in an int32_t.
+   int iIntegerCoordinates;
+
+   // What compactPath keeps.
+   DVector2D *pReference;
+   unsigned int uReferencePoints;
+   } FuzzCase;
+
+// Collects what the streaming and chunked compacters emit.
+typedef struct FuzzSink
+   {
+   DVector2D *pPoints;
+   unsigned int uPoints;
+   unsigned int uCapacity;
+   } FuzzSink;
+
+// Hands the path to the chunked compacter.
+typedef struct FuzzSource
+   {
+   const DVector2D *pPoints;
+   unsigned int uPoints;
+   unsigned int uNextPoint;
+   } FuzzSource;
+
+static unsigned int fuzzReadByte(FuzzReader *pReader)
+   {
+   if (pReader->uOffset >= pReader->uSize)
+      {
+      return 0;
+      }
+   ++pReader->uOffset;
+   return pReader->pData[pReader->uOffset - 1];
+   }
+
+static int fuzzBytesLeft(const FuzzReader *pReader, size_t uBytes)
+   {
+   return pReader->uSize - pReader->uOffset >= uBytes;
+   }
+
+static double fuzzFinite(double dValue, double dReplacement)
+   {
+   return isfinite(dValue) ? dValue : dReplacement;
+   }
+
+// The standalone program points these at each input before running it, so that an input that
+// fails can be written out and replayed. libFuzzer keeps its own copy.
+static const uint8_t *pCurrentData;
+static size_t uCurrentSize;
+
+#define FUZZ_FAILURE_FILE "pathcompact-fuzz-failure"
+
+// Stops everything with a report of the case that went wrong.
+static void fuzzFail(const FuzzCase *pCase, const char *pEngine, const char *pProblem)
+   {
+   FILE *pFile;
+   unsigned int u;
+
+   fprintf(stderr, "%s: %s\n", pEngine, pProblem);
+   fprintf(stderr, "metric %s, epsilon %.17g, %u points:\n", pCase->pMetricName, pCase->dEpsilon,
+           pCase->uPoints);
+   for (u = 0; u < pCase->uPoints && u < 64; ++u)
+      {
+      fprintf(stderr, "   %.17g %.17g\n", pCase->pPoints[u].dX, pCase->pPoints[u].dY);
+      }
+   if (pCase->uPoints > 64)
+      {
+      fprintf(stderr, "   ...\n");
+      }
+
+   if (pCurrentData != NULL)
+      {
+      pFile = fopen(FUZZ_FAILURE_FILE, "wb");
+      if (pFile != NULL)
+         {
+         fwrite(pCurrentData, 1, uCurrentSize, pFile);
+         fclose(pFile);
+         fprintf(stderr, "The input was written to " FUZZ_FAILURE_FILE ".\n");
+         }
+      }
+   abort();
+   }
+
+// Checks a result against what compactPath keeps.
+static void fuzzExpectReference(const FuzzCase *pCase, const char *pEngine, int iSuccess,
+                                const DVector2D *pResult, unsigned int uResultPoints)
+   {
+   if (!iSuccess)
+      {
+      fuzzFail(pCase, pEngine, "failed");
+      }
+   if (uResultPoints != pCase->uReferencePoints ||
+       (uResultPoints > 0 &&
+        memcmp(pResult, pCase->pReference, sizeof(DVector2D) * uResultPoints) != 0))
+      {
+      fuzzFail(pCase, pEngine, "kept different points than compactPath");
+      }
+   }
+
+// Checks kept indices against what compactPath keeps.
+static void fuzzExpectReferenceIndices(const FuzzCase *pCase, const char *pEngine, int iSuccess,
+                                       const uint32_t *puKeptIndices, unsigned int uKept,
+                                       DVector2D *pScratch)
+   {
+   unsigned int u;
+
+   if (!iSuccess)
+      {
+      fuzzFail(pCase, pEngine, "failed");
+      }
+   for (u = 0; u < uKept; ++u)
+      {
+      if (puKeptIndices[u] >= pCase->uPoints || (u > 0 && puKeptIndices[u] <= puKeptIndices[u - 1]))
+         {
+         fuzzFail(pCase, pEngine, "wrote indices that aren't increasing or are out of range");
+         }
+      pScratch[u] = pCase->pPoints[puKeptIndices[u]];
+      }
+   fuzzExpectReference(pCase, pEngine, iSuccess, pScratch, uKept);
+   }
+
+// Checks that a result is made of points of the path, in order, starting and ending with its end
+// points.
+static void fuzzExpectSubsequence(const FuzzCase *pCase, const char *pEngine, int iSuccess,
+                                  const DVector2D *pResult, unsigned int uResultPoints)
+   {
+   unsigned int u, uMatched;
+
+   if (!iSuccess)
+      {
+      fuzzFail(pCase, pEngine, "failed");
+      }
+   if (uResultPoints > pCase->uPoints || (pCase->uPoints > 0 && uResultPoints == 0) ||
+       (pCase->uPoints >= 2 && uResultPoints < 2))
+      {
+      fuzzFail(pCase, pEngine, "kept a wrong number of points");
+      }
+   if (uResultPoints == 0)
+      {
+      return;
+      }
+   if (memcmp(pResult, pCase->pPoints, sizeof(DVector2D)) != 0 ||
+       memcmp(pResult + uResultPoints - 1, pCase->pPoints + pCase->uPoints - 1,
+              sizeof(DVector2D)) != 0)
+      {
+      fuzzFail(pCase, pEngine, "didn't keep the end points");
+      }
+
+   uMatched = 0;
+   for (u = 0; u < pCase->uPoints && uMatched < uResultPoints; ++u)
+      {
+      if (memcmp(pResult + uMatched, pCase->pPoints + u, sizeof(DVector2D)) == 0)
+         {
+         ++uMatched;
+         }
+      }
+   if (uMatched < uResultPoints)
+      {
+      fuzzFail(pCase, pEngine, "kept points that aren't in the path, or not in order");
+      }
+   }
+
+// Runs the top K selections with budgets of 0 to 3 points, each into a buffer of exactly that many
+// entries, so that the sanitizers catch a write past it. A budget has to hold the endpoints.
+static void fuzzCheckTopKBudgets(const FuzzCase *pCase, const PathCompacterIndex *pIndex,
+                                 DVector2D *pScratch)
+   {
+   static const char *apszEngines[2] =
+      {
+      "compactPathIndexExtractTopK with a small budget",
+      "compactPathSelectTopK with a small budget"
+      };
+   uint32_t *puKeptIndices;
+   unsigned int u, uBudget, uKept;
+   int iEngine, iSuccess;
+
+   for (iEngine = 0; iEngine < 2; ++iEngine)
+      {
+      for (uBudget = 0; uBudget <= 3; ++uBudget)
+         {
+         // malloc(0) might return NULL, so an empty buffer gets a byte, which is still too small
+         // for an index.
+         puKeptIndices = (uint32_t *)malloc(sizeof(uint32_t) * uBudget + (uBudget == 0));
+         if (puKeptIndices == NULL)
+            {
+            fuzzFail(pCase, apszEngines[iEngine], "couldn't get memory for the test");
+            }
+
+         uKept = 0;
+         if (iEngine == 0)
+            {
+            iSuccess = compactPathIndexExtractTopK(pIndex, uBudget, puKeptIndices, &uKept);
+            }
+         else
+            {
+            iSuccess = compactPathSelectTopK(puKeptIndices, 0, pCase->uPoints, uBudget,
+                                             puKeptIndices, &uKept);
+            }
+
+         if (iSuccess != !(uBudget < pCase->uPoints && uBudget < 2))
+            {
+            fuzzFail(pCase, apszEngines[iEngine], iSuccess ? "accepted a budget without room "
+                     "for the endpoints" : "turned down a budget with room for the endpoints");
+            }
+         if (iSuccess)
+            {
+            if (uKept > uBudget)
+               {
+               fuzzFail(pCase, apszEngines[iEngine], "kept more points than it was allowed");
+               }
+            for (u = 0; u < uKept; ++u)
+               {
+               if (puKeptIndices[u] >= pCase->uPoints ||
+                   (u > 0 && puKeptIndices[u] <= puKeptIndices[u - 1]))
+                  {
+                  fuzzFail(pCase, apszEngines[iEngine],
+                           "wrote indices that aren't increasing or are out of range");
+                  }
+               pScratch[u] = pCase->pPoints[puKeptIndices[u]];
+               }
+            fuzzExpectSubsequence(pCase, apszEngines[iEngine], iSuccess, pScratch, uKept);
+            }
+
+         free(puKeptIndices);
+         }
+      }
+   }
+
+// A PathCompacterMetric that measures with the case's DeviationMetric, the same way the scans do.
+static void fuzzMetricPrepare(void *pUserData, const DVector2D *pStart, const DVector2D *pEnd,
+                              double *pdState)
+   {
+   double dDX, dDY;
+
+   (void)pUserData;
+
+   dDX = pEnd->dX - pStart->dX;
+   dDY = pEnd->dY - pStart->dY;
+   pdState[0] = pStart->dX;
+   pdState[1] = pStart->dY;
+   pdState[2] = pEnd->dX;
+   pdState[3] = pEnd->dY;
+   pdState[4] = dDX * dDX + dDY * dDY;
+   }
+
+static void fuzzMetricEvaluate(void *pUserData, const double *pdState, const DVector2D *pPoints,
+                               unsigned int uPoints, unsigned int *puMaxIndex,
+                               double *pdMaxSquareDeviation)
+   {
+   const FuzzCase *pCase;
+   DVector2D start, end;
+   double dSquareDeviation;
+   unsigned int u;
+
+   pCase = (const FuzzCase *)pUserData;
+   start.dX = pdState[0];
+   start.dY = pdState[1];
+   end.dX = pdState[2];
+   end.dY = pdState[3];
+
+   *puMaxIndex = 0;
+   *pdMaxSquareDeviation = 0.0;
+   for (u = 0; u < uPoints; ++u)
+      {
+      dSquareDeviation = pCase->deviationMetric(start, end, pPoints[u], pdState[4]);
+      if (dSquareDeviation > *pdMaxSquareDeviation)
+         {
+         *puMaxIndex = u;
+         *pdMaxSquareDeviation = dSquareDeviation;
+         }
+      }
+   }
+
+static void fuzzEmit(void *pUserData, DVector2D point)
+   {
+   FuzzSink *pSink;
+
+   pSink = (FuzzSink *)pUserData;
+   if (pSink->uPoints < pSink->uCapacity)
+      {
+      pSink->pPoints[pSink->uPoints] = point;
+      }
+   ++pSink->uPoints;
+   }
+
+static int fuzzRead(void *pUserData, DVector2D *pPointArray, unsigned int uMaxPoints,
+                    unsigned int *puPointsRead)
+   {
+   FuzzSource *pSource;
+   unsigned int uPoints;
+
+   pSource = (FuzzSource *)pUserData;
+   uPoints = pSource->uPoints - pSource->uNextPoint;
+   if (uPoints > uMaxPoints)
+      {
+      uPoints = uMaxPoints;
+      }
+   if (uPoints > 0)
+      {
+      memcpy(pPointArray, pSource->pPoints + pSource->uNextPoint, sizeof(DVector2D) * uPoints);
+      }
+   pSource->uNextPoint += uPoints;
+   *puPointsRead = uPoints;
+   return 1;
+   }
+
+// Decodes the case from the input. Returns 0 if memory runs out.
+static int fuzzDecode(FuzzCase *pCase, const uint8_t *pData, size_t uSize)
+   {
+   FuzzReader reader;
+   FuzzEncoding encoding;
+   unsigned int uOptions, uThreadOptions, uParameter, uEpsilonMode, uByte;
+   double dX, dY, dScale, dSlope, dIntercept, adRaw[2];
+   float afRaw[2];
+   int iScaleExponent;
+
+   reader.pData = pData;
+   reader.uSize = uSize;
+   reader.uOffset = 0;
+
+   uOptions = fuzzReadByte(&reader);
+   uThreadOptions = fuzzReadByte(&reader);
+   uParameter = fuzzReadByte(&reader);
+
+   switch (uOptions & 3)
+      {
+      case 0:
+         pCase->deviationMetric = perpendicularDistanceDeviationMetric;
+         pCase->pMetricName = "perpendicular";
+         break;
+      case 1:
+         pCase->deviationMetric = shortestDistanceToSegmentDeviationMetric;
+         pCase->pMetricName = "segment";
+         break;
+      case 2:
+         pCase->deviationMetric = crossTrackDistanceDeviationMetric;
+         pCase->pMetricName = "crosstrack";
+         break;
+      default:
+         pCase->deviationMetric = ellipsoidalCrossTrackDistanceDeviationMetric;
+         pCase->pMetricName = "ellipsoidal";
+         break;
+      }
+   encoding = (FuzzEncoding)((uOptions >> 2) & 7);
+   uEpsilonMode = uOptions >> 5;
+
+   pCase->uThreads = 1 + (uThreadOptions & 7);
+   pCase->uPieceSize = 1 + (uThreadOptions >> 3) * (uThreadOptions >> 3);
+
+   switch (uEpsilonMode)
+      {
+      case 0:
+         pCase->dEpsilon = 0.0;
+         break;
+      case 1:
+         pCase->dEpsilon = 4.9406564584124654e-324; // The smallest subnormal double.
+         break;
+      case 2:
+         pCase->dEpsilon = 0.5;
+         break;
+      case 3:
+         pCase->dEpsilon = 1.0;
+         break;
+      case 4:
+         pCase->dEpsilon = 3.0;
+         break;
+      case 5:
+         adRaw[0] = 1.0;
+         if (fuzzBytesLeft(&reader, sizeof(double)))
+            {
+            memcpy(adRaw, reader.pData + reader.uOffset, sizeof(double));
+            reader.uOffset += sizeof(double);
+            }
+         pCase->dEpsilon = fabs(fuzzFinite(adRaw[0], 1.0));
+         break;
+      case 6:
+         // Its square is still finite, but not by much.
+         pCase->dEpsilon = 1e150;
+         break;
+      default:
+         // Its square is infinite.
+         pCase->dEpsilon = DBL_MAX;
+         break;
+      }
+
+   // The walks are scaled by anything from 2^-1016 to 2^1016, or moved 2^40 to 2^71 away.
+   iScaleExponent = ((int)uParameter - 128) * 8;
+   dScale = ldexp(1.0, iScaleExponent);
+   dSlope = (double)((int)(uParameter & 15) - 8);
+   dIntercept = (double)((int)(uParameter >> 4) - 8);
+
+   pCase->pPoints = (DVector2D *)malloc(sizeof(DVector2D) * FUZZ_MAX_POINTS);
+   if (pCase->pPoints == NULL)
+      {
+      return 0;
+      }
+
+   pCase->uPoints = 0;
+   pCase->iIntegerCoordinates = encoding == FUZZ_ENCODING_GRID ||
+                                encoding == FUZZ_ENCODING_WALK ||
+                                encoding == FUZZ_ENCODING_LINE || encoding == FUZZ_ENCODING_LOOP;
+   dX = 0.0;
+   dY = 0.0;
+
+   while (pCase->uPoints < FUZZ_MAX_POINTS && reader.uOffset < reader.uSize)
+      {
+      switch (encoding)
+         {
+         case FUZZ_ENCODING_GRID:
+            uByte = fuzzReadByte(&reader);
+            dX = (double)((int)(uByte & 15) - 8);
+            dY = (double)((int)(uByte >> 4) - 8);
+            break;
+         case FUZZ_ENCODING_LINE:
+            // Every point with both top bits set is one above the line.
+            uByte = fuzzReadByte(&reader);
+            dX = (double)((int)(uByte & 63) - 32);
+            dY = dSlope * dX + dIntercept + ((uByte >> 6) == 3 ? 1.0 : 0.0);
+            break;
+         case FUZZ_ENCODING_RAW:
+            if (!fuzzBytesLeft(&reader, sizeof(adRaw)))
+               {
+               reader.uOffset = reader.uSize;
+               continue;
+               }
+            memcpy(adRaw, reader.pData + reader.uOffset, sizeof(adRaw));
+            reader.uOffset += sizeof(adRaw);
+            dX = fuzzFinite(adRaw[0], (double)pCase->uPoints);
+            dY = fuzzFinite(adRaw[1], 0.0);
+            break;
+         case FUZZ_ENCODING_FLOAT:
+            if (!fuzzBytesLeft(&reader, sizeof(afRaw)))
+               {
+               reader.uOffset = reader.uSize;
+               continue;
+               }
+            memcpy(afRaw, reader.pData + reader.uOffset, sizeof(afRaw));
+            reader.uOffset += sizeof(afRaw);
+            dX = fuzzFinite((double)afRaw[0], (double)pCase->uPoints);
+            dY = fuzzFinite((double)afRaw[1], 0.0);
+            break;
+         default:
+            dX += (double)((int)fuzzReadByte(&reader) - 128);
+            dY += (double)((int)fuzzReadByte(&reader) - 128);
+            break;
+         }
+
+      pCase->pPoints[pCase->uPoints].dX = dX;
+      pCase->pPoints[pCase->uPoints].dY = dY;
+      if (encoding == FUZZ_ENCODING_SCALED)
+         {
+         // A long walk at the largest scales would overflow, so it stays where it was instead.
+         pCase->pPoints[pCase->uPoints].dX = fuzzFinite(dX * dScale, dX);
+         pCase->pPoints[pCase->uPoints].dY = fuzzFinite(dY * dScale, dY);
+         }
+      else if (encoding == FUZZ_ENCODING_OFFSET)
+         {
+         pCase->pPoints[pCase->uPoints].dX = ldexp(1.0, 40 + (uParameter & 31)) + dX;
+         pCase->pPoints[pCase->uPoints].dY = ldexp(-1.0, 40 + (uParameter >> 3)) + dY;
+         }
+      ++pCase->uPoints;
+      }
+
+   if (encoding == FUZZ_ENCODING_LOOP && pCase->uPoints >= 2)
+      {
+      pCase->pPoints[pCase->uPoints - 1] = pCase->pPoints[0];
+      }
+
+   return 1;
+   }
+
+// Runs the engines that have to match compactPath. pResult and puKeptIndices hold a point per
+// point of the path, and pScratch twice that.
+static void fuzzCheckExact(FuzzCase *pCase, DVector2D *pResult, DVector2D *pScratch,
+                           uint32_t *puKeptIndices, unsigned char *pBitmap)
+   {
+   static const PathCompacterEngine aEngines[] =
+      {
+      PATH_COMPACTER_ENGINE_ITERATIVE,
+      PATH_COMPACTER_ENGINE_RECURSIVE,
+      PATH_COMPACTER_ENGINE_HULL,
+      PATH_COMPACTER_ENGINE_BOUNDED
+      };
+   static const char *apEngineNames[] =
+      {
+      "compactPathWithEngine iterative",
+      "compactPathWithEngine recursive",
+      "compactPathWithEngine hull",
+      "compactPathWithEngine bounded"
+      };
+   static unsigned char aArena[1 << 16];
+   PathCompacterContext context;
+   PathCompacterStats stats;
+   PathCompacterMetric metric;
+   PathCompacterStream *pStream;
+   PathCompacterIncremental *pIncremental;
+   PathCompacterIndex *pIndex, *pReadIndex;
+   FuzzSink sink;
+   FuzzSource source;
+   DVector2D replacement;
+   unsigned long long uEmitted;
+   unsigned int u, uPoints, uKept, uRanked, uPathOffsets[3], uResultOffsets[3], uPiece, uSpot;
+   double *pdX, *pdY, *pdSignificance;
+   int32_t *piX, *piY;
+   void *pBuffer;
+   size_t uBytes;
+   int iSuccess;
+
+   uPoints = pCase->uPoints;
+
+   // compactPath in place, which is how most callers use it.
+   memcpy(pResult, pCase->pPoints, sizeof(DVector2D) * uPoints);
+   iSuccess = compactPath(pResult, uPoints, pResult, &uKept, pCase->dEpsilon,
+                          pCase->deviationMetric);
+   fuzzExpectReference(pCase, "compactPath in place", iSuccess, pResult, uKept);
+
+   // compactPathValidated turns down coordinates so large that the metrics could overflow.
+   iSuccess = compactPathValidated(pCase->pPoints, uPoints, pResult, &uKept, pCase->dEpsilon,
+                                   pCase->deviationMetric);
+   for (u = 0; u < uPoints; ++u)
+      {
+      if (fabs(pCase->pPoints[u].dX) > 1e76 || fabs(pCase->pPoints[u].dY) > 1e76)
+         {
+         break;
+         }
+      }
+   if (u < uPoints)
+      {
+      if (iSuccess)
+         {
+         fuzzFail(pCase, "compactPathValidated", "accepted coordinates that could overflow");
+         }
+      }
+   else
+      {
+      fuzzExpectReference(pCase, "compactPathValidated", iSuccess, pResult, uKept);
+      }
+
+   iSuccess = compactPathRecursive(pCase->pPoints, uPoints, pResult, &uKept, pCase->dEpsilon,
+                                   pCase->deviationMetric);
+   fuzzExpectReference(pCase, "compactPathRecursive", iSuccess, pResult, uKept);
+
+   iSuccess = compactPathHull(pCase->pPoints, uPoints, pResult, &uKept, pCase->dEpsilon,
+                              pCase->deviationMetric);
+   fuzzExpectReference(pCase, "compactPathHull", iSuccess, pResult, uKept);
+
+   iSuccess = compactPathBounded(pCase->pPoints, uPoints, pResult, &uKept, pCase->dEpsilon,
+                                 pCase->deviationMetric);
+   fuzzExpectReference(pCase, "compactPathBounded", iSuccess, pResult, uKept);
+
+   for (u = 0; u < sizeof(aEngines) / sizeof(aEngines[0]); ++u)
+      {
+      iSuccess = compactPathWithEngine(aEngines[u], pCase->pPoints, uPoints, pResult, &uKept,
+                                       pCase->dEpsilon, pCase->deviationMetric);
+      fuzzExpectReference(pCase, apEngineNames[u], iSuccess, pResult, uKept);
+      }
+
+   iSuccess = compactPathWithStats(pCase->pPoints, uPoints, pResult, &uKept, pCase->dEpsilon,
+                                   pCase->deviationMetric, &stats);
+   fuzzExpectReference(pCase, "compactPathWithStats", iSuccess, pResult, uKept);
+
+   metric.prepare = fuzzMetricPrepare;
+   metric.evaluate = fuzzMetricEvaluate;
+   metric.pUserData = pCase;
+   iSuccess = compactPathWithMetric(pCase->pPoints, uPoints, pResult, &uKept, pCase->dEpsilon,
+                                    &metric);
+   fuzzExpectReference(pCase, "compactPathWithMetric", iSuccess, pResult, uKept);
+
+   compactPathContextInit(&context, NULL, NULL, NULL);
+   iSuccess = compactPathWithContext(&context, pCase->pPoints, uPoints, pResult, &uKept,
+                                     pCase->dEpsilon, pCase->deviationMetric);
+   fuzzExpectReference(pCase, "compactPathWithContext", iSuccess, pResult, uKept);
+   compactPathContextSetMetric(&context, &metric);
+   iSuccess = compactPathWithContext(&context, pCase->pPoints, uPoints, pResult, &uKept,
+                                     pCase->dEpsilon, NULL);
+   fuzzExpectReference(pCase, "compactPathWithContext with a metric", iSuccess, pResult, uKept);
+   compactPathContextRelease(&context);
+
+   compactPathContextInitWithArena(&context, aArena, sizeof(aArena));
+   iSuccess = compactPathWithContext(&context, pCase->pPoints, uPoints, pResult, &uKept,
+                                     pCase->dEpsilon, pCase->deviationMetric);
+   fuzzExpectReference(pCase, "compactPathWithContext with an arena", iSuccess, pResult, uKept);
+   compactPathContextRelease(&context);
+
+   iSuccess = compactPathParallel(pCase->pPoints, uPoints, pResult, &uKept, pCase->dEpsilon,
+                                  pCase->deviationMetric, pCase->uThreads);
+   fuzzExpectReference(pCase, "compactPathParallel", iSuccess, pResult, uKept);
+
+   // The fuzzed paths are far shorter than twice the cutoff of compactPathParallel, which then
+   // just calls compactPath. Lower cutoffs get the pool to divide and steal on them.
+   iSuccess = compactPathParallelWithCutoff(pCase->pPoints, uPoints, pResult, &uKept,
+                                            pCase->dEpsilon, pCase->deviationMetric,
+                                            pCase->uThreads + 1, 3);
+   fuzzExpectReference(pCase, "compactPathParallel with a cutoff of 3", iSuccess, pResult, uKept);
+
+   iSuccess = compactPathParallelWithCutoff(pCase->pPoints, uPoints, pResult, &uKept,
+                                            pCase->dEpsilon, pCase->deviationMetric,
+                                            pCase->uThreads + 1, 32);
+   fuzzExpectReference(pCase, "compactPathParallel with a cutoff of 32", iSuccess, pResult,
+                       uKept);
+
+   // Two copies of the path make up the batch, and each has to come out like the reference.
+   memcpy(pScratch, pCase->pPoints, sizeof(DVector2D) * uPoints);
+   memcpy(pScratch + uPoints, pCase->pPoints, sizeof(DVector2D) * uPoints);
+   uPathOffsets[0] = 0;
+   uPathOffsets[1] = uPoints;
+   uPathOffsets[2] = 2 * uPoints;
+   iSuccess = compactPathBatch(pScratch, uPathOffsets, 2, NULL, pCase->dEpsilon,
+                               pCase->deviationMetric, pScratch, uResultOffsets, pCase->uThreads);
+   fuzzExpectReference(pCase, "compactPathBatch, first path", iSuccess, pScratch,
+                       iSuccess ? uResultOffsets[1] - uResultOffsets[0] : 0);
+   fuzzExpectReference(pCase, "compactPathBatch, second path", iSuccess,
+                       pScratch + uResultOffsets[1], uResultOffsets[2] - uResultOffsets[1]);
+
+   iSuccess = compactPathKeptIndices(pCase->pPoints, uPoints, puKeptIndices, &uKept,
+                                     pCase->dEpsilon, pCase->deviationMetric);
+   fuzzExpectReferenceIndices(pCase, "compactPathKeptIndices", iSuccess, puKeptIndices, uKept,
+                              pScratch);
+
+   iSuccess = compactPathKeepBitmap(pCase->pPoints, uPoints, pBitmap, &uKept, pCase->dEpsilon,
+                                    pCase->deviationMetric);
+   uRanked = 0;
+   for (u = 0; u < uPoints; ++u)
+      {
+      if ((pBitmap[u / 8] >> (u % 8)) & 1)
+         {
+         pScratch[uRanked] = pCase->pPoints[u];
+         ++uRanked;
+         }
+      }
+   if (iSuccess && uRanked != uKept)
+      {
+      fuzzFail(pCase, "compactPathKeepBitmap", "passed back a count that doesn't match the bits");
+      }
+   fuzzExpectReference(pCase, "compactPathKeepBitmap", iSuccess, pScratch, uRanked);
+
+   pdX = (double *)malloc(sizeof(double) * (uPoints + 1));
+   pdY = (double *)malloc(sizeof(double) * (uPoints + 1));
+   piX = (int32_t *)malloc(sizeof(int32_t) * (uPoints + 1));
+   piY = (int32_t *)malloc(sizeof(int32_t) * (uPoints + 1));
+   pdSignificance = (double *)malloc(sizeof(double) * (uPoints + 1));
+   if (pdX == NULL || pdY == NULL || piX == NULL || piY == NULL || pdSignificance == NULL)
+      {
+      fuzzFail(pCase, "fuzzCheckExact", "ran out of memory");
+      }
+
+   for (u = 0; u < uPoints; ++u)
+      {
+      pdX[u] = pCase->pPoints[u].dX;
+      pdY[u] = pCase->pPoints[u].dY;
+      }
+   iSuccess = compactPathKeptIndicesSoa(pdX, pdY, uPoints, puKeptIndices, &uKept,
+                                        pCase->dEpsilon, pCase->deviationMetric);
+   fuzzExpectReferenceIndices(pCase, "compactPathKeptIndicesSoa", iSuccess, puKeptIndices, uKept,
+                              pScratch);
+
+   // A scale of one changes nothing, so integer coordinates have to come out the same.
+   if (pCase->iIntegerCoordinates)
+      {
+      for (u = 0; u < uPoints; ++u)
+         {
+         piX[u] = (int32_t)pCase->pPoints[u].dX;
+         piY[u] = (int32_t)pCase->pPoints[u].dY;
+         }
+      iSuccess = compactPathKeptIndicesSoaInt32(piX, piY, 1.0, uPoints, puKeptIndices, &uKept,
+                                                pCase->dEpsilon, pCase->deviationMetric);
+      fuzzExpectReferenceIndices(pCase, "compactPathKeptIndicesSoaInt32", iSuccess,
+                                 puKeptIndices, uKept, pScratch);
+      }
+
+   iSuccess = compactPathRankVertices(pCase->pPoints, uPoints, pdSignificance, puKeptIndices,
+                                      &uRanked, pCase->deviationMetric);
+   if (!iSuccess)
+      {
+      fuzzFail(pCase, "compactPathRankVertices", "failed");
+      }
+   iSuccess = compactPathSelectByEpsilon(pdSignificance, uPoints, pCase->dEpsilon, puKeptIndices,
+                                         &uKept);
+   fuzzExpectReferenceIndices(pCase, "compactPathSelectByEpsilon", iSuccess, puKeptIndices, uKept,
+                              pScratch);
+
+   pIndex = compactPathIndexBuild(pCase->pPoints, uPoints, pCase->deviationMetric);
+   if (pIndex == NULL)
+      {
+      fuzzFail(pCase, "compactPathIndexBuild", "failed");
+      }
+   if (compactPathIndexPointsForEpsilon(pIndex, pCase->dEpsilon) != pCase->uReferencePoints)
+      {
+      fuzzFail(pCase, "compactPathIndexPointsForEpsilon", "counted the wrong number of points");
+      }
+   iSuccess = compactPathIndexExtract(pIndex, pCase->dEpsilon, puKeptIndices, &uKept);
+   fuzzExpectReferenceIndices(pCase, "compactPathIndexExtract", iSuccess, puKeptIndices, uKept,
+                              pScratch);
+   fuzzCheckTopKBudgets(pCase, pIndex, pScratch);
+
+   uBytes = compactPathIndexSerializedSize(pIndex);
+   pBuffer = malloc(uBytes);
+   if (pBuffer == NULL || compactPathIndexSerialize(pIndex, pBuffer, uBytes) != uBytes)
+      {
+      fuzzFail(pCase, "compactPathIndexSerialize", "failed");
+      }
+   pReadIndex = compactPathIndexDeserialize(pBuffer, uBytes);
+   if (pReadIndex == NULL)
+      {
+      fuzzFail(pCase, "compactPathIndexDeserialize", "turned down its own output");
+      }
+   iSuccess = compactPathIndexExtract(pReadIndex, pCase->dEpsilon, puKeptIndices, &uKept);
+   fuzzExpectReferenceIndices(pCase, "compactPathIndexExtract after a round trip", iSuccess,
+                              puKeptIndices, uKept, pScratch);
+
+   // A truncated index has to be turned down, not read past its end.
+   if (uBytes > 0 && compactPathIndexDeserialize(pBuffer, uBytes - 1) != NULL)
+      {
+      fuzzFail(pCase, "compactPathIndexDeserialize", "read a truncated index");
+      }
+   compactPathIndexDestroy(pReadIndex);
+   compactPathIndexDestroy(pIndex);
+   free(pBuffer);
+
+   // A path that fits in the window comes out of the streaming compacter unchanged.
+   sink.pPoints = pScratch;
+   sink.uPoints = 0;
+   sink.uCapacity = 2 * uPoints;
+   pStream = compactPathStreamCreate(uPoints > 4 ? uPoints : 4, pCase->dEpsilon,
+                                     pCase->deviationMetric, fuzzEmit, &sink);
+   if (pStream == NULL)
+      {
+      fuzzFail(pCase, "compactPathStreamCreate", "failed");
+      }
+   iSuccess = 1;
+   for (u = 0; u < uPoints; ++u)
+      {
+      iSuccess = iSuccess && compactPathStreamPush(pStream, pCase->pPoints[u]);
+      }
+   iSuccess = iSuccess && compactPathStreamFlush(pStream);
+   compactPathStreamDestroy(pStream);
+   fuzzExpectReference(pCase, "compactPathStream", iSuccess && sink.uPoints <= sink.uCapacity,
+                       pScratch, sink.uPoints);
+
+   // So does a path that fits in one chunk and the first point of the next.
+   sink.uPoints = 0;
+   source.pPoints = pCase->pPoints;
+   source.uPoints = uPoints;
+   source.uNextPoint = 0;
+   iSuccess = compactPathChunked(fuzzRead, &source, uPoints > 3 ? uPoints - 1 : 2,
+                                 pCase->uThreads, pCase->dEpsilon, pCase->deviationMetric,
+                                 fuzzEmit, &sink, &uEmitted);
+   fuzzExpectReference(pCase, "compactPathChunked",
+                       iSuccess && uEmitted == sink.uPoints && sink.uPoints <= sink.uCapacity,
+                       pScratch, sink.uPoints);
+
+   // The incremental compacter gets the path a piece at a time, and has to be right after each
+   // piece, so every prefix is checked against compactPath on that prefix.
+   pIncremental = compactPathIncrementalCreate(pCase->dEpsilon, pCase->deviationMetric);
+   if (pIncremental == NULL)
+      {
+      fuzzFail(pCase, "compactPathIncrementalCreate", "failed");
+      }
+   for (u = 0; u < uPoints; u += uPiece)
+      {
+      uPiece = uPoints - u < pCase->uPieceSize ? uPoints - u : pCase->uPieceSize;
+      if (!compactPathIncrementalAppend(pIncremental, pCase->pPoints + u, uPiece))
+         {
+         fuzzFail(pCase, "compactPathIncrementalAppend", "failed");
+         }
+      if (u + uPiece < uPoints)
+         {
+         compactPathKeptIndices(pCase->pPoints, u + uPiece, puKeptIndices, &uKept,
+                                pCase->dEpsilon, pCase->deviationMetric);
+         compactPathIncrementalKeptIndices(pIncremental, 0, puKeptIndices + uPoints, &uRanked);
+         if (uKept != uRanked ||
+             memcmp(puKeptIndices, puKeptIndices + uPoints, sizeof(uint32_t) * uKept) != 0)
+            {
+            fuzzFail(pCase, "compactPathIncrementalAppend",
+                     "kept different points than compactPath on the same prefix");
+            }
+         }
+      }
+   iSuccess = compactPathIncrementalKeptIndices(pIncremental, 0, puKeptIndices, &uKept);
+   fuzzExpectReferenceIndices(pCase, "compactPathIncrementalAppend", iSuccess, puKeptIndices,
+                              uKept, pScratch);
+
+   // Then one point is moved onto another, which makes repeats and collinear runs. The reference
+   // has to be worked out again for that.
+   if (uPoints > 0)
+      {
+      uSpot = pCase->uPieceSize % uPoints;
+      replacement = pCase->pPoints[(uSpot * 7 + 3) % uPoints];
+      memcpy(pScratch, pCase->pPoints, sizeof(DVector2D) * uPoints);
+      pScratch[uSpot] = replacement;
+      compactPathKeptIndices(pScratch, uPoints, puKeptIndices, &uKept, pCase->dEpsilon,
+                             pCase->deviationMetric);
+      if (!compactPathIncrementalReplace(pIncremental, uSpot, &replacement, 1))
+         {
+         fuzzFail(pCase, "compactPathIncrementalReplace", "failed");
+         }
+      compactPathIncrementalKeptIndices(pIncremental, 0, puKeptIndices + uPoints, &uRanked);
+      if (uKept != uRanked ||
+          memcmp(puKeptIndices, puKeptIndices + uPoints, sizeof(uint32_t) * uKept) != 0)
+         {
+         fuzzFail(pCase, "compactPathIncrementalReplace",
+                  "kept different points than compactPath on the edited path");
+         }
+      }
+   compactPathIncrementalDestroy(pIncremental);
+
+   free(pdX);
+   free(pdY);
+   free(piX);
+   free(piY);
+   free(pdSignificance);
+   }
+
+// Runs everything else, which can only be checked for keeping the end points in order.
+static void fuzzCheckOthers(FuzzCase *pCase, DVector2D *pResult, DVector2D *pScratch,
+                            uint32_t *puKeptIndices)
+   {
+   PathCompacterContext context;
+   DVector3D *pPoints3D;
+   double *pdPointsND;
+   double dMinX, dMinY, dMaxX, dMaxY;
+   float *pfX, *pfY;
+   unsigned int u, uPoints, uKept, uKept3D, uRingOffsets[2], uResultOffsets[2];
+   int iSuccess, iPreserveTopology, iExtentOverflows;
+
+   uPoints = pCase->uPoints;
+
+   iSuccess = compactPathVisvalingam(pCase->pPoints, uPoints, pResult, &uKept, pCase->dEpsilon);
+   fuzzExpectSubsequence(pCase, "compactPathVisvalingam", iSuccess, pResult, uKept);
+
+   compactPathContextInit(&context, NULL, NULL, NULL);
+   iSuccess = compactPathVisvalingamWithContext(&context, pCase->pPoints, uPoints, pScratch,
+                                                &uKept3D, pCase->dEpsilon);
+   compactPathContextRelease(&context);
+   if (iSuccess && (uKept3D != uKept ||
+                    memcmp(pResult, pScratch, sizeof(DVector2D) * uKept) != 0))
+      {
+      fuzzFail(pCase, "compactPathVisvalingamWithContext",
+               "kept different points than compactPathVisvalingam");
+      }
+
+   iSuccess = compactPathReumannWitkam(pCase->pPoints, uPoints, pResult, &uKept, pCase->dEpsilon,
+                                       pCase->deviationMetric);
+   fuzzExpectSubsequence(pCase, "compactPathReumannWitkam", iSuccess, pResult, uKept);
+
+   iSuccess = compactPathRadialDistance(pCase->pPoints, uPoints, pResult, &uKept,
+                                        pCase->dEpsilon);
+   fuzzExpectSubsequence(pCase, "compactPathRadialDistance", iSuccess, pResult, uKept);
+
+   iSuccess = compactPathRadialThenRdp(pCase->pPoints, uPoints, pResult, &uKept, pCase->dEpsilon,
+                                       pCase->deviationMetric);
+   fuzzExpectSubsequence(pCase, "compactPathRadialThenRdp", iSuccess, pResult, uKept);
+
+   pfX = (float *)malloc(sizeof(float) * (uPoints + 1));
+   pfY = (float *)malloc(sizeof(float) * (uPoints + 1));
+   pPoints3D = (DVector3D *)malloc(sizeof(DVector3D) * (uPoints + 1));
+   pdPointsND = (double *)malloc(sizeof(double) * 3 * (uPoints + 1));
+   if (pfX == NULL || pfY == NULL || pPoints3D == NULL || pdPointsND == NULL)
+      {
+      fuzzFail(pCase, "fuzzCheckOthers", "ran out of memory");
+      }
+
+   for (u = 0; u < uPoints; ++u)
+      {
+      pfX[u] = (float)pCase->pPoints[u].dX;
+      pfY[u] = (float)pCase->pPoints[u].dY;
+      }
+   iSuccess = compactPathKeptIndicesSoaFloat(pfX, pfY, uPoints, puKeptIndices, &uKept,
+                                             pCase->dEpsilon, pCase->deviationMetric);
+   for (u = 0; iSuccess && u < uKept; ++u)
+      {
+      pResult[u] = pCase->pPoints[puKeptIndices[u]];
+      }
+   fuzzExpectSubsequence(pCase, "compactPathKeptIndicesSoaFloat", iSuccess, pResult, uKept);
+
+   // The path becomes a ring, which the rings code keeps at least three points of.
+   uRingOffsets[0] = 0;
+   uRingOffsets[1] = uPoints;
+   // The topology preserving mode turns down results whose extent overflows, which can only
+   // happen if the extent of the whole path does.
+   dMinX = dMaxX = uPoints > 0 ? pCase->pPoints[0].dX : 0.0;
+   dMinY = dMaxY = uPoints > 0 ? pCase->pPoints[0].dY : 0.0;
+   for (u = 0; u < uPoints; ++u)
+      {
+      dMinX = pCase->pPoints[u].dX < dMinX ? pCase->pPoints[u].dX : dMinX;
+      dMaxX = pCase->pPoints[u].dX > dMaxX ? pCase->pPoints[u].dX : dMaxX;
+      dMinY = pCase->pPoints[u].dY < dMinY ? pCase->pPoints[u].dY : dMinY;
+      dMaxY = pCase->pPoints[u].dY > dMaxY ? pCase->pPoints[u].dY : dMaxY;
+      }
+   iExtentOverflows = !(dMaxX - dMinX <= DBL_MAX && dMaxY - dMinY <= DBL_MAX);
+
+   for (iPreserveTopology = 0; iPreserveTopology <= 1; ++iPreserveTopology)
+      {
+      iSuccess = compactPathRings(pCase->pPoints, uRingOffsets, 1, pResult, uResultOffsets,
+                                  pCase->dEpsilon, pCase->deviationMetric, iPreserveTopology);
+      if (!iSuccess && iPreserveTopology && iExtentOverflows)
+         {
+         continue;
+         }
+      if (!iSuccess)
+         {
+         fuzzFail(pCase, "compactPathRings", "failed");
+         }
+      uKept = uResultOffsets[1] - uResultOffsets[0];
+      if (uKept > uPoints || (uPoints >= 3 && uKept < 3 && uKept != uPoints))
+         {
+         fuzzFail(pCase, "compactPathRings", "kept a wrong number of points");
+         }
+      }
+
+   // The 3D and ND compacters get the path with the point number as the third coordinate, and
+   // their two forms have to agree with each other.
+   for (u = 0; u < uPoints; ++u)
+      {
+      pPoints3D[u].dX = pCase->pPoints[u].dX;
+      pPoints3D[u].dY = pCase->pPoints[u].dY;
+      pPoints3D[u].dZ = (double)u;
+      pdPointsND[3 * u] = pCase->pPoints[u].dX;
+      pdPointsND[3 * u + 1] = pCase->pPoints[u].dY;
+      pdPointsND[3 * u + 2] = (double)u;
+      }
+   iSuccess = compactPathKeptIndices3D(pPoints3D, uPoints, puKeptIndices, &uKept,
+                                       pCase->dEpsilon,
+                                       synchronizedEuclideanDistanceDeviationMetric3D);
+   iSuccess = iSuccess && compactPath3D(pPoints3D, uPoints, pPoints3D, &uKept3D, pCase->dEpsilon,
+                                        synchronizedEuclideanDistanceDeviationMetric3D);
+   if (!iSuccess || uKept != uKept3D)
+      {
+      fuzzFail(pCase, "compactPath3D", "disagreed with compactPathKeptIndices3D");
+      }
+   for (u = 0; u < uKept; ++u)
+      {
+      if (pPoints3D[u].dZ != (double)puKeptIndices[u])
+         {
+         fuzzFail(pCase, "compactPath3D", "disagreed with compactPathKeptIndices3D");
+         }
+      }
+
+   iSuccess = compactPathKeptIndicesND(pdPointsND, 3, uPoints, puKeptIndices, &uKept,
+                                       pCase->dEpsilon, perpendicularDistanceDeviationMetricND);
+   iSuccess = iSuccess && compactPathND(pdPointsND, 3, uPoints, pdPointsND, &uKept3D,
+                                        pCase->dEpsilon, perpendicularDistanceDeviationMetricND);
+   if (!iSuccess || uKept != uKept3D)
+      {
+      fuzzFail(pCase, "compactPathND", "disagreed with compactPathKeptIndicesND");
+      }
+   for (u = 0; u < uKept; ++u)
+      {
+      if (pdPointsND[3 * u + 2] != (double)puKeptIndices[u])
+         {
+         fuzzFail(pCase, "compactPathND", "disagreed with compactPathKeptIndicesND");
+         }
+      }
+
+   // With dZ = 0, the 3D perpendicular distance is the 2D one, so compactPath3D has to keep what
+   // compactPath does. The ND one is worked out another way, which rounds differently, so it only
+   // has to keep a part of the path with its end points. Both need the differences between the
+   // coordinates to be finite.
+   if (pCase->deviationMetric == perpendicularDistanceDeviationMetric && !iExtentOverflows)
+      {
+      for (u = 0; u < uPoints; ++u)
+         {
+         pPoints3D[u].dX = pCase->pPoints[u].dX;
+         pPoints3D[u].dY = pCase->pPoints[u].dY;
+         pPoints3D[u].dZ = 0.0;
+         pdPointsND[3 * u] = pCase->pPoints[u].dX;
+         pdPointsND[3 * u + 1] = pCase->pPoints[u].dY;
+         pdPointsND[3 * u + 2] = 0.0;
+         }
+
+      iSuccess = compactPath3D(pPoints3D, uPoints, pPoints3D, &uKept, pCase->dEpsilon,
+                               perpendicularDistanceDeviationMetric3D);
+      for (u = 0; iSuccess && u < uKept; ++u)
+         {
+         pResult[u].dX = pPoints3D[u].dX;
+         pResult[u].dY = pPoints3D[u].dY;
+         }
+      fuzzExpectReference(pCase, "compactPath3D with dZ = 0", iSuccess, pResult, uKept);
+
+      iSuccess = compactPathND(pdPointsND, 3, uPoints, pdPointsND, &uKept, pCase->dEpsilon,
+                               perpendicularDistanceDeviationMetricND);
+      for (u = 0; iSuccess && u < uKept; ++u)
+         {
+         pResult[u].dX = pdPointsND[3 * u];
+         pResult[u].dY = pdPointsND[3 * u + 1];
+         }
+      fuzzExpectSubsequence(pCase, "compactPathND with dZ = 0", iSuccess, pResult, uKept);
+      }
+
+   free(pfX);
+   free(pfY);
+   free(pPoints3D);
+   free(pdPointsND);
+   }
+
+// Every engine has to turn down an epsilon that is negative or NaN and a missing metric, instead of
+// running with them.
+static void fuzzCheckBadArguments(const FuzzCase *pCase, DVector2D *pScratch,
+                                  uint32_t *puKeptIndices, unsigned char *pBitmap)
+   {
+   static const double adBadEpsilons[2] = { -1.0, NAN };
+   static const struct
+      {
+      const char *pName;
+      int (*engine)(DVector2D *, unsigned int, DVector2D *, unsigned int *, double,
+                    DeviationMetric);
+      } aEngines[] =
+      {
+      { "compactPath", compactPath },
+      { "compactPathRecursive", compactPathRecursive },
+      { "compactPathHull", compactPathHull },
+      { "compactPathBounded", compactPathBounded },
+      { "compactPathReumannWitkam", compactPathReumannWitkam }
+      };
+   double adEpsilons[2];
+   unsigned long long uEmitted;
+   unsigned int uEngine, uKept, uPathOffsets[3], uResultOffsets[3];
+   int i;
+
+   for (i = 0; i < 2; ++i)
+      {
+      if (compactPathKeptIndices(pCase->pPoints, pCase->uPoints, puKeptIndices, &uKept,
+                                 adBadEpsilons[i], pCase->deviationMetric))
+         {
+         fuzzFail(pCase, "compactPathKeptIndices", "accepted a bad epsilon");
+         }
+      if (compactPathKeepBitmap(pCase->pPoints, pCase->uPoints, pBitmap, &uKept,
+                                adBadEpsilons[i], pCase->deviationMetric))
+         {
+         fuzzFail(pCase, "compactPathKeepBitmap", "accepted a bad epsilon");
+         }
+      }
+   if (compactPathKeptIndices(pCase->pPoints, pCase->uPoints, puKeptIndices, &uKept,
+                              pCase->dEpsilon, NULL))
+      {
+      fuzzFail(pCase, "compactPathKeptIndices", "accepted a missing metric");
+      }
+   if (compactPathKeepBitmap(pCase->pPoints, pCase->uPoints, pBitmap, &uKept, pCase->dEpsilon,
+                             NULL))
+      {
+      fuzzFail(pCase, "compactPathKeepBitmap", "accepted a missing metric");
+      }
+
+   for (i = 0; i < 2; ++i)
+      {
+      if (compactPathStreamCreate(4, adBadEpsilons[i], pCase->deviationMetric, fuzzEmit,
+                                  NULL) != NULL)
+         {
+         fuzzFail(pCase, "compactPathStreamCreate", "accepted a bad epsilon");
+         }
+      }
+   if (compactPathStreamCreate(4, pCase->dEpsilon, NULL, fuzzEmit, NULL) != NULL)
+      {
+      fuzzFail(pCase, "compactPathStreamCreate", "accepted a missing metric");
+      }
+
+   // The second path gets the bad epsilon, so the first one would already be compacted in place
+   // if the epsilons weren't checked up front.
+   memcpy(pScratch, pCase->pPoints, sizeof(DVector2D) * pCase->uPoints);
+   memcpy(pScratch + pCase->uPoints, pCase->pPoints, sizeof(DVector2D) * pCase->uPoints);
+   uPathOffsets[0] = 0;
+   uPathOffsets[1] = pCase->uPoints;
+   uPathOffsets[2] = 2 * pCase->uPoints;
+   adEpsilons[0] = pCase->dEpsilon;
+   for (i = 0; i < 2; ++i)
+      {
+      adEpsilons[1] = adBadEpsilons[i];
+      if (compactPathBatch(pScratch, uPathOffsets, 2, adEpsilons, 0.0, pCase->deviationMetric,
+                           pScratch, uResultOffsets, 1) ||
+          compactPathBatch(pScratch, uPathOffsets, 2, NULL, adBadEpsilons[i],
+                           pCase->deviationMetric, pScratch, uResultOffsets, 1))
+         {
+         fuzzFail(pCase, "compactPathBatch", "accepted a bad epsilon");
+         }
+      if (memcmp(pScratch, pCase->pPoints, sizeof(DVector2D) * pCase->uPoints) != 0)
+         {
+         fuzzFail(pCase, "compactPathBatch", "wrote a result before turning down an epsilon");
+         }
+      }
+   if (compactPathBatch(pScratch, uPathOffsets, 2, NULL, pCase->dEpsilon, NULL, pScratch,
+                        uResultOffsets, 1))
+      {
+      fuzzFail(pCase, "compactPathBatch", "accepted a missing metric");
+      }
+
+   // The engines that take the same arguments as compactPath work in place on a copy of the path,
+   // which has to be left alone.
+   for (uEngine = 0; uEngine < sizeof(aEngines) / sizeof(aEngines[0]); ++uEngine)
+      {
+      for (i = 0; i < 3; ++i)
+         {
+         if (aEngines[uEngine].engine(pScratch, pCase->uPoints, pScratch, &uKept,
+                                      i < 2 ? adBadEpsilons[i] : pCase->dEpsilon,
+                                      i < 2 ? pCase->deviationMetric : NULL))
+            {
+            fuzzFail(pCase, aEngines[uEngine].pName, "accepted a bad epsilon or metric");
+            }
+         }
+      if (memcmp(pScratch, pCase->pPoints, sizeof(DVector2D) * pCase->uPoints) != 0)
+         {
+         fuzzFail(pCase, aEngines[uEngine].pName, "wrote a result before failing");
+         }
+      }
+
+   uPathOffsets[1] = pCase->uPoints;
+   if (compactPathRings(pScratch, uPathOffsets, 1, pScratch, uResultOffsets, pCase->dEpsilon,
+                        NULL, 0))
+      {
+      fuzzFail(pCase, "compactPathRings", "accepted a missing metric");
+      }
+   if (compactPathChunked(fuzzRead, NULL, 4, 1, pCase->dEpsilon, NULL, fuzzEmit, NULL,
+                          &uEmitted))
+      {
+      fuzzFail(pCase, "compactPathChunked", "accepted a missing metric");
+      }
+   if (compactPathIndexBuild(pCase->pPoints, pCase->uPoints, NULL) != NULL)
+      {
+      fuzzFail(pCase, "compactPathIndexBuild", "accepted a missing metric");
+      }
+   }
+
+int LLVMFuzzerTestOneInput(const uint8_t *pData, size_t uSize);
+
+int LLVMFuzzerTestOneInput(const uint8_t *pData, size_t uSize)
+   {
+   FuzzCase fuzzCase;
+   DVector2D *pResult, *pScratch;
+   uint32_t *puKeptIndices;
+   unsigned char *pBitmap;
+   int iSuccess;
+
+   if (!fuzzDecode(&fuzzCase, pData, uSize))
+      {
+      return 0;
+      }
+
+   fuzzCase.pReference = (DVector2D *)malloc(sizeof(DVector2D) * (fuzzCase.uPoints + 1));
+   pResult = (DVector2D *)malloc(sizeof(DVector2D) * (fuzzCase.uPoints + 1));
+   pScratch = (DVector2D *)malloc(sizeof(DVector2D) * 2 * (fuzzCase.uPoints + 1));
+   puKeptIndices = (uint32_t *)malloc(sizeof(uint32_t) * 2 * (fuzzCase.uPoints + 1));
+   pBitmap = (unsigned char *)malloc(fuzzCase.uPoints / 8 + 1);
+   if (fuzzCase.pReference == NULL || pResult == NULL || pScratch == NULL ||
+       puKeptIndices == NULL || pBitmap == NULL)
+      {
+      fuzzFail(&fuzzCase, "LLVMFuzzerTestOneInput", "ran out of memory");
+      }
+
+   iSuccess = compactPath(fuzzCase.pPoints, fuzzCase.uPoints, fuzzCase.pReference,
+                          &fuzzCase.uReferencePoints, fuzzCase.dEpsilon,
+                          fuzzCase.deviationMetric);
+   fuzzExpectSubsequence(&fuzzCase, "compactPath", iSuccess, fuzzCase.pReference,
+                         fuzzCase.uReferencePoints);
+
+   fuzzCheckExact(&fuzzCase, pResult, pScratch, puKeptIndices, pBitmap);
+   fuzzCheckOthers(&fuzzCase, pResult, pScratch, puKeptIndices);
+   fuzzCheckBadArguments(&fuzzCase, pScratch, puKeptIndices, pBitmap);
+
+   free(fuzzCase.pPoints);
+   free(fuzzCase.pReference);
+   free(pResult);
+   free(pScratch);
+   free(puKeptIndices);
+   free(pBitmap);
+
+   return 0;
+   }
+
+#ifndef PATH_COMPACTER_LIBFUZZER
+
+// A small xorshift generator, so that a seed always gives the same inputs.
+static unsigned long long uRandomState;
+
+static unsigned int randomByte(void)
+   {
+   uRandomState ^= uRandomState << 13;
+   uRandomState ^= uRandomState >> 7;
+   uRandomState ^= uRandomState << 17;
+   return (unsigned int)(uRandomState >> 32) & 255;
+   }
+
+static void fuzzRun(const uint8_t *pData, size_t uSize)
+   {
+   pCurrentData = pData;
+   uCurrentSize = uSize;
+   LLVMFuzzerTestOneInput(pData, uSize);
+   }
+
+static int fuzzRunFile(const char *pFileName)
+   {
+   FILE *pFile;
+   uint8_t *pData;
+   long lSize;
+
+   pFile = fopen(pFileName, "rb");
+   if (pFile == NULL || fseek(pFile, 0, SEEK_END) != 0 || (lSize = ftell(pFile)) < 0 ||
+       fseek(pFile, 0, SEEK_SET) != 0)
+      {
+      fprintf(stderr, "Can't read %s\n", pFileName);
+      if (pFile != NULL)
+         {
+         fclose(pFile);
+         }
+      return 0;
+      }
+
+   pData = (uint8_t *)malloc((size_t)lSize + 1);
+   if (pData == NULL || fread(pData, 1, (size_t)lSize, pFile) != (size_t)lSize)
+      {
+      fprintf(stderr, "Can't read %s\n", pFileName);
+      free(pData);
+      fclose(pFile);
+      return 0;
+      }
+   fclose(pFile);
+
+   fuzzRun(pData, (size_t)lSize);
+   free(pData);
+
+   return 1;
+   }
+
+int main(int iArgumentCount, char **ppArguments)
+   {
+   static const unsigned int auFixedLengths[] = {0, 1, 2, 3, 4, 5, 8, 33, 300};
+   uint8_t aData[4096];
+   unsigned long uRuns, uRun;
+   unsigned int uOptions, uLength, uFill;
+   size_t u, uSize;
+   int iOption, iArgument;
+
+   uRuns = FUZZ_DEFAULT_RUNS;
+   uRandomState = 88172645463325252ULL;
+
+   while ((iOption = getopt(iArgumentCount, ppArguments, "n:s:")) != -1)
+      {
+      switch (iOption)
+         {
+         case 'n':
+            uRuns = strtoul(optarg, NULL, 10);
+            break;
+         case 's':
+            uRandomState ^= strtoull(optarg, NULL, 10) * 0x9e3779b97f4a7c15ULL;
+            break;
+         default:
+            fprintf(stderr, "Usage: %s [-n runs] [-s seed] [file ...]\n", ppArguments[0]);
+            return 1;
+         }
+      }
+
+   if (optind < iArgumentCount)
+      {
+      for (iArgument = optind; iArgument < iArgumentCount; ++iArgument)
+         {
+         if (!fuzzRunFile(ppArguments[iArgument]))
+            {
+            return 1;
+            }
+         }
+      printf("%d inputs passed\n", iArgumentCount - optind);
+      return 0;
+      }
+
+   // Every option byte, with points that are all the same, that count up, and that are random.
+   uRun = 0;
+   for (uOptions = 0; uOptions < 256; ++uOptions)
+      {
+      for (u = 0; u < sizeof(auFixedLengths) / sizeof(auFixedLengths[0]); ++u)
+         {
+         for (uFill = 0; uFill < 3; ++uFill)
+            {
+            aData[0] = (uint8_t)uOptions;
+            aData[1] = (uint8_t)(uOptions * 37);
+            aData[2] = (uint8_t)(uOptions * 101 + uFill);
+            for (uLength = 3; uLength < 3 + auFixedLengths[u] * 2; ++uLength)
+               {
+               aData[uLength] = uFill == 0 ? 0x80 : uFill == 1 ? (uint8_t)uLength :
+                                (uint8_t)randomByte();
+               }
+            fuzzRun(aData, 3 + auFixedLengths[u] * 2);
+            ++uRun;
+            }
+         }
+      }
+
+   // Then random inputs, some of them with long runs of the same byte.
+   for (; uRun < uRuns; ++uRun)
+      {
+      uSize = randomByte() < 64 ? randomByte() % 16 : (randomByte() * 16 + randomByte()) % 4096;
+      for (u = 0; u < uSize; ++u)
+         {
+         aData[u] = (uint8_t)randomByte();
+         if (u > 3 && randomByte() < 32)
+            {
+            aData[u] = aData[u - 1 - randomByte() % 3];
+            }
+         }
+      fuzzRun(aData, uSize);
+      }
+
+   printf("%lu inputs passed\n", uRun);
+
+   return 0;
+   }
+
+#endif
@@ -0,0 +1,517 @@
+/*
+   PathCompacterHull.c
+   10/15/2026
+   Authors: Michael Casebolt, Brett Casebolt
+*/
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Michael Casebolt and Brett Casebolt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// This file uses lines up to 100 characters long. If this 100 character line fits then you're good.
+
+// This engine answers the farthest point queries of the perpendicular distance metric from a
+// tree over the path instead of scanning every intermediate point of every subproblem.
+//
+// Every node of the tree covers a run of consecutive points and stores a discrete orientation
+// hull of them: how far they reach in each of 16 evenly spaced directions. That is a convex
+// polygon around the run which, unlike the exact convex hull, can be queried in constant time.
+// The area that the metric squares is a linear function of the point, so the hull gives an upper
+// bound on the deviation of every point in the run. A query walks down the tree, always into the
+// more promising child first, and skips every node whose bound can't beat the best point found so
+// far. Only the leaves that survive get scanned.
+//
+// The result has to be exactly the same as the scan's, which depends on how the scan rounds and
+// breaks ties. A floating point hull query can't promise that, so the hulls are only used to rule
+// nodes out, with room left in the bounds for every rounding error involved, and the points that
+// remain are measured with the same metric body and compared the same way as in the scan.
+//
+// This is a search pruned by bounds, not the path hull of Hershberger and Snoeyink, and it has no
+// better worst case than the scan. When many points of a subproblem are about as far from the
+// segment as the farthest one, none of their nodes can be ruled out, and the walk ends up scanning
+// them all on top of the work of walking the tree. On ordinary paths, where the divisions already
+// split the path evenly, building the tree costs about as much as the compaction itself. It pays
+// off on some of the paths that make the scan quadratic, like finely sampled spirals at small
+// epsilons, where the farthest point stands out and most nodes are ruled out. It is slower than
+// compactPath on others, including coarser spirals and curves whose points peel off one at a time
+// with near-ties all along them. Measure before picking it.
+
+#include "PathCompacter.h"
+#include "PathCompacterInternal.h"
+
+#include <stdlib.h> // For memory management
+#include <float.h> // For DBL_EPSILON
+#include <limits.h> // For INT_MAX
+#include <math.h> // For atan2, floor, fabs and HUGE_VAL
+
+#define FAILURE 0
+#define SUCCESS 1
+
+// Subproblems this small are scanned directly, because the walk wouldn't save anything.
+#define COMPACT_PATH_HULL_MIN_QUERY_POINTS (4 * COMPACT_PATH_HULL_LEAF_POINTS)
+
+// The tree is at most 27 levels deep, and the walk never has more than two nodes per level
+// waiting.
+#define COMPACT_PATH_HULL_STACK_DEPTH 64
+
+// The rounding errors of the metric, of the stored hulls and of the bound itself all add up to
+// far less than this many units in the last place of the magnitudes involved.
+#define COMPACT_PATH_HULL_SLACK (512.0 * DBL_EPSILON)
+
+#define COMPACT_PATH_HULL_COS_1 0.92387953251128674 // cos(22.5 degrees)
+#define COMPACT_PATH_HULL_COS_2 0.70710678118654757 // cos(45 degrees)
+#define COMPACT_PATH_HULL_COS_3 0.38268343236508978 // cos(67.5 degrees)
+
+static const double adHullDirectionX[COMPACT_PATH_HULL_DIRECTIONS] =
+   {
+   1.0, COMPACT_PATH_HULL_COS_1, COMPACT_PATH_HULL_COS_2, COMPACT_PATH_HULL_COS_3,
+   0.0, -COMPACT_PATH_HULL_COS_3, -COMPACT_PATH_HULL_COS_2, -COMPACT_PATH_HULL_COS_1,
+   -1.0, -COMPACT_PATH_HULL_COS_1, -COMPACT_PATH_HULL_COS_2, -COMPACT_PATH_HULL_COS_3,
+   -0.0, COMPACT_PATH_HULL_COS_3, COMPACT_PATH_HULL_COS_2, COMPACT_PATH_HULL_COS_1
+   };
+
+static const double adHullDirectionY[COMPACT_PATH_HULL_DIRECTIONS] =
+   {
+   0.0, COMPACT_PATH_HULL_COS_3, COMPACT_PATH_HULL_COS_2, COMPACT_PATH_HULL_COS_1,
+   1.0, COMPACT_PATH_HULL_COS_1, COMPACT_PATH_HULL_COS_2, COMPACT_PATH_HULL_COS_3,
+   -0.0, -COMPACT_PATH_HULL_COS_3, -COMPACT_PATH_HULL_COS_2, -COMPACT_PATH_HULL_COS_1,
+   -1.0, -COMPACT_PATH_HULL_COS_1, -COMPACT_PATH_HULL_COS_2, -COMPACT_PATH_HULL_COS_3
+   };
+
+// A node that the walk still has to look at, along with its bound.
+typedef struct CompactPathHullCall
+   {
+   int iNode;
+   int iStart;
+   int iEnd;
+   double dBound;
+   } CompactPathHullCall;
+
+// Everything needed to bound a node, worked out once per subproblem.
+typedef struct CompactPathHullQuery
+   {
+   DVector2D start;
+   DVector2D end;
+   double dSquareSegLen;
+
+   // The area that the metric squares is normal . point + dOffset, where the normal is
+   // dAlpha times direction iDirection plus dBeta times the direction after it.
+   double dOffset;
+   double dAlpha;
+   double dBeta;
+   int iDirection;
+
+   // These size the slack.
+   double dNormalSize;
+   double dEndpointMagnitude;
+   } CompactPathHullQuery;
+
+size_t compactPathHullNodeCount(int iPoints)
+   {
+   size_t uNodes;
+
+   uNodes = 1;
+   while (iPoints > COMPACT_PATH_HULL_LEAF_POINTS)
+      {
+      iPoints = iPoints - iPoints / 2;
+      uNodes = 2 * uNodes + 1;
+      }
+
+   return uNodes;
+   }
+
+void compactPathHullBuild(CompactPathHullTree *pTree, int iNode, int iStart, int iEnd)
+   {
+   CompactPathHullNode *pNode, *pLeft, *pRight;
+   double dReach;
+   int i, d, iMiddle;
+
+   pNode = pTree->pNodes + iNode;
+
+   if (iEnd - iStart <= COMPACT_PATH_HULL_LEAF_POINTS)
+      {
+      for (d = 0; d < COMPACT_PATH_HULL_DIRECTIONS; ++d)
+         {
+         pNode->adReach[d] = -HUGE_VAL;
+         for (i = iStart; i < iEnd; ++i)
+            {
+            if (pTree->pPointArray[i].dX != pTree->pPointArray[i].dX ||
+                pTree->pPointArray[i].dY != pTree->pPointArray[i].dY)
+               {
+               continue;
+               }
+
+            dReach = adHullDirectionX[d] * pTree->pPointArray[i].dX +
+                     adHullDirectionY[d] * pTree->pPointArray[i].dY;
+            if (dReach != dReach)
+               {
+               dReach = HUGE_VAL;
+               }
+            if (dReach > pNode->adReach[d])
+               {
+               pNode->adReach[d] = dReach;
+               }
+            }
+         }
+      return;
+      }
+
+   iMiddle = iStart + (iEnd - iStart) / 2;
+   compactPathHullBuild(pTree, 2 * iNode + 1, iStart, iMiddle);
+   compactPathHullBuild(pTree, 2 * iNode + 2, iMiddle, iEnd);
+
+   pLeft = pTree->pNodes + 2 * iNode + 1;
+   pRight = pTree->pNodes + 2 * iNode + 2;
+   for (d = 0; d < COMPACT_PATH_HULL_DIRECTIONS; ++d)
+      {
+      pNode->adReach[d] = pRight->adReach[d] > pLeft->adReach[d] ?
+                          pRight->adReach[d] : pLeft->adReach[d];
+      }
+   }
+
+void compactPathHullUpdate(CompactPathHullTree *pTree, int iNode, int iStart, int iEnd,
+                           int iFirstPoint, int iLastPoint)
+   {
+   CompactPathHullNode *pNode, *pLeft, *pRight;
+   int d, iMiddle;
+
+   if (iEnd - iStart <= COMPACT_PATH_HULL_LEAF_POINTS)
+      {
+      compactPathHullBuild(pTree, iNode, iStart, iEnd);
+      return;
+      }
+
+   iMiddle = iStart + (iEnd - iStart) / 2;
+   if (iFirstPoint < iMiddle)
+      {
+      compactPathHullUpdate(pTree, 2 * iNode + 1, iStart, iMiddle, iFirstPoint, iLastPoint);
+      }
+   if (iLastPoint >= iMiddle)
+      {
+      compactPathHullUpdate(pTree, 2 * iNode + 2, iMiddle, iEnd, iFirstPoint, iLastPoint);
+      }
+
+   pNode = pTree->pNodes + iNode;
+   pLeft = pTree->pNodes + 2 * iNode + 1;
+   pRight = pTree->pNodes + 2 * iNode + 2;
+   for (d = 0; d < COMPACT_PATH_HULL_DIRECTIONS; ++d)
+      {
+      pNode->adReach[d] = pRight->adReach[d] > pLeft->adReach[d] ?
+                          pRight->adReach[d] : pLeft->adReach[d];
+      }
+   }
+
+static void compactPathHullPrepareQuery(CompactPathHullQuery *pQuery, const DVector2D *pStart,
+                                        const DVector2D *pEnd)
+   {
+   double dNormalX, dNormalY, dDeterminant, dSector;
+   int iNext;
+
+   pQuery->start = *pStart;
+   pQuery->end = *pEnd;
+
+   // The scan gets the same segment length from the same differences.
+   dNormalX = pEnd->dY - pStart->dY;
+   dNormalY = pStart->dX - pEnd->dX;
+   pQuery->dSquareSegLen = dNormalY * dNormalY + dNormalX * dNormalX;
+   pQuery->dOffset = pEnd->dX * pStart->dY - pStart->dX * pEnd->dY;
+
+   // Find the pair of directions that the normal lies between. If the normal is NaN, any pair
+   // will do, because the bounds will all be NaN too.
+   dSector = floor(atan2(dNormalY, dNormalX) * (COMPACT_PATH_HULL_DIRECTIONS / 6.283185307179586));
+   pQuery->iDirection = 0;
+   if (dSector >= -COMPACT_PATH_HULL_DIRECTIONS && dSector <= COMPACT_PATH_HULL_DIRECTIONS)
+      {
+      pQuery->iDirection = ((int)dSector + COMPACT_PATH_HULL_DIRECTIONS) %
+                           COMPACT_PATH_HULL_DIRECTIONS;
+      }
+   iNext = (pQuery->iDirection + 1) % COMPACT_PATH_HULL_DIRECTIONS;
+
+   dDeterminant = adHullDirectionX[pQuery->iDirection] * adHullDirectionY[iNext] -
+                  adHullDirectionY[pQuery->iDirection] * adHullDirectionX[iNext];
+   pQuery->dAlpha = (dNormalX * adHullDirectionY[iNext] - dNormalY * adHullDirectionX[iNext]) /
+                    dDeterminant;
+   pQuery->dBeta = (adHullDirectionX[pQuery->iDirection] * dNormalY -
+                    adHullDirectionY[pQuery->iDirection] * dNormalX) / dDeterminant;
+
+   // Right on the edge of a sector, rounding can leave one of these a hair below zero. Dropping
+   // it moves the normal by about as much as rounding already does, which the slack covers.
+   if (!(pQuery->dAlpha > 0.0))
+      {
+      pQuery->dAlpha = 0.0;
+      }
+   if (!(pQuery->dBeta > 0.0))
+      {
+      pQuery->dBeta = 0.0;
+      }
+
+   pQuery->dNormalSize = fabs(dNormalX) + fabs(dNormalY);
+   pQuery->dEndpointMagnitude = fmax(fmax(fabs(pStart->dX), fabs(pStart->dY)),
+                                     fmax(fabs(pEnd->dX), fabs(pEnd->dY)));
+   }
+
+// Returns a value that is at least as large as what the metric returns for any point of the node
+// that doesn't have a NaN in it. Whenever an infinity gets involved, the bound comes out infinite
+// and can't rule anything out.
+static double compactPathHullBound(const CompactPathHullQuery *pQuery,
+                                   const CompactPathHullNode *pNode)
+   {
+   const double *pdReach;
+   double dMagnitude, dAbove, dBelow, dSlack, dBound;
+   int iDirection, iNext, iOpposite, iNextOpposite;
+
+   pdReach = pNode->adReach;
+   iDirection = pQuery->iDirection;
+   iNext = (iDirection + 1) % COMPACT_PATH_HULL_DIRECTIONS;
+   iOpposite = (iDirection + COMPACT_PATH_HULL_DIRECTIONS / 2) % COMPACT_PATH_HULL_DIRECTIONS;
+   iNextOpposite = (iNext + COMPACT_PATH_HULL_DIRECTIONS / 2) % COMPACT_PATH_HULL_DIRECTIONS;
+
+   // The four axis directions give the largest coordinate magnitude in the node.
+   dMagnitude = fmax(fmax(pdReach[0], pdReach[COMPACT_PATH_HULL_DIRECTIONS / 4]),
+                     fmax(pdReach[COMPACT_PATH_HULL_DIRECTIONS / 2],
+                          pdReach[3 * COMPACT_PATH_HULL_DIRECTIONS / 4]));
+   dMagnitude = fmax(dMagnitude, pQuery->dEndpointMagnitude);
+
+   dSlack = COMPACT_PATH_HULL_SLACK * (pQuery->dNormalSize + dMagnitude) * dMagnitude;
+
+   // How far above zero the area can go, from the two directions on either side of the normal,
+   // and how far below zero, from the two opposite directions.
+   dAbove = pQuery->dAlpha * pdReach[iDirection] + pQuery->dBeta * pdReach[iNext] +
+            pQuery->dOffset + dSlack;
+   dBelow = pQuery->dAlpha * pdReach[iOpposite] + pQuery->dBeta * pdReach[iNextOpposite] -
+            pQuery->dOffset + dSlack;
+
+   if (dAbove != dAbove || dBelow != dBelow)
+      {
+      return HUGE_VAL;
+      }
+
+   // The area can only be in between, so neither side being above zero means the node is empty
+   // of usable points.
+   dAbove = fmax(dAbove, dBelow);
+   if (dAbove < 0.0)
+      {
+      return 0.0;
+      }
+
+   // Squaring and dividing the same way the metric does can't turn a larger area into a smaller
+   // deviation.
+   dBound = dAbove * dAbove / pQuery->dSquareSegLen;
+   return dBound == dBound ? dBound : HUGE_VAL;
+   }
+
+// Decides whether a node could have a point that beats the best one so far. A point has to have
+// a larger deviation, or the same one (above zero) at a lower index, to beat it.
+static int compactPathHullCouldBeat(double dBound, int iNodeStart, double dBest, int iBestIndex)
+   {
+   if (dBound > dBest)
+      {
+      return 1;
+      }
+   return dBound == dBest && dBest > 0.0 && iNodeStart < iBestIndex;
+   }
+
+int compactPathHullRangeScan(const void *pPath, unsigned int uStart,
+                             int iPointsInCurrentPath, double *pdMaxSquareDeviation)
+   {
+   const CompactPathHullTree *pTree;
+   CompactPathHullCall aStack[COMPACT_PATH_HULL_STACK_DEPTH], call, left, right, *pBetter, *pWorse;
+   CompactPathHullQuery query;
+   double dBest, dSquareDeviation;
+   int i, iFirst, iLast, iBestIndex, iNumCallsInStack, iMiddle;
+
+   pTree = (const CompactPathHullTree *)pPath;
+
+   if (iPointsInCurrentPath < COMPACT_PATH_HULL_MIN_QUERY_POINTS)
+      {
+      return pTree->maxDeviationScan(pTree->pPointArray + uStart, iPointsInCurrentPath,
+                                     pTree->deviationMetric, pdMaxSquareDeviation);
+      }
+
+   compactPathHullPrepareQuery(&query, pTree->pPointArray + uStart,
+                               pTree->pPointArray + uStart + iPointsInCurrentPath - 1);
+
+   // The intermediate points of the subproblem.
+   iFirst = (int)uStart + 1;
+   iLast = (int)uStart + iPointsInCurrentPath - 2;
+
+   // The scan starts out the same way, so nothing at or below zero ever gets picked.
+   dBest = 0.0;
+   iBestIndex = 0;
+
+   aStack[0].iNode = 0;
+   aStack[0].iStart = 0;
+   aStack[0].iEnd = pTree->iPoints;
+   aStack[0].dBound = compactPathHullBound(&query, pTree->pNodes);
+   iNumCallsInStack = 1;
+
+   while (iNumCallsInStack > 0)
+      {
+      --iNumCallsInStack;
+      call = aStack[iNumCallsInStack];
+
+      // The best point may have gotten better since this node was pushed.
+      if (!compactPathHullCouldBeat(call.dBound, call.iStart, dBest, iBestIndex))
+         {
+         continue;
+         }
+
+      if (call.iEnd - call.iStart <= COMPACT_PATH_HULL_LEAF_POINTS)
+         {
+         if (call.iStart < iFirst)
+            {
+            call.iStart = iFirst;
+            }
+         if (call.iEnd > iLast + 1)
+            {
+            call.iEnd = iLast + 1;
+            }
+
+         for (i = call.iStart; i < call.iEnd; ++i)
+            {
+            dSquareDeviation = compactPathPerpendicularDistance(&query.start, &query.end,
+                                                                pTree->pPointArray + i,
+                                                                query.dSquareSegLen);
+
+            if (dSquareDeviation > dBest ||
+                (dSquareDeviation == dBest && dBest > 0.0 && i < iBestIndex))
+               {
+               iBestIndex = i;
+               dBest = dSquareDeviation;
+               }
+            }
+         continue;
+         }
+
+      iMiddle = call.iStart + (call.iEnd - call.iStart) / 2;
+
+      left.iNode = 2 * call.iNode + 1;
+      left.iStart = call.iStart;
+      left.iEnd = iMiddle;
+      right.iNode = 2 * call.iNode + 2;
+      right.iStart = iMiddle;
+      right.iEnd = call.iEnd;
+
+      // Children that don't overlap the intermediate points can't beat anything.
+      left.dBound = left.iEnd > iFirst ? compactPathHullBound(&query, pTree->pNodes + left.iNode) :
+                    -1.0;
+      right.dBound = right.iStart <= iLast ?
+                     compactPathHullBound(&query, pTree->pNodes + right.iNode) : -1.0;
+
+      // Push the more promising child last, so that it gets looked at first. The sooner a good
+      // point turns up, the more of the tree it rules out.
+      pBetter = right.dBound > left.dBound ? &right : &left;
+      pWorse = pBetter == &left ? &right : &left;
+      if (compactPathHullCouldBeat(pWorse->dBound, pWorse->iStart, dBest, iBestIndex))
+         {
+         aStack[iNumCallsInStack] = *pWorse;
+         ++iNumCallsInStack;
+         }
+      if (compactPathHullCouldBeat(pBetter->dBound, pBetter->iStart, dBest, iBestIndex))
+         {
+         aStack[iNumCallsInStack] = *pBetter;
+         ++iNumCallsInStack;
+         }
+      }
+
+   *pdMaxSquareDeviation = dBest;
+   return iBestIndex > 0 ? iBestIndex - (int)uStart : 0;
+   }
+
+// This function runs the Ramer-Douglas-Peucker algorithm with the hull tree described at the top
+// of this file. The arguments and the result are the same as for compactPath, and so is the
+// output, point for point. It works in-place too.
+// The tree only knows how to bound perpendicularDistanceDeviationMetric. Any other metric is
+// handed to compactPath instead.
+// The tree and the kept indices take about 4 + 16 bytes per point of memory.
+int compactPathHull(DVector2D *pPointArray, unsigned int uPointsInCurrentPath,
+                    DVector2D *pResultPointArray, unsigned int *puPointsInResultPath,
+                    double dEpsilon, DeviationMetric deviationMetric)
+   {
+   CompactPathHullTree tree;
+   uint32_t *puKeptIndices;
+   unsigned int u, uNumKept;
+   int iSuccess;
+
+   // Check for invalid values.
+   if (uPointsInCurrentPath > INT_MAX || pPointArray == NULL || pResultPointArray == NULL ||
+       puPointsInResultPath == NULL || !(dEpsilon >= 0.0) || deviationMetric == NULL)
+      {
+      return FAILURE;
+      }
+
+   if (deviationMetric != perpendicularDistanceDeviationMetric)
+      {
+      return compactPath(pPointArray, uPointsInCurrentPath, pResultPointArray,
+                         puPointsInResultPath, dEpsilon, deviationMetric);
+      }
+
+   tree.pPointArray = pPointArray;
+   tree.iPoints = (int)uPointsInCurrentPath;
+   tree.pNodes = NULL;
+   tree.maxDeviationScan = compactPathSelectMaxDeviationScan(deviationMetric);
+   tree.deviationMetric = deviationMetric;
+
+   puKeptIndices = (uint32_t *)malloc(sizeof(uint32_t) * (uPointsInCurrentPath + 1));
+   if (puKeptIndices == NULL)
+      {
+      return FAILURE;
+      }
+
+   // Paths that are too short to ever be queried don't need a tree.
+   if (uPointsInCurrentPath >= COMPACT_PATH_HULL_MIN_QUERY_POINTS)
+      {
+      tree.pNodes = (CompactPathHullNode *)malloc(sizeof(CompactPathHullNode) *
+                                                  compactPathHullNodeCount(tree.iPoints));
+      if (tree.pNodes == NULL)
+         {
+         free(puKeptIndices);
+         return FAILURE;
+         }
+      compactPathHullBuild(&tree, 0, 0, tree.iPoints);
+      }
+
+   iSuccess = compactPathKeptIndicesWithRangeScan(&tree, uPointsInCurrentPath, puKeptIndices,
+                                                  &uNumKept, dEpsilon, compactPathHullRangeScan);
+
+   free(tree.pNodes);
+
+   if (!iSuccess)
+      {
+      free(puKeptIndices);
+      return FAILURE;
+      }
+
+   // The indices are increasing, so no kept point moves to a higher index and this is safe in
+   // place.
+   for (u = 0; u < uNumKept; ++u)
+      {
+      pResultPointArray[u] = pPointArray[puKeptIndices[u]];
+      }
+
+   free(puKeptIndices);
+
+   *puPointsInResultPath = uNumKept;
+
+   return SUCCESS;
+   }
@@ -0,0 +1,701 @@
+/*
+   PathCompacterIncremental.c
+   10/15/2026
+   Authors: Michael Casebolt, Brett Casebolt
+*/
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Michael Casebolt and Brett Casebolt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// This file uses lines up to 100 characters long. If this 100 character line fits then you're good.
+
+// This compacter keeps the division tree of its last run, so that appending points to the path or
+// moving some of them only redoes the part of the tree that they affect.
+//
+// Every division in the tree is a node that remembers the run it divided and the point it divided
+// it at. A run always divides the same way as long as none of its points have changed. So after
+// an update, the tree is walked again from the top, and every run that matches a node of the old
+// tree and has no changed points in it takes that node's whole subtree as it is. Only the other
+// runs get scanned. After an append those are the runs down the right edge of the tree, and after
+// an edit they are the ones on the way down to the edited points.
+//
+// A run that does have to be scanned still costs a scan of all of its points, and the top of the
+// tree covers the whole path. With perpendicularDistanceDeviationMetric, the scans are answered
+// by the hull tree of PathCompacterHull.c instead, which is kept up to date along with the points.
+// On smooth paths its bounds rule out most of a run, so a redone run costs far less than a scan,
+// but like compactPathHull it has no better worst case. Other metrics scan.
+//
+// The old divisions that didn't make it into the new tree are let go afterwards, with a walk of
+// the old tree that stops at every subtree that was reused.
+
+#include "PathCompacter.h"
+#include "PathCompacterInternal.h"
+
+#include <stdlib.h> // For memory management
+#include <string.h> // For memcpy
+#include <limits.h> // For INT_MAX and UINT_MAX
+#include <math.h> // For nan
+
+#define FAILURE 0
+#define SUCCESS 1
+
+// Room is made for at least this many points, and for this many nodes.
+#define COMPACT_PATH_INCREMENTAL_MIN_CAPACITY 1024
+
+#define COMPACT_PATH_INCREMENTAL_NO_NODE (-1)
+
+// A division of the run from iStart to iEnd at iDivision. iLeft and iRight are the nodes that
+// divide the two sides, or COMPACT_PATH_INCREMENTAL_NO_NODE for a side that linearized. Free
+// nodes are linked together through iLeft.
+typedef struct CompactPathIncrementalNode
+   {
+   int iStart;
+   int iEnd;
+   int iDivision;
+   int iLeft;
+   int iRight;
+   unsigned int uGeneration;
+   } CompactPathIncrementalNode;
+
+// A run that the walk still has to divide. iOldNode is the deepest node of the old tree that is
+// known to cover the run, or COMPACT_PATH_INCREMENTAL_NO_NODE to start looking from the old root.
+// The run's node becomes the left (iSide 0) or right (iSide 1) side of iParent, or the root if
+// iParent is COMPACT_PATH_INCREMENTAL_NO_NODE. The walks over the finished trees only use
+// iOldNode.
+typedef struct CompactPathIncrementalCall
+   {
+   int iStart;
+   int iEnd;
+   int iOldNode;
+   int iParent;
+   int iSide;
+   } CompactPathIncrementalCall;
+
+struct PathCompacterIncremental
+   {
+   // The points past iPoints are NaN, so that the hulls leave them out.
+   DVector2D *pPointArray;
+   unsigned char *pKeepFlags;
+   int iPoints;
+   int iCapacity;
+   double dEpsilon;
+
+   // Every metric goes through the tree's points, scan and metric, but only
+   // perpendicularDistanceDeviationMetric gets hulls.
+   CompactPathHullTree tree;
+   CompactPathRangeScan rangeScan;
+
+   CompactPathIncrementalNode *pNodes;
+   int iNodeCapacity;
+   int iLiveNodes;
+   int iFreeNode;
+   int iRoot;
+
+   // Nodes made by the current update get this generation, and the reused ones get the next one.
+   unsigned int uGeneration;
+
+   // The runs waiting in a walk never overlap, so there can't be more of them than points.
+   CompactPathIncrementalCall *pCalls;
+
+   int iFirstChange;
+   };
+
+// This is the range scan for the metrics that don't get hulls.
+static int compactPathIncrementalScan(const void *pPath, unsigned int uStart,
+                                      int iPointsInCurrentPath, double *pdMaxSquareDeviation)
+   {
+   const CompactPathHullTree *pTree;
+
+   pTree = (const CompactPathHullTree *)pPath;
+
+   return pTree->maxDeviationScan(pTree->pPointArray + uStart, iPointsInCurrentPath,
+                                  pTree->deviationMetric, pdMaxSquareDeviation);
+   }
+
+// Makes room for iPoints points. Nothing changes unless it succeeds.
+static int compactPathIncrementalReserve(PathCompacterIncremental *pIncremental, int iPoints)
+   {
+   DVector2D *pPointArray;
+   unsigned char *pKeepFlags;
+   CompactPathIncrementalCall *pCalls;
+   CompactPathHullNode *pHullNodes;
+   int i, iCapacity;
+
+   if (iPoints <= pIncremental->iCapacity)
+      {
+      return SUCCESS;
+      }
+
+   iCapacity = pIncremental->iCapacity > 0 ? pIncremental->iCapacity :
+                                             COMPACT_PATH_INCREMENTAL_MIN_CAPACITY;
+   while (iCapacity < iPoints)
+      {
+      iCapacity = iCapacity > INT_MAX / 2 ? INT_MAX : 2 * iCapacity;
+      }
+
+   // The arrays that did grow are kept even if a later one can't, since the capacity only goes
+   // up once they all have.
+   pPointArray = (DVector2D *)realloc(pIncremental->pPointArray,
+                                      sizeof(DVector2D) * (size_t)iCapacity);
+   if (pPointArray == NULL)
+      {
+      return FAILURE;
+      }
+   pIncremental->pPointArray = pPointArray;
+   pIncremental->tree.pPointArray = pPointArray;
+
+   pKeepFlags = (unsigned char *)realloc(pIncremental->pKeepFlags, (size_t)iCapacity);
+   if (pKeepFlags == NULL)
+      {
+      return FAILURE;
+      }
+   pIncremental->pKeepFlags = pKeepFlags;
+
+   pCalls = (CompactPathIncrementalCall *)realloc(pIncremental->pCalls,
+                                                  sizeof(CompactPathIncrementalCall) *
+                                                  (size_t)iCapacity);
+   if (pCalls == NULL)
+      {
+      return FAILURE;
+      }
+   pIncremental->pCalls = pCalls;
+
+   pHullNodes = NULL;
+   if (pIncremental->rangeScan == compactPathHullRangeScan)
+      {
+      pHullNodes = (CompactPathHullNode *)malloc(sizeof(CompactPathHullNode) *
+                                                 compactPathHullNodeCount(iCapacity));
+      if (pHullNodes == NULL)
+         {
+         return FAILURE;
+         }
+      }
+
+   for (i = pIncremental->iCapacity; i < iCapacity; ++i)
+      {
+      pPointArray[i].dX = nan("");
+      pPointArray[i].dY = nan("");
+      pKeepFlags[i] = 0;
+      }
+   pIncremental->iCapacity = iCapacity;
+
+   if (pHullNodes != NULL)
+      {
+      free(pIncremental->tree.pNodes);
+      pIncremental->tree.pNodes = pHullNodes;
+      pIncremental->tree.iPoints = iCapacity;
+      compactPathHullBuild(&pIncremental->tree, 0, 0, iCapacity);
+      }
+
+   return SUCCESS;
+   }
+
+// Makes sure that an update of a path with iPoints points can't run out of nodes. The new tree
+// never has more than iPoints nodes, and the old one is still around while it gets built.
+static int compactPathIncrementalReserveNodes(PathCompacterIncremental *pIncremental, int iPoints)
+   {
+   CompactPathIncrementalNode *pNodes;
+   size_t uNeeded, uCapacity;
+   int i;
+
+   uNeeded = (size_t)pIncremental->iLiveNodes + (size_t)iPoints;
+   if (uNeeded <= (size_t)pIncremental->iNodeCapacity)
+      {
+      return SUCCESS;
+      }
+
+   uCapacity = pIncremental->iNodeCapacity > 0 ? (size_t)pIncremental->iNodeCapacity :
+                                                 COMPACT_PATH_INCREMENTAL_MIN_CAPACITY;
+   while (uCapacity < uNeeded)
+      {
+      uCapacity *= 2;
+      }
+   if (uCapacity > INT_MAX)
+      {
+      uCapacity = INT_MAX;
+      if (uCapacity < uNeeded)
+         {
+         return FAILURE;
+         }
+      }
+
+   pNodes = (CompactPathIncrementalNode *)realloc(pIncremental->pNodes,
+                                                  sizeof(CompactPathIncrementalNode) * uCapacity);
+   if (pNodes == NULL)
+      {
+      return FAILURE;
+      }
+   pIncremental->pNodes = pNodes;
+
+   for (i = (int)uCapacity - 1; i >= pIncremental->iNodeCapacity; --i)
+      {
+      pNodes[i].uGeneration = 0;
+      pNodes[i].iLeft = pIncremental->iFreeNode;
+      pIncremental->iFreeNode = i;
+      }
+   pIncremental->iNodeCapacity = (int)uCapacity;
+
+   return SUCCESS;
+   }
+
+static void compactPathIncrementalNoteChange(PathCompacterIncremental *pIncremental, int iPoint)
+   {
+   if (iPoint < pIncremental->iFirstChange)
+      {
+      pIncremental->iFirstChange = iPoint;
+      }
+   }
+
+// Hangs iNode (which may be COMPACT_PATH_INCREMENTAL_NO_NODE) where the call says it goes.
+static void compactPathIncrementalLink(PathCompacterIncremental *pIncremental,
+                                       const CompactPathIncrementalCall *pCall, int iNode)
+   {
+   if (pCall->iParent == COMPACT_PATH_INCREMENTAL_NO_NODE)
+      {
+      pIncremental->iRoot = iNode;
+      }
+   else if (pCall->iSide == 0)
+      {
+      pIncremental->pNodes[pCall->iParent].iLeft = iNode;
+      }
+   else
+      {
+      pIncremental->pNodes[pCall->iParent].iRight = iNode;
+      }
+   }
+
+// Pushes a call for one of the walks over a finished tree.
+static void compactPathIncrementalPushNode(PathCompacterIncremental *pIncremental,
+                                           int *piNumCallsInStack, int iNode)
+   {
+   pIncremental->pCalls[*piNumCallsInStack].iOldNode = iNode;
+   ++*piNumCallsInStack;
+   }
+
+// Brings the tree, the keep flags and the first change up to date after the points from
+// iFirstDirty to iLastDirty have been added or moved. Before that, the path ended at iOldLast.
+// There have to be enough free nodes already, so this can't fail.
+static void compactPathIncrementalUpdate(PathCompacterIncremental *pIncremental, int iFirstDirty,
+                                         int iLastDirty, int iOldLast)
+   {
+   CompactPathIncrementalCall call;
+   CompactPathIncrementalNode *pNode;
+   unsigned char *pKeepFlags;
+   double dMaxSquareDeviation, dSquareEpsilon;
+   int i, iLast, iOldRoot, iOld, iMatch, iNext, iNode, iDivisionIndex, iNumCallsInStack;
+
+   pKeepFlags = pIncremental->pKeepFlags;
+   dSquareEpsilon = pIncremental->dEpsilon * pIncremental->dEpsilon;
+   iLast = pIncremental->iPoints - 1;
+
+   // Start the generations over before they run out.
+   if (pIncremental->uGeneration > UINT_MAX - 4)
+      {
+      for (i = 0; i < pIncremental->iNodeCapacity; ++i)
+         {
+         pIncremental->pNodes[i].uGeneration = 0;
+         }
+      pIncremental->uGeneration = 0;
+      }
+   pIncremental->uGeneration += 2;
+
+   iOldRoot = pIncremental->iRoot;
+   pIncremental->iRoot = COMPACT_PATH_INCREMENTAL_NO_NODE;
+   pIncremental->iFirstChange = pIncremental->iPoints;
+
+   iNumCallsInStack = 0;
+   if (pIncremental->iPoints >= 3)
+      {
+      call.iStart = 0;
+      call.iEnd = iLast;
+      call.iOldNode = COMPACT_PATH_INCREMENTAL_NO_NODE;
+      call.iParent = COMPACT_PATH_INCREMENTAL_NO_NODE;
+      call.iSide = 0;
+      pIncremental->pCalls[iNumCallsInStack] = call;
+      ++iNumCallsInStack;
+      }
+
+   while (iNumCallsInStack > 0)
+      {
+      --iNumCallsInStack;
+      call = pIncremental->pCalls[iNumCallsInStack];
+
+      if (call.iEnd - call.iStart < 2)
+         {
+         continue;
+         }
+
+      // Look for the old node that divided this same run, going down from the deepest one known
+      // to cover it. If there isn't one, iOld ends up at the deepest one that covers the run, if
+      // any, which is where the sides of the run will start looking.
+      iOld = call.iOldNode != COMPACT_PATH_INCREMENTAL_NO_NODE ? call.iOldNode : iOldRoot;
+      iMatch = COMPACT_PATH_INCREMENTAL_NO_NODE;
+      if (iOld != COMPACT_PATH_INCREMENTAL_NO_NODE &&
+          (pIncremental->pNodes[iOld].iStart > call.iStart ||
+           pIncremental->pNodes[iOld].iEnd < call.iEnd))
+         {
+         iOld = COMPACT_PATH_INCREMENTAL_NO_NODE;
+         }
+      while (iOld != COMPACT_PATH_INCREMENTAL_NO_NODE)
+         {
+         pNode = pIncremental->pNodes + iOld;
+         if (pNode->iStart == call.iStart && pNode->iEnd == call.iEnd)
+            {
+            iMatch = iOld;
+            break;
+            }
+
+         iNext = COMPACT_PATH_INCREMENTAL_NO_NODE;
+         if (call.iEnd <= pNode->iDivision)
+            {
+            iNext = pNode->iLeft;
+            }
+         else if (call.iStart >= pNode->iDivision)
+            {
+            iNext = pNode->iRight;
+            }
+         if (iNext == COMPACT_PATH_INCREMENTAL_NO_NODE)
+            {
+            break;
+            }
+         iOld = iNext;
+         }
+
+      if (iMatch != COMPACT_PATH_INCREMENTAL_NO_NODE &&
+          (call.iEnd < iFirstDirty || call.iStart > iLastDirty))
+         {
+         // None of the run's points have changed, so it divides the same way all the way down.
+         pIncremental->pNodes[iMatch].uGeneration = pIncremental->uGeneration + 1;
+         compactPathIncrementalLink(pIncremental, &call, iMatch);
+         continue;
+         }
+
+      iDivisionIndex = pIncremental->rangeScan(&pIncremental->tree, (unsigned int)call.iStart,
+                                               call.iEnd - call.iStart + 1,
+                                               &dMaxSquareDeviation);
+
+      if (dMaxSquareDeviation < dSquareEpsilon || iDivisionIndex <= 0)
+         {
+         continue;
+         }
+
+      iNode = pIncremental->iFreeNode;
+      pNode = pIncremental->pNodes + iNode;
+      pIncremental->iFreeNode = pNode->iLeft;
+      ++pIncremental->iLiveNodes;
+
+      pNode->iStart = call.iStart;
+      pNode->iEnd = call.iEnd;
+      pNode->iDivision = call.iStart + iDivisionIndex;
+      pNode->iLeft = COMPACT_PATH_INCREMENTAL_NO_NODE;
+      pNode->iRight = COMPACT_PATH_INCREMENTAL_NO_NODE;
+      pNode->uGeneration = pIncremental->uGeneration;
+      compactPathIncrementalLink(pIncremental, &call, iNode);
+
+      // New divisions are marked with a 2 until the old ones have been let go.
+      if (pKeepFlags[pNode->iDivision] == 0)
+         {
+         compactPathIncrementalNoteChange(pIncremental, pNode->iDivision);
+         }
+      pKeepFlags[pNode->iDivision] = 2;
+
+      call.iOldNode = iOld;
+      call.iParent = iNode;
+      call.iStart = pNode->iDivision;
+      call.iEnd = pNode->iEnd;
+      call.iSide = 1;
+      pIncremental->pCalls[iNumCallsInStack] = call;
+      ++iNumCallsInStack;
+
+      call.iStart = pNode->iStart;
+      call.iEnd = pNode->iDivision;
+      call.iSide = 0;
+      pIncremental->pCalls[iNumCallsInStack] = call;
+      ++iNumCallsInStack;
+      }
+
+   // Let go of the old divisions that weren't reused.
+   if (iOldRoot != COMPACT_PATH_INCREMENTAL_NO_NODE)
+      {
+      compactPathIncrementalPushNode(pIncremental, &iNumCallsInStack, iOldRoot);
+      }
+   while (iNumCallsInStack > 0)
+      {
+      --iNumCallsInStack;
+      iNode = pIncremental->pCalls[iNumCallsInStack].iOldNode;
+      pNode = pIncremental->pNodes + iNode;
+
+      if (pNode->uGeneration == pIncremental->uGeneration + 1)
+         {
+         continue;
+         }
+
+      if (pKeepFlags[pNode->iDivision] == 1)
+         {
+         pKeepFlags[pNode->iDivision] = 0;
+         compactPathIncrementalNoteChange(pIncremental, pNode->iDivision);
+         }
+
+      if (pNode->iLeft != COMPACT_PATH_INCREMENTAL_NO_NODE)
+         {
+         compactPathIncrementalPushNode(pIncremental, &iNumCallsInStack, pNode->iLeft);
+         }
+      if (pNode->iRight != COMPACT_PATH_INCREMENTAL_NO_NODE)
+         {
+         compactPathIncrementalPushNode(pIncremental, &iNumCallsInStack, pNode->iRight);
+         }
+
+      pNode->iLeft = pIncremental->iFreeNode;
+      pIncremental->iFreeNode = iNode;
+      --pIncremental->iLiveNodes;
+      }
+
+   // After an append, the old last point is an intermediate point like any other.
+   if (iOldLast >= 0 && iOldLast != iLast && pKeepFlags[iOldLast] == 1)
+      {
+      pKeepFlags[iOldLast] = 0;
+      compactPathIncrementalNoteChange(pIncremental, iOldLast);
+      }
+
+   if (pIncremental->iPoints > 0)
+      {
+      if (pKeepFlags[0] == 0)
+         {
+         pKeepFlags[0] = 1;
+         compactPathIncrementalNoteChange(pIncremental, 0);
+         }
+      if (pKeepFlags[iLast] == 0)
+         {
+         pKeepFlags[iLast] = 1;
+         compactPathIncrementalNoteChange(pIncremental, iLast);
+         }
+      }
+
+   // The new nodes are the top of the new tree, down to the reused subtrees.
+   if (pIncremental->iRoot != COMPACT_PATH_INCREMENTAL_NO_NODE &&
+       pIncremental->pNodes[pIncremental->iRoot].uGeneration == pIncremental->uGeneration)
+      {
+      compactPathIncrementalPushNode(pIncremental, &iNumCallsInStack, pIncremental->iRoot);
+      }
+   while (iNumCallsInStack > 0)
+      {
+      --iNumCallsInStack;
+      pNode = pIncremental->pNodes + pIncremental->pCalls[iNumCallsInStack].iOldNode;
+      pKeepFlags[pNode->iDivision] = 1;
+
+      if (pNode->iLeft != COMPACT_PATH_INCREMENTAL_NO_NODE &&
+          pIncremental->pNodes[pNode->iLeft].uGeneration == pIncremental->uGeneration)
+         {
+         compactPathIncrementalPushNode(pIncremental, &iNumCallsInStack, pNode->iLeft);
+         }
+      if (pNode->iRight != COMPACT_PATH_INCREMENTAL_NO_NODE &&
+          pIncremental->pNodes[pNode->iRight].uGeneration == pIncremental->uGeneration)
+         {
+         compactPathIncrementalPushNode(pIncremental, &iNumCallsInStack, pNode->iRight);
+         }
+      }
+   }
+
+PathCompacterIncremental *compactPathIncrementalCreate(double dEpsilon,
+                                                       DeviationMetric deviationMetric)
+   {
+   PathCompacterIncremental *pIncremental;
+
+   if (!(dEpsilon >= 0.0) || deviationMetric == NULL)
+      {
+      return NULL;
+      }
+
+   pIncremental = (PathCompacterIncremental *)malloc(sizeof(PathCompacterIncremental));
+   if (pIncremental == NULL)
+      {
+      return NULL;
+      }
+
+   pIncremental->pPointArray = NULL;
+   pIncremental->pKeepFlags = NULL;
+   pIncremental->iPoints = 0;
+   pIncremental->iCapacity = 0;
+   pIncremental->dEpsilon = dEpsilon;
+   pIncremental->tree.pPointArray = NULL;
+   pIncremental->tree.iPoints = 0;
+   pIncremental->tree.pNodes = NULL;
+   pIncremental->tree.maxDeviationScan = compactPathSelectMaxDeviationScan(deviationMetric);
+   pIncremental->tree.deviationMetric = deviationMetric;
+   pIncremental->rangeScan = deviationMetric == perpendicularDistanceDeviationMetric ?
+                             compactPathHullRangeScan : compactPathIncrementalScan;
+   pIncremental->pNodes = NULL;
+   pIncremental->iNodeCapacity = 0;
+   pIncremental->iLiveNodes = 0;
+   pIncremental->iFreeNode = COMPACT_PATH_INCREMENTAL_NO_NODE;
+   pIncremental->iRoot = COMPACT_PATH_INCREMENTAL_NO_NODE;
+   pIncremental->uGeneration = 0;
+   pIncremental->pCalls = NULL;
+   pIncremental->iFirstChange = 0;
+
+   if (!compactPathIncrementalReserve(pIncremental, COMPACT_PATH_INCREMENTAL_MIN_CAPACITY) ||
+       !compactPathIncrementalReserveNodes(pIncremental, COMPACT_PATH_INCREMENTAL_MIN_CAPACITY))
+      {
+      compactPathIncrementalDestroy(pIncremental);
+      return NULL;
+      }
+
+   return pIncremental;
+   }
+
+void compactPathIncrementalDestroy(PathCompacterIncremental *pIncremental)
+   {
+   if (pIncremental != NULL)
+      {
+      free(pIncremental->pPointArray);
+      free(pIncremental->pKeepFlags);
+      free(pIncremental->tree.pNodes);
+      free(pIncremental->pNodes);
+      free(pIncremental->pCalls);
+      free(pIncremental);
+      }
+   }
+
+int compactPathIncrementalAppend(PathCompacterIncremental *pIncremental,
+                                 const DVector2D *pPointArray, unsigned int uPoints)
+   {
+   int iOldLast;
+
+   if (uPoints == 0)
+      {
+      pIncremental->iFirstChange = pIncremental->iPoints;
+      return SUCCESS;
+      }
+
+   if (pPointArray == NULL || uPoints > (unsigned int)(INT_MAX - pIncremental->iPoints))
+      {
+      return FAILURE;
+      }
+
+   // Everything that can fail happens before the path changes.
+   if (!compactPathIncrementalReserve(pIncremental, pIncremental->iPoints + (int)uPoints) ||
+       !compactPathIncrementalReserveNodes(pIncremental, pIncremental->iPoints + (int)uPoints))
+      {
+      return FAILURE;
+      }
+
+   memcpy(pIncremental->pPointArray + pIncremental->iPoints, pPointArray,
+          sizeof(DVector2D) * uPoints);
+
+   if (pIncremental->tree.pNodes != NULL)
+      {
+      compactPathHullUpdate(&pIncremental->tree, 0, 0, pIncremental->tree.iPoints,
+                            pIncremental->iPoints, pIncremental->iPoints + (int)uPoints - 1);
+      }
+
+   iOldLast = pIncremental->iPoints - 1;
+   pIncremental->iPoints += (int)uPoints;
+
+   compactPathIncrementalUpdate(pIncremental, iOldLast + 1, pIncremental->iPoints - 1, iOldLast);
+
+   return SUCCESS;
+   }
+
+int compactPathIncrementalReplace(PathCompacterIncremental *pIncremental, unsigned int uFirstPoint,
+                                  const DVector2D *pPointArray, unsigned int uPoints)
+   {
+   int i, iFirst, iLast;
+
+   if (uPoints == 0)
+      {
+      pIncremental->iFirstChange = pIncremental->iPoints;
+      return SUCCESS;
+      }
+
+   if (pPointArray == NULL || uFirstPoint > (unsigned int)pIncremental->iPoints ||
+       uPoints > (unsigned int)pIncremental->iPoints - uFirstPoint)
+      {
+      return FAILURE;
+      }
+
+   if (!compactPathIncrementalReserveNodes(pIncremental, pIncremental->iPoints))
+      {
+      return FAILURE;
+      }
+
+   iFirst = (int)uFirstPoint;
+   iLast = iFirst + (int)uPoints - 1;
+
+   memcpy(pIncremental->pPointArray + iFirst, pPointArray, sizeof(DVector2D) * uPoints);
+
+   if (pIncremental->tree.pNodes != NULL)
+      {
+      compactPathHullUpdate(&pIncremental->tree, 0, 0, pIncremental->tree.iPoints, iFirst, iLast);
+      }
+
+   compactPathIncrementalUpdate(pIncremental, iFirst, iLast, pIncremental->iPoints - 1);
+
+   // A kept point that moved changes the result even if it is still kept.
+   for (i = iFirst; i <= iLast; ++i)
+      {
+      if (pIncremental->pKeepFlags[i])
+         {
+         compactPathIncrementalNoteChange(pIncremental, i);
+         break;
+         }
+      }
+
+   return SUCCESS;
+   }
+
+unsigned int compactPathIncrementalPointCount(const PathCompacterIncremental *pIncremental)
+   {
+   return (unsigned int)pIncremental->iPoints;
+   }
+
+unsigned int compactPathIncrementalFirstChange(const PathCompacterIncremental *pIncremental)
+   {
+   return (unsigned int)pIncremental->iFirstChange;
+   }
+
+int compactPathIncrementalKeptIndices(const PathCompacterIncremental *pIncremental,
+                                      unsigned int uFromPoint, uint32_t *puKeptIndices,
+                                      unsigned int *puPointsInResultPath)
+   {
+   unsigned int u, uNumKept;
+
+   if (puKeptIndices == NULL || puPointsInResultPath == NULL)
+      {
+      return FAILURE;
+      }
+
+   uNumKept = 0;
+   for (u = uFromPoint; u < (unsigned int)pIncremental->iPoints; ++u)
+      {
+      if (pIncremental->pKeepFlags[u])
+         {
+         puKeptIndices[uNumKept] = u;
+         ++uNumKept;
+         }
+      }
+
+   *puPointsInResultPath = uNumKept;
+
+   return SUCCESS;
+   }
@@ -0,0 +1,427 @@
+/*
+   PathCompacterIndex.c
+   10/15/2026
+   Authors: Michael Casebolt, Brett Casebolt
+*/
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Michael Casebolt and Brett Casebolt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// This file uses lines up to 100 characters long. If this 100 character line fits then you're good.
+
+#include "PathCompacter.h"
+
+#include <stdlib.h> // For memory management and qsort
+#include <string.h> // For memcpy
+#include <math.h> // For HUGE_VAL
+
+#define FAILURE 0
+#define SUCCESS 1
+
+// The serialized form starts with these, followed by the number of points and the number of
+// ranked vertices. Then come the significances of the ranked vertices and their indices, both in
+// rank order. Everything is little endian, and the significances are IEEE 754 doubles.
+#define COMPACT_PATH_INDEX_MAGIC 0x58494350 // "PCIX"
+#define COMPACT_PATH_INDEX_VERSION 1
+#define COMPACT_PATH_INDEX_HEADER_BYTES 16
+#define COMPACT_PATH_INDEX_BYTES_PER_VERTEX 12
+
+// compactPathIndexExtract sorts the kept indices when there are fewer of them than the path has
+// points divided by this, and otherwise flags them in an array as long as the path and reads them
+// back in order. Either way, its scratch memory is in proportion to the number of kept points.
+#define COMPACT_PATH_INDEX_SPARSE_RATIO 16
+
+// Only the ranked vertices are stored, so an index takes memory in proportion to the number of
+// points it can ever keep rather than to the length of the path. Everything else has a
+// significance of zero, apart from the endpoints, which are always kept.
+struct PathCompacterIndex
+   {
+   unsigned int uPoints;
+   unsigned int uRankedVertices;
+   double *pdRankedSignificance;
+   uint32_t *puRankedIndices;
+   };
+
+static int compactPathIndexCompareIndices(const void *pA, const void *pB)
+   {
+   uint32_t uA, uB;
+
+   uA = *(const uint32_t *)pA;
+   uB = *(const uint32_t *)pB;
+
+   return (uA > uB) - (uA < uB);
+   }
+
+static PathCompacterIndex *compactPathIndexAllocate(unsigned int uPoints,
+                                                    unsigned int uRankedVertices)
+   {
+   PathCompacterIndex *pIndex;
+
+   pIndex = (PathCompacterIndex *)malloc(sizeof(PathCompacterIndex));
+   if (pIndex == NULL)
+      {
+      return NULL;
+      }
+
+   pIndex->uPoints = uPoints;
+   pIndex->uRankedVertices = uRankedVertices;
+
+   // Allocate at least one entry so that an empty ranking doesn't look like a failure.
+   pIndex->pdRankedSignificance = (double *)malloc(sizeof(double) * ((size_t)uRankedVertices + 1));
+   pIndex->puRankedIndices = (uint32_t *)malloc(sizeof(uint32_t) * ((size_t)uRankedVertices + 1));
+   if (pIndex->pdRankedSignificance == NULL || pIndex->puRankedIndices == NULL)
+      {
+      compactPathIndexDestroy(pIndex);
+      return NULL;
+      }
+
+   return pIndex;
+   }
+
+PathCompacterIndex *compactPathIndexBuild(const DVector2D *pPointArray,
+                                          unsigned int uPointsInCurrentPath,
+                                          DeviationMetric deviationMetric)
+   {
+   PathCompacterIndex *pIndex;
+   double *pdSignificance;
+   uint32_t *puRankedIndices;
+   unsigned int u, uRankedVertices;
+
+   // Check for invalid values.
+   if (uPointsInCurrentPath == 0xffffffff || pPointArray == NULL || deviationMetric == NULL)
+      {
+      return NULL;
+      }
+
+   // The ranking needs an entry for every point while it is being worked out, but only the ranked
+   // vertices are kept afterwards.
+   pdSignificance = (double *)malloc(sizeof(double) * ((size_t)uPointsInCurrentPath + 1));
+   puRankedIndices = (uint32_t *)malloc(sizeof(uint32_t) * ((size_t)uPointsInCurrentPath + 1));
+   if (pdSignificance == NULL || puRankedIndices == NULL ||
+       !compactPathRankVertices(pPointArray, uPointsInCurrentPath, pdSignificance,
+                                puRankedIndices, &uRankedVertices, deviationMetric))
+      {
+      free(pdSignificance);
+      free(puRankedIndices);
+      return NULL;
+      }
+
+   pIndex = compactPathIndexAllocate(uPointsInCurrentPath, uRankedVertices);
+   if (pIndex != NULL)
+      {
+      for (u = 0; u < uRankedVertices; ++u)
+         {
+         pIndex->pdRankedSignificance[u] = pdSignificance[puRankedIndices[u]];
+         pIndex->puRankedIndices[u] = puRankedIndices[u];
+         }
+      }
+
+   free(pdSignificance);
+   free(puRankedIndices);
+
+   return pIndex;
+   }
+
+void compactPathIndexDestroy(PathCompacterIndex *pIndex)
+   {
+   if (pIndex != NULL)
+      {
+      free(pIndex->pdRankedSignificance);
+      free(pIndex->puRankedIndices);
+      free(pIndex);
+      }
+   }
+
+unsigned int compactPathIndexPoints(const PathCompacterIndex *pIndex)
+   {
+   return pIndex->uPoints;
+   }
+
+unsigned int compactPathIndexPointsForEpsilon(const PathCompacterIndex *pIndex, double dEpsilon)
+   {
+   unsigned int uLow, uHigh, uMiddle;
+   double dSquareEpsilon, dSignificance;
+
+   if (pIndex->uPoints < 3)
+      {
+      return pIndex->uPoints;
+      }
+
+   dSquareEpsilon = dEpsilon * dEpsilon;
+
+   // The ranked vertices are in order of decreasing significance, so the ones that survive are a
+   // prefix. Find its length.
+   uLow = 0;
+   uHigh = pIndex->uRankedVertices;
+   while (uLow < uHigh)
+      {
+      uMiddle = uLow + (uHigh - uLow) / 2;
+      dSignificance = pIndex->pdRankedSignificance[uMiddle];
+      if (dSignificance > 0.0 && dSignificance >= dSquareEpsilon)
+         {
+         uLow = uMiddle + 1;
+         }
+      else
+         {
+         uHigh = uMiddle;
+         }
+      }
+
+   return uLow + 2;
+   }
+
+int compactPathIndexExtract(const PathCompacterIndex *pIndex, double dEpsilon,
+                            uint32_t *puKeptIndices, unsigned int *puPointsInResultPath)
+   {
+   unsigned char *pKeepFlags;
+   unsigned int u, uFromRanking, uNumKept;
+
+   if (!(dEpsilon >= 0.0))
+      {
+      return FAILURE;
+      }
+
+   // The kept points are the endpoints and a prefix of the ranking, so this is the top k for the
+   // right k. Sorting a few of them beats reading through a long path.
+   uNumKept = compactPathIndexPointsForEpsilon(pIndex, dEpsilon);
+   if (pIndex->uPoints < 3 || uNumKept < pIndex->uPoints / COMPACT_PATH_INDEX_SPARSE_RATIO)
+      {
+      return compactPathSelectTopK(pIndex->puRankedIndices, pIndex->uRankedVertices,
+                                   pIndex->uPoints, uNumKept, puKeptIndices,
+                                   puPointsInResultPath);
+      }
+
+   // There are enough of them that flagging them and reading them back in order is faster.
+   pKeepFlags = (unsigned char *)calloc(pIndex->uPoints, sizeof(unsigned char));
+   if (pKeepFlags == NULL)
+      {
+      return FAILURE;
+      }
+
+   uFromRanking = uNumKept - 2;
+   pKeepFlags[0] = 1;
+   pKeepFlags[pIndex->uPoints - 1] = 1;
+   for (u = 0; u < uFromRanking; ++u)
+      {
+      pKeepFlags[pIndex->puRankedIndices[u]] = 1;
+      }
+
+   uNumKept = 0;
+   for (u = 0; u < pIndex->uPoints; ++u)
+      {
+      if (pKeepFlags[u])
+         {
+         puKeptIndices[uNumKept] = u;
+         ++uNumKept;
+         }
+      }
+
+   free(pKeepFlags);
+
+   *puPointsInResultPath = uNumKept;
+
+   return SUCCESS;
+   }
+
+int compactPathIndexExtractTopK(const PathCompacterIndex *pIndex, unsigned int uMaxPoints,
+                                uint32_t *puKeptIndices, unsigned int *puPointsInResultPath)
+   {
+   return compactPathSelectTopK(pIndex->puRankedIndices, pIndex->uRankedVertices,
+                                pIndex->uPoints, uMaxPoints, puKeptIndices,
+                                puPointsInResultPath);
+   }
+
+static void compactPathIndexWrite32(unsigned char *pBytes, uint32_t uValue)
+   {
+   int i;
+
+   for (i = 0; i < 4; ++i)
+      {
+      pBytes[i] = (unsigned char)(uValue >> (8 * i));
+      }
+   }
+
+static uint32_t compactPathIndexRead32(const unsigned char *pBytes)
+   {
+   uint32_t uValue;
+   int i;
+
+   uValue = 0;
+   for (i = 0; i < 4; ++i)
+      {
+      uValue |= (uint32_t)pBytes[i] << (8 * i);
+      }
+
+   return uValue;
+   }
+
+static void compactPathIndexWriteDouble(unsigned char *pBytes, double dValue)
+   {
+   uint64_t uBits;
+   int i;
+
+   memcpy(&uBits, &dValue, sizeof(uBits));
+   for (i = 0; i < 8; ++i)
+      {
+      pBytes[i] = (unsigned char)(uBits >> (8 * i));
+      }
+   }
+
+static double compactPathIndexReadDouble(const unsigned char *pBytes)
+   {
+   uint64_t uBits;
+   double dValue;
+   int i;
+
+   uBits = 0;
+   for (i = 0; i < 8; ++i)
+      {
+      uBits |= (uint64_t)pBytes[i] << (8 * i);
+      }
+   memcpy(&dValue, &uBits, sizeof(dValue));
+
+   return dValue;
+   }
+
+size_t compactPathIndexSerializedSize(const PathCompacterIndex *pIndex)
+   {
+   return COMPACT_PATH_INDEX_HEADER_BYTES +
+      (size_t)COMPACT_PATH_INDEX_BYTES_PER_VERTEX * pIndex->uRankedVertices;
+   }
+
+size_t compactPathIndexSerialize(const PathCompacterIndex *pIndex, void *pBuffer,
+                                 size_t uBufferBytes)
+   {
+   unsigned char *pBytes;
+   unsigned int u;
+   size_t uBytes;
+
+   uBytes = compactPathIndexSerializedSize(pIndex);
+   if (uBufferBytes < uBytes)
+      {
+      return 0;
+      }
+
+   pBytes = (unsigned char *)pBuffer;
+   compactPathIndexWrite32(pBytes, COMPACT_PATH_INDEX_MAGIC);
+   compactPathIndexWrite32(pBytes + 4, COMPACT_PATH_INDEX_VERSION);
+   compactPathIndexWrite32(pBytes + 8, pIndex->uPoints);
+   compactPathIndexWrite32(pBytes + 12, pIndex->uRankedVertices);
+   pBytes += COMPACT_PATH_INDEX_HEADER_BYTES;
+
+   for (u = 0; u < pIndex->uRankedVertices; ++u)
+      {
+      compactPathIndexWriteDouble(pBytes, pIndex->pdRankedSignificance[u]);
+      pBytes += 8;
+      }
+   for (u = 0; u < pIndex->uRankedVertices; ++u)
+      {
+      compactPathIndexWrite32(pBytes, pIndex->puRankedIndices[u]);
+      pBytes += 4;
+      }
+
+   return uBytes;
+   }
+
+PathCompacterIndex *compactPathIndexDeserialize(const void *pBuffer, size_t uBufferBytes)
+   {
+   PathCompacterIndex *pIndex;
+   const unsigned char *pBytes, *pSignificances, *pIndices;
+   unsigned int u, uPoints, uRankedVertices;
+   uint32_t *puSortedIndices;
+   double dSignificance, dPreviousSignificance;
+
+   pBytes = (const unsigned char *)pBuffer;
+
+   if (uBufferBytes < COMPACT_PATH_INDEX_HEADER_BYTES ||
+       compactPathIndexRead32(pBytes) != COMPACT_PATH_INDEX_MAGIC ||
+       compactPathIndexRead32(pBytes + 4) != COMPACT_PATH_INDEX_VERSION)
+      {
+      return NULL;
+      }
+
+   uPoints = compactPathIndexRead32(pBytes + 8);
+   uRankedVertices = compactPathIndexRead32(pBytes + 12);
+
+   // Only intermediate points can be ranked, and the buffer has to hold all of them. The number
+   // of points isn't limited by the size of the buffer, since a long straight path has nothing
+   // ranked, so nothing here gets allocated in proportion to it.
+   if (uPoints == 0xffffffff || (uPoints < 3 && uRankedVertices > 0) ||
+       (uPoints >= 3 && uRankedVertices > uPoints - 2) ||
+       (uBufferBytes - COMPACT_PATH_INDEX_HEADER_BYTES) / COMPACT_PATH_INDEX_BYTES_PER_VERTEX <
+          uRankedVertices)
+      {
+      return NULL;
+      }
+
+   pIndex = compactPathIndexAllocate(uPoints, uRankedVertices);
+   if (pIndex == NULL)
+      {
+      return NULL;
+      }
+
+   pSignificances = pBytes + COMPACT_PATH_INDEX_HEADER_BYTES;
+   pIndices = pSignificances + (size_t)8 * uRankedVertices;
+   dPreviousSignificance = HUGE_VAL;
+
+   // Everything else relies on the ranking being in order and every ranked vertex being a
+   // distinct intermediate point, so don't take a corrupt buffer's word for it.
+   for (u = 0; u < uRankedVertices; ++u)
+      {
+      dSignificance = compactPathIndexReadDouble(pSignificances + (size_t)8 * u);
+      pIndex->pdRankedSignificance[u] = dSignificance;
+      pIndex->puRankedIndices[u] = compactPathIndexRead32(pIndices + (size_t)4 * u);
+
+      if (!(dSignificance > 0.0 && dSignificance <= dPreviousSignificance) ||
+          pIndex->puRankedIndices[u] == 0 || pIndex->puRankedIndices[u] >= uPoints - 1)
+         {
+         compactPathIndexDestroy(pIndex);
+         return NULL;
+         }
+
+      dPreviousSignificance = dSignificance;
+      }
+
+   // Sort a copy of the ranked vertices to find any that are there twice.
+   puSortedIndices = (uint32_t *)malloc(sizeof(uint32_t) * ((size_t)uRankedVertices + 1));
+   if (puSortedIndices == NULL)
+      {
+      compactPathIndexDestroy(pIndex);
+      return NULL;
+      }
+   memcpy(puSortedIndices, pIndex->puRankedIndices, sizeof(uint32_t) * uRankedVertices);
+   qsort(puSortedIndices, uRankedVertices, sizeof(uint32_t), compactPathIndexCompareIndices);
+   for (u = 1; u < uRankedVertices; ++u)
+      {
+      if (puSortedIndices[u] == puSortedIndices[u - 1])
+         {
+         free(puSortedIndices);
+         compactPathIndexDestroy(pIndex);
+         return NULL;
+         }
+      }
+   free(puSortedIndices);
+
+   return pIndex;
+   }
@@ -0,0 +1,204 @@
+/*
+   PathCompacterIndices.c
+   10/15/2026
+   Authors: Michael Casebolt, Brett Casebolt
+*/
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Michael Casebolt and Brett Casebolt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// This file uses lines up to 100 characters long. If this 100 character line fits then you're good.
+
+#include "PathCompacter.h"
+#include "PathCompacterInternal.h"
+
+#include <limits.h> // For INT_MAX
+#include <string.h> // For memset
+
+#define FAILURE 0
+#define SUCCESS 1
+
+// This lets compactPathKeptIndices go through the same traversal as the other point layouts.
+typedef struct CompactPathVectorPath
+   {
+   const DVector2D *pPointArray;
+   CompactPathMaxDeviationScan maxDeviationScan;
+   DeviationMetric deviationMetric;
+   } CompactPathVectorPath;
+
+static int compactPathVectorRangeScan(const void *pPath, unsigned int uStart,
+                                      int iPointsInCurrentPath, double *pdMaxSquareDeviation)
+   {
+   const CompactPathVectorPath *pVectorPath;
+
+   pVectorPath = (const CompactPathVectorPath *)pPath;
+
+   return pVectorPath->maxDeviationScan(pVectorPath->pPointArray + uStart, iPointsInCurrentPath,
+                                        pVectorPath->deviationMetric, pdMaxSquareDeviation);
+   }
+
+int compactPathKeptIndicesWithRangeScan(const void *pPath, unsigned int uPointsInCurrentPath,
+                                        uint32_t *puKeptIndices,
+                                        unsigned int *puPointsInResultPath, double dEpsilon,
+                                        CompactPathRangeScan rangeScan)
+   {
+   unsigned int u, uNumKept, uStackTop, uStart, uEnd;
+   double dMaxSquareDeviation;
+   int iDivisionIndex;
+
+   // Check for invalid values. The callers check their own points and metric.
+   if (uPointsInCurrentPath > INT_MAX || puKeptIndices == NULL || puPointsInResultPath == NULL ||
+       !(dEpsilon >= 0.0) || rangeScan == NULL)
+      {
+      return FAILURE;
+      }
+
+   // Paths with fewer than three points are already solved.
+   if (uPointsInCurrentPath < 3)
+      {
+      for (u = 0; u < uPointsInCurrentPath; ++u)
+         {
+         puKeptIndices[u] = u;
+         }
+      *puPointsInResultPath = uPointsInCurrentPath;
+      return SUCCESS;
+      }
+
+   // This always finishes the left side of a division before the right side, so the kept points
+   // come out in order. The end points of the right sides that are still waiting are stacked up
+   // at the back of puKeptIndices. Every one of them is a kept point that hasn't been written yet,
+   // so the stack and the indices written so far can never run into each other.
+   uNumKept = 0;
+   uStackTop = uPointsInCurrentPath;
+   puKeptIndices[uNumKept] = 0;
+   ++uNumKept;
+   uStart = 0;
+   uEnd = uPointsInCurrentPath - 1;
+
+   for (;;)
+      {
+      if (uEnd - uStart >= 2)
+         {
+         iDivisionIndex = rangeScan(pPath, uStart, (int)(uEnd - uStart + 1),
+                                    &dMaxSquareDeviation);
+
+         if (!(dMaxSquareDeviation < dEpsilon * dEpsilon) && iDivisionIndex > 0)
+            {
+            --uStackTop;
+            puKeptIndices[uStackTop] = uEnd;
+            uEnd = uStart + (unsigned int)iDivisionIndex;
+            continue;
+            }
+         }
+
+      // This side is linearized, so its end point is the next kept point.
+      puKeptIndices[uNumKept] = uEnd;
+      ++uNumKept;
+
+      if (uStackTop == uPointsInCurrentPath)
+         {
+         break;
+         }
+
+      uStart = uEnd;
+      uEnd = puKeptIndices[uStackTop];
+      ++uStackTop;
+      }
+
+   *puPointsInResultPath = uNumKept;
+
+   return SUCCESS;
+   }
+
+int compactPathKeptIndices(const DVector2D *pPointArray, unsigned int uPointsInCurrentPath,
+                           uint32_t *puKeptIndices, unsigned int *puPointsInResultPath,
+                           double dEpsilon, DeviationMetric deviationMetric)
+   {
+   CompactPathVectorPath vectorPath;
+
+   if (pPointArray == NULL || deviationMetric == NULL)
+      {
+      return FAILURE;
+      }
+
+   vectorPath.pPointArray = pPointArray;
+   vectorPath.maxDeviationScan = compactPathSelectMaxDeviationScan(deviationMetric);
+   vectorPath.deviationMetric = deviationMetric;
+
+   return compactPathKeptIndicesWithRangeScan(&vectorPath, uPointsInCurrentPath, puKeptIndices,
+                                              puPointsInResultPath, dEpsilon,
+                                              compactPathVectorRangeScan);
+   }
+
+int compactPathKeepBitmap(const DVector2D *pPointArray, unsigned int uPointsInCurrentPath,
+                          unsigned char *pKeepBitmap, unsigned int *puPointsInResultPath,
+                          double dEpsilon, DeviationMetric deviationMetric)
+   {
+   unsigned int u, uBytes, uNumKept;
+   unsigned char byte;
+
+   // Check for invalid values.
+   if (uPointsInCurrentPath > INT_MAX || pPointArray == NULL || pKeepBitmap == NULL ||
+       puPointsInResultPath == NULL || !(dEpsilon >= 0.0) || deviationMetric == NULL)
+      {
+      return FAILURE;
+      }
+
+   uBytes = (uPointsInCurrentPath + 7) / 8;
+   memset(pKeepBitmap, 0, uBytes);
+
+   if (uPointsInCurrentPath == 0)
+      {
+      *puPointsInResultPath = 0;
+      return SUCCESS;
+      }
+
+   pKeepBitmap[0] |= 1;
+   pKeepBitmap[(uPointsInCurrentPath - 1) >> 3] |=
+      (unsigned char)(1 << ((uPointsInCurrentPath - 1) & 7));
+
+   if (uPointsInCurrentPath >= 3)
+      {
+      if (!compactPathMarkSubproblemBits(pPointArray, (int)uPointsInCurrentPath, pKeepBitmap,
+                                         dEpsilon,
+                                         compactPathSelectMaxDeviationScan(deviationMetric),
+                                         deviationMetric))
+         {
+         return FAILURE;
+         }
+      }
+
+   uNumKept = 0;
+   for (u = 0; u < uBytes; ++u)
+      {
+      for (byte = pKeepBitmap[u]; byte != 0; byte &= (unsigned char)(byte - 1))
+         {
+         ++uNumKept;
+         }
+      }
+
+   *puPointsInResultPath = uNumKept;
+
+   return SUCCESS;
+   }
@@ -0,0 +1,583 @@
+/*
+   PathCompacterInternal.h
+   10/15/2026
+   Authors: Michael Casebolt, Brett Casebolt
+*/
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Michael Casebolt and Brett Casebolt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// This file uses lines up to 100 characters long. If this 100 character line fits then you're good.
+
+// These declarations are shared between the compacter implementations. They are not part of the
+// public interface, so don't include this header from outside of the library.
+
+#ifndef PATH_COMPACTER_INTERNAL_HEADER_INCLUDED
+#define PATH_COMPACTER_INTERNAL_HEADER_INCLUDED
+
+#include "PathCompacter.h"
+
+#include <stddef.h> // For size_t
+#include <math.h> // For the geodesic metrics
+
+// Every compacter has to pick the same division point for the same subproblem, otherwise their
+// results would differ. They all go through a function like this one to find it.
+// Returns the index of the intermediate point with the largest deviation from the segment between
+// the first and last points, and passes that deviation back through pdMaxSquareDeviation.
+// Ties go to the lowest index. If no point has a deviation greater than zero, 0 is returned
+// (which is never a valid division index) and the deviation is 0.0.
+// The subproblem must have at least three points.
+typedef int (*CompactPathMaxDeviationScan)(const DVector2D * /*pPointArray*/,
+                                           int /*iPointsInCurrentPath*/,
+                                           DeviationMetric /*deviationMetric*/,
+                                           double * /*pdMaxSquareDeviation*/);
+
+// This is the generic scan. It calls deviationMetric once for every intermediate point.
+int compactPathFindMaxDeviation(const DVector2D *pPointArray, int iPointsInCurrentPath,
+                                DeviationMetric deviationMetric, double *pdMaxSquareDeviation);
+
+// This is the scan for a PathCompacterMetric. The result means the same as for the other scans.
+int compactPathFindMaxDeviationWithMetric(const DVector2D *pPointArray, int iPointsInCurrentPath,
+                                          const PathCompacterMetric *pMetric,
+                                          double *pdMaxSquareDeviation);
+
+// Returns the scan to use for deviationMetric. The built in metrics get scans that have the metric
+// inlined into the loop, vectorized for the best instruction set the processor supports.
+// Anything else gets compactPathFindMaxDeviation.
+// Call this once when a compaction starts rather than once per subproblem.
+CompactPathMaxDeviationScan compactPathSelectMaxDeviationScan(DeviationMetric deviationMetric);
+
+// The instruction sets that PathCompacterSimd.c has kernels for, from slowest to fastest.
+typedef enum CompactPathSimdLevel
+   {
+   COMPACT_PATH_SIMD_LEVEL_NONE,
+   COMPACT_PATH_SIMD_LEVEL_SSE2,
+   COMPACT_PATH_SIMD_LEVEL_AVX2,
+   COMPACT_PATH_SIMD_LEVEL_AVX512
+   } CompactPathSimdLevel;
+
+// Asks the processor which of the levels above it can run. It only asks on the first call, and
+// every call after that returns the same answer.
+CompactPathSimdLevel compactPathDetectSimdLevel(void);
+
+// Returns the vectorized scan for deviationMetric at the given level, or NULL if there isn't one.
+// The vectorized scans return bit-identical results to the scalar ones, including the tie-breaking,
+// as long as the library is built without floating point contraction (-ffp-contract=off).
+CompactPathMaxDeviationScan compactPathSelectSimdMaxDeviationScan(DeviationMetric deviationMetric,
+                                                                  CompactPathSimdLevel simdLevel);
+
+// These are the bodies of the built in metrics. DeviationMetrics.c wraps them in the callbacks and
+// inlines them into the specialized scans, so both always compute exactly the same values.
+
+// This one just returns the shortest distance to the infinite extension of the line segment.
+// When the endpoints are in the same place there is no line, and it measures the distance to the
+// start point instead of dividing by zero. That is what shortestDistanceToSegment does as well.
+static inline double compactPathPerpendicularDistance(const DVector2D *pStart,
+                                                      const DVector2D *pEnd,
+                                                      const DVector2D *pMid,
+                                                      double dSquareSegmentLength)
+   {
+   double dArea, dDX, dDY;
+
+   if (dSquareSegmentLength == 0.0)
+      {
+      dDX = pMid->dX - pStart->dX;
+      dDY = pMid->dY - pStart->dY;
+      return dDX * dDX + dDY * dDY;
+      }
+
+   dArea = pStart->dX * (pMid->dY - pEnd->dY) +
+                  pMid->dX * (pEnd->dY - pStart->dY) +
+                  pEnd->dX * (pStart->dY - pMid->dY);
+
+   return dArea * dArea / dSquareSegmentLength;
+   }
+
+static inline double compactPathShortestDistanceToSegment(const DVector2D *pStart,
+                                                          const DVector2D *pEnd,
+                                                          const DVector2D *pMid,
+                                                          double dSquareSegmentLength)
+   {
+   double dAX, dAY, dBX, dBY, dCX, dCY, dAdotB, dBdotC, dArea;
+
+   // The scans measure from the start point whenever the square segment length is zero, which
+   // can also happen for endpoints so close together that the square underflows.
+   if (dSquareSegmentLength == 0.0)
+      {
+      dBX = pMid->dX - pStart->dX;
+      dBY = pMid->dY - pStart->dY;
+      return dBX * dBX + dBY * dBY;
+      }
+
+   // Start->End forms vector A.
+   dAX = pEnd->dX - pStart->dX;
+   dAY = pEnd->dY - pStart->dY;
+
+   // Start->Mid forms vector B.
+   dBX = pMid->dX - pStart->dX;
+   dBY = pMid->dY - pStart->dY;
+
+   // End->Mid forms vector C;
+   dCX = pMid->dX - pEnd->dX;
+   dCY = pMid->dY - pEnd->dY;
+
+   // Find the dot product of A and B.
+   dAdotB = dAX * dBX + dAY * dBY;
+
+   // Find the dot product of B and C;
+   dBdotC = dBX * dCX + dBY * dCY;
+
+   // If the signs are different, the closest point on the segment is not an endpoint.
+   if (dAdotB > 0.0 && dBdotC < 0.0)
+      {
+      dArea = 0.5 * (pStart->dX * (pMid->dY - pEnd->dY) +
+                     pMid->dX * (pEnd->dY - pStart->dY) +
+                     pEnd->dX * (pStart->dY - pMid->dY));
+
+      return dArea * dArea / dSquareSegmentLength;
+      }
+
+   // Otherwise, figure out which endpoint it is closer to.
+   else
+      {
+      if (dAdotB < 0.0 && dBdotC < 0.0)
+         {
+         // It is closer to the start point.
+         return dAX * dAX + dAY * dAY;
+         }
+      else
+         {
+         // It is closer to the end point.
+         return dCX * dCX + dCY * dCY;
+         }
+      }
+   }
+
+// This is the scan for a degenerate chord, whose endpoints are in the same place. It finds the
+// intermediate point farthest from the start point, which is what both of the metrics above
+// measure in that case, so the specialized scans can skip their formulas entirely.
+static inline int compactPathFindMaxStartDistance(const DVector2D *pPointArray,
+                                                  int iPointsInCurrentPath,
+                                                  double *pdMaxSquareDeviation)
+   {
+   double dSquareDeviation, dMaxSquareDeviationInThisSegment, dDX, dDY;
+   int i, iMaxPointIndex;
+
+   dMaxSquareDeviationInThisSegment = 0.0;
+   iMaxPointIndex = 0;
+
+   for (i = 1; i < iPointsInCurrentPath - 1; ++i)
+      {
+      dDX = pPointArray[i].dX - pPointArray[0].dX;
+      dDY = pPointArray[i].dY - pPointArray[0].dY;
+      dSquareDeviation = dDX * dDX + dDY * dDY;
+
+      if (dSquareDeviation > dMaxSquareDeviationInThisSegment)
+         {
+         iMaxPointIndex = i;
+         dMaxSquareDeviationInThisSegment = dSquareDeviation;
+         }
+      }
+
+   *pdMaxSquareDeviation = dMaxSquareDeviationInThisSegment;
+   return iMaxPointIndex;
+   }
+
+// This stamps out a scan with metricBody inlined. metricBody has the signature of the inline
+// metrics above. The loop is the same as the one in compactPathFindMaxDeviation, except that
+// degenerate chords go to compactPathFindMaxStartDistance.
+#define COMPACT_PATH_DEFINE_MAX_DEVIATION_SCAN(scanName, metricBody)\
+   static int scanName(const DVector2D *pPointArray, int iPointsInCurrentPath,\
+                       DeviationMetric deviationMetric, double *pdMaxSquareDeviation)\
+      {\
+      const DVector2D *pStart, *pEnd;\
+      double dSquareSegLen, dSquareDeviation, dMaxSquareDeviationInThisSegment, dDX, dDY;\
+      int i, iMaxPointIndex;\
+      \
+      (void)deviationMetric;\
+      \
+      dMaxSquareDeviationInThisSegment = 0.0;\
+      iMaxPointIndex = 0;\
+      \
+      pStart = pPointArray;\
+      pEnd = pPointArray + iPointsInCurrentPath - 1;\
+      dDX = pEnd->dX - pStart->dX;\
+      dDY = pEnd->dY - pStart->dY;\
+      dSquareSegLen = dDX * dDX + dDY * dDY;\
+      \
+      if (dSquareSegLen == 0.0)\
+         {\
+         return compactPathFindMaxStartDistance(pPointArray, iPointsInCurrentPath,\
+                                                pdMaxSquareDeviation);\
+         }\
+      \
+      for (i = 1; i < iPointsInCurrentPath - 1; ++i)\
+         {\
+         dSquareDeviation = metricBody(pStart, pEnd, pPointArray + i, dSquareSegLen);\
+         \
+         if (dSquareDeviation > dMaxSquareDeviationInThisSegment)\
+            {\
+            iMaxPointIndex = i;\
+            dMaxSquareDeviationInThisSegment = dSquareDeviation;\
+            }\
+         }\
+      \
+      *pdMaxSquareDeviation = dMaxSquareDeviationInThisSegment;\
+      return iMaxPointIndex;\
+      }
+
+// The geodesic metrics take dX as the longitude and dY as the latitude, both in degrees, and return
+// square meters. Their chord terms cost trigonometry, so they are worked out once per subproblem
+// by a prepare function and kept in a chord structure, and the body only handles the point.
+
+#define COMPACT_PATH_RADIANS_PER_DEGREE (3.14159265358979323846 / 180.0)
+
+// The mean radius of the WGS84 ellipsoid, and its semi-major axis and flattening.
+#define COMPACT_PATH_EARTH_MEAN_RADIUS 6371008.8
+#define COMPACT_PATH_WGS84_SEMI_MAJOR_AXIS 6378137.0
+#define COMPACT_PATH_WGS84_FLATTENING (1.0 / 298.257223563)
+
+typedef struct CompactPathCrossTrackChord
+   {
+   // The unit normal of the plane of the great circle through the endpoints. If the endpoints are
+   // the same or antipodal there is no such circle, so this is the start point's unit vector
+   // instead and iDegenerate is set.
+   double dNX, dNY, dNZ;
+   int iDegenerate;
+   } CompactPathCrossTrackChord;
+
+static inline void compactPathUnitVector(const DVector2D *pPoint, double *pdX, double *pdY,
+                                         double *pdZ)
+   {
+   double dLongitude, dLatitude, dCosLatitude;
+
+   dLongitude = pPoint->dX * COMPACT_PATH_RADIANS_PER_DEGREE;
+   dLatitude = pPoint->dY * COMPACT_PATH_RADIANS_PER_DEGREE;
+   dCosLatitude = cos(dLatitude);
+
+   *pdX = dCosLatitude * cos(dLongitude);
+   *pdY = dCosLatitude * sin(dLongitude);
+   *pdZ = sin(dLatitude);
+   }
+
+static inline void compactPathCrossTrackPrepare(const DVector2D *pStart, const DVector2D *pEnd,
+                                                CompactPathCrossTrackChord *pChord)
+   {
+   double dAX, dAY, dAZ, dBX, dBY, dBZ, dNX, dNY, dNZ, dLength;
+
+   compactPathUnitVector(pStart, &dAX, &dAY, &dAZ);
+   compactPathUnitVector(pEnd, &dBX, &dBY, &dBZ);
+
+   dNX = dAY * dBZ - dAZ * dBY;
+   dNY = dAZ * dBX - dAX * dBZ;
+   dNZ = dAX * dBY - dAY * dBX;
+   dLength = sqrt(dNX * dNX + dNY * dNY + dNZ * dNZ);
+
+   if (dLength > 0.0)
+      {
+      pChord->dNX = dNX / dLength;
+      pChord->dNY = dNY / dLength;
+      pChord->dNZ = dNZ / dLength;
+      pChord->iDegenerate = 0;
+      }
+   else
+      {
+      pChord->dNX = dAX;
+      pChord->dNY = dAY;
+      pChord->dNZ = dAZ;
+      pChord->iDegenerate = 1;
+      }
+   }
+
+// This is the distance along the sphere from the great circle through the endpoints, or from the
+// start point if there is no such circle.
+static inline double compactPathCrossTrackDistance(const CompactPathCrossTrackChord *pChord,
+                                                   const DVector2D *pMid)
+   {
+   double dPX, dPY, dPZ, dCX, dCY, dCZ, dSine, dAngle;
+
+   compactPathUnitVector(pMid, &dPX, &dPY, &dPZ);
+
+   if (pChord->iDegenerate)
+      {
+      dCX = pChord->dNY * dPZ - pChord->dNZ * dPY;
+      dCY = pChord->dNZ * dPX - pChord->dNX * dPZ;
+      dCZ = pChord->dNX * dPY - pChord->dNY * dPX;
+      dAngle = atan2(sqrt(dCX * dCX + dCY * dCY + dCZ * dCZ),
+                     pChord->dNX * dPX + pChord->dNY * dPY + pChord->dNZ * dPZ);
+      }
+   else
+      {
+      // Rounding can push the sine a hair past 1 for points on the poles of the circle.
+      dSine = pChord->dNX * dPX + pChord->dNY * dPY + pChord->dNZ * dPZ;
+      dSine = dSine > 1.0 ? 1.0 : dSine < -1.0 ? -1.0 : dSine;
+      dAngle = asin(dSine);
+      }
+
+   return (COMPACT_PATH_EARTH_MEAN_RADIUS * dAngle) * (COMPACT_PATH_EARTH_MEAN_RADIUS * dAngle);
+   }
+
+typedef struct CompactPathEllipsoidalChord
+   {
+   // The middle of the chord, which the local plane touches the ellipsoid at, in degrees.
+   double dCenterLongitude, dCenterLatitude;
+
+   // The terms of the projection onto the plane, in meters and degrees. See below.
+   double dEastScale, dEastShear, dNorthScale, dNorthCurve, dNorthConvergence;
+
+   // The start point in the plane, the end point relative to it, and one over the square length of
+   // the chord, or 0.0 if the endpoints are in the same place.
+   double dStartX, dStartY, dChordX, dChordY, dInverseSquareLength;
+   } CompactPathEllipsoidalChord;
+
+// Puts a point in the plane of the chord, in meters east and north of its middle. This is the
+// expansion of the projection to second order in the distance from the middle, so geodesics near
+// the chord come out as straight lines. The error grows with the square of the chord length.
+static inline void compactPathEllipsoidalProject(const CompactPathEllipsoidalChord *pChord,
+                                                 const DVector2D *pPoint, double *pdX, double *pdY)
+   {
+   double dLongitudeDifference, dLatitudeDifference;
+
+   // Go the short way around, so that paths can cross the antimeridian.
+   dLongitudeDifference = pPoint->dX - pChord->dCenterLongitude;
+   if (dLongitudeDifference > 180.0)
+      {
+      dLongitudeDifference -= 360.0;
+      }
+   else if (dLongitudeDifference < -180.0)
+      {
+      dLongitudeDifference += 360.0;
+      }
+   dLatitudeDifference = pPoint->dY - pChord->dCenterLatitude;
+
+   *pdX = dLongitudeDifference * (pChord->dEastScale + pChord->dEastShear * dLatitudeDifference);
+   *pdY = dLatitudeDifference * (pChord->dNorthScale + pChord->dNorthCurve * dLatitudeDifference) +
+          pChord->dNorthConvergence * dLongitudeDifference * dLongitudeDifference;
+   }
+
+static inline void compactPathEllipsoidalPrepare(const DVector2D *pStart, const DVector2D *pEnd,
+                                                 CompactPathEllipsoidalChord *pChord)
+   {
+   double dEccentricitySquared, dLatitude, dSinLatitude, dCosLatitude, dW, dLongitudeDifference;
+   double dPrimeVerticalRadius, dMeridionalRadius, dEndX, dEndY, dSquareLength;
+
+   dEccentricitySquared = COMPACT_PATH_WGS84_FLATTENING * (2.0 - COMPACT_PATH_WGS84_FLATTENING);
+
+   dLongitudeDifference = pEnd->dX - pStart->dX;
+   if (dLongitudeDifference > 180.0)
+      {
+      dLongitudeDifference -= 360.0;
+      }
+   else if (dLongitudeDifference < -180.0)
+      {
+      dLongitudeDifference += 360.0;
+      }
+   pChord->dCenterLongitude = pStart->dX + 0.5 * dLongitudeDifference;
+   pChord->dCenterLatitude = 0.5 * (pStart->dY + pEnd->dY);
+
+   // N and M are the radii of curvature of the ellipsoid across and along the meridian at the
+   // middle. The parallels have radius N cos(latitude), which changes by -M sin(latitude) per
+   // radian of latitude, M changes by 3 e^2 M sin(latitude) cos(latitude) / W, and the meridians
+   // converge so that a parallel bows away from the equator by N sin(latitude) cos(latitude) / 2
+   // times the square of the longitude difference.
+   dLatitude = pChord->dCenterLatitude * COMPACT_PATH_RADIANS_PER_DEGREE;
+   dSinLatitude = sin(dLatitude);
+   dCosLatitude = cos(dLatitude);
+   dW = 1.0 - dEccentricitySquared * dSinLatitude * dSinLatitude;
+   dPrimeVerticalRadius = COMPACT_PATH_WGS84_SEMI_MAJOR_AXIS / sqrt(dW);
+   dMeridionalRadius = dPrimeVerticalRadius * (1.0 - dEccentricitySquared) / dW;
+
+   pChord->dEastScale = dPrimeVerticalRadius * dCosLatitude * COMPACT_PATH_RADIANS_PER_DEGREE;
+   pChord->dEastShear = -dMeridionalRadius * dSinLatitude *
+      COMPACT_PATH_RADIANS_PER_DEGREE * COMPACT_PATH_RADIANS_PER_DEGREE;
+   pChord->dNorthScale = dMeridionalRadius * COMPACT_PATH_RADIANS_PER_DEGREE;
+   pChord->dNorthCurve = 1.5 * dEccentricitySquared * dMeridionalRadius * dSinLatitude *
+      dCosLatitude / dW * COMPACT_PATH_RADIANS_PER_DEGREE * COMPACT_PATH_RADIANS_PER_DEGREE;
+   pChord->dNorthConvergence = 0.5 * dPrimeVerticalRadius * dSinLatitude * dCosLatitude *
+      COMPACT_PATH_RADIANS_PER_DEGREE * COMPACT_PATH_RADIANS_PER_DEGREE;
+
+   compactPathEllipsoidalProject(pChord, pStart, &pChord->dStartX, &pChord->dStartY);
+   compactPathEllipsoidalProject(pChord, pEnd, &dEndX, &dEndY);
+   pChord->dChordX = dEndX - pChord->dStartX;
+   pChord->dChordY = dEndY - pChord->dStartY;
+   dSquareLength = pChord->dChordX * pChord->dChordX + pChord->dChordY * pChord->dChordY;
+   pChord->dInverseSquareLength = dSquareLength > 0.0 ? 1.0 / dSquareLength : 0.0;
+   }
+
+// This is the perpendicular distance in the local plane, or the distance from the start point if
+// the endpoints are in the same place.
+static inline double compactPathEllipsoidalCrossTrackDistance(
+   const CompactPathEllipsoidalChord *pChord, const DVector2D *pMid)
+   {
+   double dX, dY, dCross;
+
+   compactPathEllipsoidalProject(pChord, pMid, &dX, &dY);
+   dX -= pChord->dStartX;
+   dY -= pChord->dStartY;
+
+   if (pChord->dInverseSquareLength == 0.0)
+      {
+      return dX * dX + dY * dY;
+      }
+
+   dCross = pChord->dChordX * dY - pChord->dChordY * dX;
+   return dCross * dCross * pChord->dInverseSquareLength;
+   }
+
+// This is COMPACT_PATH_DEFINE_MAX_DEVIATION_SCAN for the metrics that have a chord structure.
+// chordPrepare runs once per subproblem and metricBody once per intermediate point.
+#define COMPACT_PATH_DEFINE_CHORD_MAX_DEVIATION_SCAN(scanName, chordType, chordPrepare, metricBody)\
+   static int scanName(const DVector2D *pPointArray, int iPointsInCurrentPath,\
+                       DeviationMetric deviationMetric, double *pdMaxSquareDeviation)\
+      {\
+      chordType chord;\
+      double dSquareDeviation, dMaxSquareDeviationInThisSegment;\
+      int i, iMaxPointIndex;\
+      \
+      (void)deviationMetric;\
+      \
+      dMaxSquareDeviationInThisSegment = 0.0;\
+      iMaxPointIndex = 0;\
+      \
+      chordPrepare(pPointArray, pPointArray + iPointsInCurrentPath - 1, &chord);\
+      \
+      for (i = 1; i < iPointsInCurrentPath - 1; ++i)\
+         {\
+         dSquareDeviation = metricBody(&chord, pPointArray + i);\
+         \
+         if (dSquareDeviation > dMaxSquareDeviationInThisSegment)\
+            {\
+            iMaxPointIndex = i;\
+            dMaxSquareDeviationInThisSegment = dSquareDeviation;\
+            }\
+         }\
+      \
+      *pdMaxSquareDeviation = dMaxSquareDeviationInThisSegment;\
+      return iMaxPointIndex;\
+      }
+
+// Runs the Ramer-Douglas-Peucker algorithm on a subproblem without moving any points. Instead,
+// the keep flag of every intermediate point that survives is set to 1. The flags of the other
+// points, including the endpoints, are left alone, so clear them and set the endpoints beforehand.
+// The order in which the subproblems are visited does not matter for the result, so this
+// always continues with the smaller side and saves the larger one for later. That keeps its
+// own stack to a fixed size and it never has to allocate anything.
+// Returns a true value (1) on success and a false value (0) if the solver would have failed.
+int compactPathMarkSubproblem(const DVector2D *pPointArray, int iPointsInCurrentPath,
+                              unsigned char *pKeepFlags, double dEpsilon,
+                              CompactPathMaxDeviationScan maxDeviationScan,
+                              DeviationMetric deviationMetric);
+
+// This is compactPathMarkSubproblem with one bit per point instead of one byte. Bit i is
+// (pKeepBitmap[i / 8] >> (i % 8)) & 1.
+int compactPathMarkSubproblemBits(const DVector2D *pPointArray, int iPointsInCurrentPath,
+                                  unsigned char *pKeepBitmap, double dEpsilon,
+                                  CompactPathMaxDeviationScan maxDeviationScan,
+                                  DeviationMetric deviationMetric);
+
+// This is a max deviation scan for points that aren't stored as a DVector2D array. pPath describes
+// the points in whatever way the layout needs, and the subproblem is the iPointsInCurrentPath
+// points starting at uStart. The result means the same as for CompactPathMaxDeviationScan.
+typedef int (*CompactPathRangeScan)(const void * /*pPath*/, unsigned int /*uStart*/,
+                                    int /*iPointsInCurrentPath*/,
+                                    double * /*pdMaxSquareDeviation*/);
+
+// This is compactPathKeptIndices for any layout that has a range scan.
+int compactPathKeptIndicesWithRangeScan(const void *pPath, unsigned int uPointsInCurrentPath,
+                                        uint32_t *puKeptIndices,
+                                        unsigned int *puPointsInResultPath, double dEpsilon,
+                                        CompactPathRangeScan rangeScan);
+
+// These are the hull tree of PathCompacterHull.c, which is described at the top of that file.
+
+// The number of directions in a hull. Direction i + COMPACT_PATH_HULL_DIRECTIONS / 2 is exactly
+// the opposite of direction i.
+#define COMPACT_PATH_HULL_DIRECTIONS 16
+
+// Runs of this many points or fewer are the leaves of the tree.
+#define COMPACT_PATH_HULL_LEAF_POINTS 32
+
+// adReach[d] is the largest value of direction d dotted with any point of the node. Points with a
+// NaN in them are left out, because the metric comes out NaN for them and the scan never picks
+// them. A point with an infinity in it can make the dot product NaN, and then it counts as
+// reaching infinitely far.
+typedef struct CompactPathHullNode
+   {
+   double adReach[COMPACT_PATH_HULL_DIRECTIONS];
+   } CompactPathHullNode;
+
+// Node i of the tree has children 2i + 1 and 2i + 2. A node that covers the points from iStart
+// up to (but not including) iEnd gives the ones before (iStart + iEnd) / 2 to its left child.
+// The root covers the first iPoints points. The tree only speeds up
+// perpendicularDistanceDeviationMetric. maxDeviationScan and deviationMetric have to be that
+// metric's, and they are used for the subproblems that are too small to be worth a walk.
+typedef struct CompactPathHullTree
+   {
+   const DVector2D *pPointArray;
+   int iPoints;
+   CompactPathHullNode *pNodes;
+   CompactPathMaxDeviationScan maxDeviationScan;
+   DeviationMetric deviationMetric;
+   } CompactPathHullTree;
+
+// Returns the number of nodes in the tree for a path of iPoints points.
+size_t compactPathHullNodeCount(int iPoints);
+
+// Works out the hulls of node iNode, which covers the points from iStart up to (but not
+// including) iEnd, and of everything below it. Call it with 0, 0 and iPoints for the whole tree.
+void compactPathHullBuild(CompactPathHullTree *pTree, int iNode, int iStart, int iEnd);
+
+// Works out the hulls again for the nodes under iNode that cover any of the points from
+// iFirstPoint to iLastPoint, after those points have changed.
+void compactPathHullUpdate(CompactPathHullTree *pTree, int iNode, int iStart, int iEnd,
+                           int iFirstPoint, int iLastPoint);
+
+// This is a CompactPathRangeScan over a CompactPathHullTree, with the same results as the scan
+// of perpendicularDistanceDeviationMetric.
+int compactPathHullRangeScan(const void *pPath, unsigned int uStart, int iPointsInCurrentPath,
+                             double *pdMaxSquareDeviation);
+
+// Makes sure the context has at least uBytes of scratch memory and returns it. If the scratch
+// memory has to move, the first uBytesToKeep bytes come along. The high water mark is updated.
+// Returns NULL if the memory can't be had, in which case the old scratch memory is still there.
+void *compactPathContextGrowScratch(PathCompacterContext *pContext, size_t uBytes,
+                                    size_t uBytesToKeep);
+
+// This is compactPathParallel with the number of points below which a subproblem is marked by the
+// thread that divided it off, instead of being handed to the pool. compactPathParallel uses 8192.
+// Small cutoffs are only good for testing the pool on small paths.
+int compactPathParallelWithCutoff(DVector2D *pPointArray, unsigned int uPointsInCurrentPath,
+                                  DVector2D *pResultPointArray,
+                                  unsigned int *puPointsInResultPath, double dEpsilon,
+                                  DeviationMetric deviationMetric, unsigned int uThreads,
+                                  int iCutoff);
+
+// Runs threadMain once for each of the uThreads arguments in the pArguments array, whose elements
+// are uArgumentSize bytes apart. The first one runs on the calling thread and the rest run on new
+// threads, which are all joined before this returns.
+// Returns a false value (0) if a thread couldn't be started, after waiting for the ones that were.
+int compactPathRunThreads(void *(*threadMain)(void *), void *pArguments, size_t uArgumentSize,
+                          unsigned int uThreads);
+
+#endif
@@ -0,0 +1,357 @@
+/*
+   PathCompacterND.c
+   10/15/2026
+   Authors: Michael Casebolt, Brett Casebolt
+*/
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Michael Casebolt and Brett Casebolt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// This file uses lines up to 100 characters long. If this 100 character line fits then you're good.
+
+// The N dimensional compacters store every point as uDimensions doubles in a row. The built in
+// metrics are written with loops over the dimensions, but the scans for 2, 3 and 4 dimensions
+// are stamped out with the count as a constant, so the compiler unrolls those loops and the hot
+// loop has none left. Other dimension counts get a scan that loops.
+
+#include "PathCompacter.h"
+#include "PathCompacterInternal.h"
+
+#include <string.h> // For memmove and memset
+#include <limits.h> // For INT_MAX
+
+#define FAILURE 0
+#define SUCCESS 1
+
+// The scans below are stamped out for dimension counts up to this one.
+#define COMPACT_PATH_ND_MAX_UNROLLED_DIMENSIONS 4
+
+// The square of the distance from mid to the infinite line through start and end. This is the
+// square length of start->mid minus the square of its projection onto start->end. If start and end
+// are in the same place, there is nothing to project onto and it is just the square length.
+static inline double compactPathPerpendicularDistanceND(const double *pdStart, const double *pdEnd,
+                                                        const double *pdMid,
+                                                        unsigned int uDimensions,
+                                                        double dSquareSegmentLength)
+   {
+   double dAdotB, dSquareB, dSquareDistance;
+   unsigned int u;
+
+   dAdotB = 0.0;
+   dSquareB = 0.0;
+   for (u = 0; u < uDimensions; ++u)
+      {
+      dAdotB += (pdEnd[u] - pdStart[u]) * (pdMid[u] - pdStart[u]);
+      dSquareB += (pdMid[u] - pdStart[u]) * (pdMid[u] - pdStart[u]);
+      }
+
+   if (dSquareSegmentLength == 0.0)
+      {
+      return dSquareB;
+      }
+
+   // Rounding can take this a little below zero for points that are on the line.
+   dSquareDistance = dSquareB - dAdotB * dAdotB / dSquareSegmentLength;
+   return dSquareDistance > 0.0 ? dSquareDistance : 0.0;
+   }
+
+// The square of the distance from mid to the closest point of the segment from start to end.
+static inline double compactPathShortestDistanceToSegmentND(const double *pdStart,
+                                                            const double *pdEnd,
+                                                            const double *pdMid,
+                                                            unsigned int uDimensions,
+                                                            double dSquareSegmentLength)
+   {
+   double dAdotB, dSquareB, dSquareC, dSquareDistance;
+   unsigned int u;
+
+   dAdotB = 0.0;
+   dSquareB = 0.0;
+   dSquareC = 0.0;
+   for (u = 0; u < uDimensions; ++u)
+      {
+      dAdotB += (pdEnd[u] - pdStart[u]) * (pdMid[u] - pdStart[u]);
+      dSquareB += (pdMid[u] - pdStart[u]) * (pdMid[u] - pdStart[u]);
+      dSquareC += (pdMid[u] - pdEnd[u]) * (pdMid[u] - pdEnd[u]);
+      }
+
+   if (dAdotB <= 0.0)
+      {
+      // It is closest to the start point.
+      return dSquareB;
+      }
+   else if (dAdotB >= dSquareSegmentLength)
+      {
+      // It is closest to the end point.
+      return dSquareC;
+      }
+
+   dSquareDistance = dSquareB - dAdotB * dAdotB / dSquareSegmentLength;
+   return dSquareDistance > 0.0 ? dSquareDistance : 0.0;
+   }
+
+// The square of the distance from mid to where an object moving at a constant speed from start
+// to end would have been at the time of mid. The last coordinate is the timestamp and the others
+// are measured.
+static inline double compactPathSynchronizedEuclideanDistanceND(const double *pdStart,
+                                                                const double *pdEnd,
+                                                                const double *pdMid,
+                                                                unsigned int uDimensions,
+                                                                double dSquareSegmentLength)
+   {
+   double dDuration, dRatio, dDelta, dSquareDistance;
+   unsigned int u, uTime;
+
+   (void)dSquareSegmentLength;
+
+   uTime = uDimensions - 1;
+   dDuration = pdEnd[uTime] - pdStart[uTime];
+   dRatio = dDuration != 0.0 ? (pdMid[uTime] - pdStart[uTime]) / dDuration : 0.0;
+
+   dSquareDistance = 0.0;
+   for (u = 0; u < uTime; ++u)
+      {
+      dDelta = pdStart[u] + dRatio * (pdEnd[u] - pdStart[u]) - pdMid[u];
+      dSquareDistance += dDelta * dDelta;
+      }
+
+   return dSquareDistance;
+   }
+
+static double perpendicularDistanceND(const double *pdStart, const double *pdEnd,
+                                      const double *pdPoint, unsigned int uDimensions,
+                                      double dSquareSegmentLength)
+   {
+   return compactPathPerpendicularDistanceND(pdStart, pdEnd, pdPoint, uDimensions,
+                                             dSquareSegmentLength);
+   }
+DeviationMetricND perpendicularDistanceDeviationMetricND = &perpendicularDistanceND;
+
+static double shortestDistanceToSegmentND(const double *pdStart, const double *pdEnd,
+                                          const double *pdPoint, unsigned int uDimensions,
+                                          double dSquareSegmentLength)
+   {
+   return compactPathShortestDistanceToSegmentND(pdStart, pdEnd, pdPoint, uDimensions,
+                                                 dSquareSegmentLength);
+   }
+DeviationMetricND shortestDistanceToSegmentDeviationMetricND = &shortestDistanceToSegmentND;
+
+static double synchronizedEuclideanDistanceND(const double *pdStart, const double *pdEnd,
+                                              const double *pdPoint, unsigned int uDimensions,
+                                              double dSquareSegmentLength)
+   {
+   return compactPathSynchronizedEuclideanDistanceND(pdStart, pdEnd, pdPoint, uDimensions,
+                                                     dSquareSegmentLength);
+   }
+DeviationMetricND synchronizedEuclideanDistanceDeviationMetricND =
+   &synchronizedEuclideanDistanceND;
+
+typedef struct CompactPathNDPath
+   {
+   const double *pdPointArray;
+   unsigned int uDimensions;
+   DeviationMetricND deviationMetric;
+   } CompactPathNDPath;
+
+// This stamps out a range scan with metricBody inlined. dimensions is either a constant or
+// pNDPath->uDimensions. It is the same loop as the one in compactPathFindMaxDeviation.
+#define COMPACT_PATH_DEFINE_ND_SCAN(scanName, dimensions, metricBody)\
+   static int scanName(const void *pPath, unsigned int uStart, int iPointsInCurrentPath,\
+                       double *pdMaxSquareDeviation)\
+      {\
+      const CompactPathNDPath *pNDPath;\
+      const double *pdStart, *pdEnd;\
+      double dSquareSegLen, dSquareDeviation, dMaxSquareDeviationInThisSegment, dDelta;\
+      unsigned int u;\
+      int i, iMaxPointIndex;\
+      \
+      pNDPath = (const CompactPathNDPath *)pPath;\
+      pdStart = pNDPath->pdPointArray + (size_t)uStart * (dimensions);\
+      pdEnd = pdStart + (size_t)(iPointsInCurrentPath - 1) * (dimensions);\
+      \
+      dMaxSquareDeviationInThisSegment = 0.0;\
+      iMaxPointIndex = 0;\
+      \
+      dSquareSegLen = 0.0;\
+      for (u = 0; u < (dimensions); ++u)\
+         {\
+         dDelta = pdEnd[u] - pdStart[u];\
+         dSquareSegLen += dDelta * dDelta;\
+         }\
+      \
+      for (i = 1; i < iPointsInCurrentPath - 1; ++i)\
+         {\
+         dSquareDeviation = metricBody(pdStart, pdEnd, pdStart + (size_t)i * (dimensions),\
+                                       (dimensions), dSquareSegLen);\
+         \
+         if (dSquareDeviation > dMaxSquareDeviationInThisSegment)\
+            {\
+            iMaxPointIndex = i;\
+            dMaxSquareDeviationInThisSegment = dSquareDeviation;\
+            }\
+         }\
+      \
+      *pdMaxSquareDeviation = dMaxSquareDeviationInThisSegment;\
+      return iMaxPointIndex;\
+      }
+
+#define compactPathNDCallMetric(pdStart, pdEnd, pdMid, uDimensions, dSquareSegLen)\
+   pNDPath->deviationMetric((pdStart), (pdEnd), (pdMid), (uDimensions), (dSquareSegLen))
+
+// Stamps out the unrolled scans and the looping one for a built in metric, along with a table of
+// them indexed by the dimension count.
+#define COMPACT_PATH_DEFINE_ND_SCANS(scanPrefix, metricBody)\
+   COMPACT_PATH_DEFINE_ND_SCAN(scanPrefix##1, 1, metricBody)\
+   COMPACT_PATH_DEFINE_ND_SCAN(scanPrefix##2, 2, metricBody)\
+   COMPACT_PATH_DEFINE_ND_SCAN(scanPrefix##3, 3, metricBody)\
+   COMPACT_PATH_DEFINE_ND_SCAN(scanPrefix##4, 4, metricBody)\
+   COMPACT_PATH_DEFINE_ND_SCAN(scanPrefix##Any, pNDPath->uDimensions, metricBody)\
+   static const CompactPathRangeScan\
+      scanPrefix##Table[COMPACT_PATH_ND_MAX_UNROLLED_DIMENSIONS + 2] =\
+      {NULL, scanPrefix##1, scanPrefix##2, scanPrefix##3, scanPrefix##4, scanPrefix##Any};
+
+COMPACT_PATH_DEFINE_ND_SCANS(perpendicularDistanceNDScan, compactPathPerpendicularDistanceND)
+COMPACT_PATH_DEFINE_ND_SCANS(shortestDistanceToSegmentNDScan,
+                             compactPathShortestDistanceToSegmentND)
+COMPACT_PATH_DEFINE_ND_SCANS(synchronizedEuclideanDistanceNDScan,
+                             compactPathSynchronizedEuclideanDistanceND)
+COMPACT_PATH_DEFINE_ND_SCAN(genericNDScan, pNDPath->uDimensions, compactPathNDCallMetric)
+
+static CompactPathRangeScan compactPathSelectNDScan(DeviationMetricND deviationMetric,
+                                                    unsigned int uDimensions)
+   {
+   const CompactPathRangeScan *pScanTable;
+
+   if (deviationMetric == perpendicularDistanceDeviationMetricND)
+      {
+      pScanTable = perpendicularDistanceNDScanTable;
+      }
+   else if (deviationMetric == shortestDistanceToSegmentDeviationMetricND)
+      {
+      pScanTable = shortestDistanceToSegmentNDScanTable;
+      }
+   else if (deviationMetric == synchronizedEuclideanDistanceDeviationMetricND)
+      {
+      pScanTable = synchronizedEuclideanDistanceNDScanTable;
+      }
+   else
+      {
+      return &genericNDScan;
+      }
+
+   if (uDimensions > COMPACT_PATH_ND_MAX_UNROLLED_DIMENSIONS)
+      {
+      uDimensions = COMPACT_PATH_ND_MAX_UNROLLED_DIMENSIONS + 1;
+      }
+
+   return pScanTable[uDimensions];
+   }
+
+int compactPathKeptIndicesND(const double *pdPointArray, unsigned int uDimensions,
+                             unsigned int uPointsInCurrentPath, uint32_t *puKeptIndices,
+                             unsigned int *puPointsInResultPath, double dEpsilon,
+                             DeviationMetricND deviationMetric)
+   {
+   CompactPathNDPath path;
+
+   if (uDimensions < 1 || pdPointArray == NULL || deviationMetric == NULL)
+      {
+      return FAILURE;
+      }
+
+   path.pdPointArray = pdPointArray;
+   path.uDimensions = uDimensions;
+   path.deviationMetric = deviationMetric;
+
+   return compactPathKeptIndicesWithRangeScan(&path, uPointsInCurrentPath, puKeptIndices,
+                                              puPointsInResultPath, dEpsilon,
+                                              compactPathSelectNDScan(deviationMetric,
+                                                                      uDimensions));
+   }
+
+int compactPathNDWithContext(PathCompacterContext *pContext, double *pdPointArray,
+                             unsigned int uDimensions, unsigned int uPointsInCurrentPath,
+                             double *pdResultPointArray, unsigned int *puPointsInResultPath,
+                             double dEpsilon, DeviationMetricND deviationMetric)
+   {
+   uint32_t *puKeptIndices;
+   unsigned int u, uNumKept;
+
+   // Check for invalid values.
+   if (uPointsInCurrentPath > INT_MAX || pdPointArray == NULL || pdResultPointArray == NULL ||
+       puPointsInResultPath == NULL || !(dEpsilon >= 0.0) || deviationMetric == NULL)
+      {
+      return FAILURE;
+      }
+
+   if (pContext->pStats != NULL)
+      {
+      memset(pContext->pStats, 0, sizeof(PathCompacterStats));
+      }
+
+   puKeptIndices = (uint32_t *)compactPathContextGrowScratch(
+      pContext, sizeof(uint32_t) * ((size_t)uPointsInCurrentPath + 1), 0);
+   if (puKeptIndices == NULL)
+      {
+      return FAILURE;
+      }
+
+   if (!compactPathKeptIndicesND(pdPointArray, uDimensions, uPointsInCurrentPath, puKeptIndices,
+                                 &uNumKept, dEpsilon, deviationMetric))
+      {
+      return FAILURE;
+      }
+
+   // The indices are increasing, so no kept point moves to a higher index and this is safe in
+   // place.
+   for (u = 0; u < uNumKept; ++u)
+      {
+      memmove(pdResultPointArray + (size_t)u * uDimensions,
+              pdPointArray + (size_t)puKeptIndices[u] * uDimensions,
+              sizeof(double) * uDimensions);
+      }
+
+   *puPointsInResultPath = uNumKept;
+
+   return SUCCESS;
+   }
+
+int compactPathND(double *pdPointArray, unsigned int uDimensions,
+                  unsigned int uPointsInCurrentPath, double *pdResultPointArray,
+                  unsigned int *puPointsInResultPath, double dEpsilon,
+                  DeviationMetricND deviationMetric)
+   {
+   PathCompacterContext context;
+   int iSuccess;
+
+   compactPathContextInit(&context, NULL, NULL, NULL);
+
+   iSuccess = compactPathNDWithContext(&context, pdPointArray, uDimensions, uPointsInCurrentPath,
+                                       pdResultPointArray, puPointsInResultPath, dEpsilon,
+                                       deviationMetric);
+
+   compactPathContextRelease(&context);
+
+   return iSuccess;
+   }
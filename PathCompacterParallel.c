@@ -0,0 +1,592 @@
+/*
+   PathCompacterParallel.c
+   10/15/2026
+   Authors: Michael Casebolt, Brett Casebolt
+*/
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Michael Casebolt and Brett Casebolt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// This file uses lines up to 100 characters long. If this 100 character line fits then you're good.
+
+#include "PathCompacter.h"
+#include "PathCompacterInternal.h"
+
+#include <stdlib.h> // For memory management
+#include <string.h> // For memmove
+#include <stdint.h> // For uintptr_t
+#include <limits.h> // For INT_MAX
+#include <pthread.h> // For the worker threads
+
+#define FAILURE 0
+#define SUCCESS 1
+
+// Subproblems with fewer points than this are not worth handing to another thread. The thread
+// that divides them off just marks them itself.
+#define COMPACT_PATH_PARALLEL_CUTOFF 8192
+
+// Smaller cutoffs than this would hand out tasks with nothing in them to divide.
+#define COMPACT_PATH_PARALLEL_MIN_CUTOFF 3
+
+// Each thread's task queue starts able to hold this many tasks and grows by this amount.
+#define COMPACT_PATH_PARALLEL_QUEUE_UNIT 64
+
+typedef struct CompactPathParallelTask
+   {
+   int iStart;
+   int iPointsInCurrentPath;
+   } CompactPathParallelTask;
+
+// Each thread owns one of these. The owner pushes and pops at the tail, so it keeps working on
+// the subproblems it divided most recently. Other threads steal from the head, where the oldest
+// and usually largest subproblems are.
+typedef struct CompactPathParallelQueue
+   {
+   pthread_mutex_t mutex;
+   CompactPathParallelTask *pTasks;
+   int iCapacity;
+   int iHead;
+   int iTail;
+   } CompactPathParallelQueue;
+
+typedef struct CompactPathParallelPool
+   {
+   const DVector2D *pPointArray;
+   unsigned char *pKeepFlags;
+   double dEpsilon;
+   CompactPathMaxDeviationScan maxDeviationScan;
+   DeviationMetric deviationMetric;
+   CompactPathParallelQueue *pQueues;
+   unsigned int uThreads;
+   int iCutoff;
+
+   // Every task that has been pushed but not finished yet. The pool is done when this hits zero.
+   pthread_mutex_t countMutex;
+   int iOutstandingTasks;
+   int iFailed;
+
+   // Idle threads wait on this until there is something new to take or the pool is done. uPushes
+   // counts every push, so that a thread can tell whether one happened since it last looked.
+   pthread_cond_t workCondition;
+   unsigned int uPushes;
+   } CompactPathParallelPool;
+
+typedef struct CompactPathParallelWorker
+   {
+   CompactPathParallelPool *pPool;
+   unsigned int uIndex;
+   } CompactPathParallelWorker;
+
+// Each gather thread handles one contiguous block of the keep flags.
+typedef struct CompactPathParallelGather
+   {
+   const unsigned char *pKeepFlags;
+   const DVector2D *pPointArray;
+   DVector2D *pResultPointArray;
+   unsigned int uStart;
+   unsigned int uEnd;
+   unsigned int uResultStart;
+   unsigned int uKept;
+   } CompactPathParallelGather;
+
+static void compactPathParallelFail(CompactPathParallelPool *pPool)
+   {
+   pthread_mutex_lock(&pPool->countMutex);
+   pPool->iFailed = 1;
+   pthread_cond_broadcast(&pPool->workCondition);
+   pthread_mutex_unlock(&pPool->countMutex);
+   }
+
+static int compactPathParallelPush(CompactPathParallelPool *pPool, unsigned int uQueue,
+                                   CompactPathParallelTask *pTask)
+   {
+   CompactPathParallelQueue *pQueue;
+   CompactPathParallelTask *pGrownTasks;
+
+   pQueue = pPool->pQueues + uQueue;
+
+   // Count the task before anyone can steal it, so that the count can never reach zero while
+   // there is still work in a queue.
+   pthread_mutex_lock(&pPool->countMutex);
+   ++pPool->iOutstandingTasks;
+   pthread_mutex_unlock(&pPool->countMutex);
+
+   pthread_mutex_lock(&pQueue->mutex);
+
+   if (pQueue->iTail >= pQueue->iCapacity)
+      {
+      if (pQueue->iHead > 0)
+         {
+         // Reuse the space left behind by stolen tasks before growing.
+         memmove(pQueue->pTasks, pQueue->pTasks + pQueue->iHead,
+                 sizeof(CompactPathParallelTask) * (pQueue->iTail - pQueue->iHead));
+         pQueue->iTail -= pQueue->iHead;
+         pQueue->iHead = 0;
+         }
+      else
+         {
+         pGrownTasks = realloc(pQueue->pTasks, sizeof(CompactPathParallelTask) *
+                               (pQueue->iCapacity + COMPACT_PATH_PARALLEL_QUEUE_UNIT));
+         if (pGrownTasks == NULL)
+            {
+            pthread_mutex_unlock(&pQueue->mutex);
+            return FAILURE;
+            }
+         pQueue->pTasks = pGrownTasks;
+         pQueue->iCapacity += COMPACT_PATH_PARALLEL_QUEUE_UNIT;
+         }
+      }
+
+   pQueue->pTasks[pQueue->iTail] = *pTask;
+   ++pQueue->iTail;
+
+   pthread_mutex_unlock(&pQueue->mutex);
+
+   // Wake up a thread that is waiting for work.
+   pthread_mutex_lock(&pPool->countMutex);
+   ++pPool->uPushes;
+   pthread_cond_signal(&pPool->workCondition);
+   pthread_mutex_unlock(&pPool->countMutex);
+
+   return SUCCESS;
+   }
+
+// Pops from the tail of the worker's own queue, or failing that, steals from the head of another.
+static int compactPathParallelTake(CompactPathParallelPool *pPool, unsigned int uQueue,
+                                   CompactPathParallelTask *pTask)
+   {
+   CompactPathParallelQueue *pQueue;
+   unsigned int u;
+   int iFound;
+
+   pQueue = pPool->pQueues + uQueue;
+   iFound = 0;
+
+   pthread_mutex_lock(&pQueue->mutex);
+   if (pQueue->iTail > pQueue->iHead)
+      {
+      --pQueue->iTail;
+      *pTask = pQueue->pTasks[pQueue->iTail];
+      iFound = 1;
+      }
+   pthread_mutex_unlock(&pQueue->mutex);
+
+   for (u = 1; !iFound && u < pPool->uThreads; ++u)
+      {
+      pQueue = pPool->pQueues + (uQueue + u) % pPool->uThreads;
+
+      pthread_mutex_lock(&pQueue->mutex);
+      if (pQueue->iTail > pQueue->iHead)
+         {
+         *pTask = pQueue->pTasks[pQueue->iHead];
+         ++pQueue->iHead;
+         iFound = 1;
+         }
+      pthread_mutex_unlock(&pQueue->mutex);
+      }
+
+   return iFound;
+   }
+
+// Divides a task the same way the compactPathSubproblemSolver would, handing the larger side of
+// every division to the pool until the rest is small enough to mark on this thread.
+static void compactPathParallelSolve(CompactPathParallelPool *pPool, unsigned int uQueue,
+                                     CompactPathParallelTask current)
+   {
+   CompactPathParallelTask firstSide, secondSide;
+   int iDivisionIndex;
+   double dMaxSquareDeviation;
+
+   while (current.iPointsInCurrentPath >= pPool->iCutoff)
+      {
+      iDivisionIndex = pPool->maxDeviationScan(pPool->pPointArray + current.iStart,
+         current.iPointsInCurrentPath, pPool->deviationMetric, &dMaxSquareDeviation);
+
+      if (dMaxSquareDeviation < pPool->dEpsilon * pPool->dEpsilon || iDivisionIndex <= 0)
+         {
+         // The whole task is linearized.
+         return;
+         }
+
+      pPool->pKeepFlags[current.iStart + iDivisionIndex] = 1;
+
+      firstSide.iStart = current.iStart;
+      firstSide.iPointsInCurrentPath = iDivisionIndex + 1;
+      secondSide.iStart = current.iStart + iDivisionIndex;
+      secondSide.iPointsInCurrentPath = current.iPointsInCurrentPath - iDivisionIndex;
+
+      if (firstSide.iPointsInCurrentPath < secondSide.iPointsInCurrentPath)
+         {
+         current = firstSide;
+         firstSide = secondSide;
+         }
+      else
+         {
+         current = secondSide;
+         }
+
+      if (firstSide.iPointsInCurrentPath >= pPool->iCutoff)
+         {
+         if (!compactPathParallelPush(pPool, uQueue, &firstSide))
+            {
+            compactPathParallelFail(pPool);
+            return;
+            }
+         }
+      else if (!compactPathMarkSubproblem(pPool->pPointArray + firstSide.iStart,
+                  firstSide.iPointsInCurrentPath, pPool->pKeepFlags + firstSide.iStart,
+                  pPool->dEpsilon, pPool->maxDeviationScan, pPool->deviationMetric))
+         {
+         compactPathParallelFail(pPool);
+         return;
+         }
+      }
+
+   if (!compactPathMarkSubproblem(pPool->pPointArray + current.iStart,
+                                  current.iPointsInCurrentPath, pPool->pKeepFlags + current.iStart,
+                                  pPool->dEpsilon, pPool->maxDeviationScan,
+                                  pPool->deviationMetric))
+      {
+      compactPathParallelFail(pPool);
+      }
+   }
+
+static void *compactPathParallelWorkerMain(void *pArgument)
+   {
+   CompactPathParallelWorker *pWorker;
+   CompactPathParallelPool *pPool;
+   CompactPathParallelTask task;
+   unsigned int uPushesSeen;
+
+   pWorker = (CompactPathParallelWorker *)pArgument;
+   pPool = pWorker->pPool;
+
+   for (;;)
+      {
+      // Note the pushes before looking in the queues, so that a push made after the queues were
+      // found empty can't be missed.
+      pthread_mutex_lock(&pPool->countMutex);
+      uPushesSeen = pPool->uPushes;
+      pthread_mutex_unlock(&pPool->countMutex);
+
+      if (compactPathParallelTake(pPool, pWorker->uIndex, &task))
+         {
+         compactPathParallelSolve(pPool, pWorker->uIndex, task);
+
+         pthread_mutex_lock(&pPool->countMutex);
+         --pPool->iOutstandingTasks;
+         if (pPool->iOutstandingTasks == 0)
+            {
+            pthread_cond_broadcast(&pPool->workCondition);
+            }
+         pthread_mutex_unlock(&pPool->countMutex);
+         }
+      else
+         {
+         // Someone else is still dividing. Sleep until they push something or everything is done.
+         pthread_mutex_lock(&pPool->countMutex);
+         while (pPool->iOutstandingTasks > 0 && !pPool->iFailed &&
+                pPool->uPushes == uPushesSeen)
+            {
+            pthread_cond_wait(&pPool->workCondition, &pPool->countMutex);
+            }
+         if (pPool->iOutstandingTasks == 0 || pPool->iFailed)
+            {
+            pthread_mutex_unlock(&pPool->countMutex);
+            return NULL;
+            }
+         pthread_mutex_unlock(&pPool->countMutex);
+         }
+      }
+   }
+
+static void *compactPathParallelCountMain(void *pArgument)
+   {
+   CompactPathParallelGather *pGather;
+   unsigned int u;
+
+   pGather = (CompactPathParallelGather *)pArgument;
+   pGather->uKept = 0;
+
+   for (u = pGather->uStart; u < pGather->uEnd; ++u)
+      {
+      pGather->uKept += pGather->pKeepFlags[u];
+      }
+
+   return NULL;
+   }
+
+static void *compactPathParallelGatherMain(void *pArgument)
+   {
+   CompactPathParallelGather *pGather;
+   DVector2D *pDestination;
+   unsigned int u;
+
+   pGather = (CompactPathParallelGather *)pArgument;
+   pDestination = pGather->pResultPointArray + pGather->uResultStart;
+
+   for (u = pGather->uStart; u < pGather->uEnd; ++u)
+      {
+      if (pGather->pKeepFlags[u])
+         {
+         *pDestination = pGather->pPointArray[u];
+         ++pDestination;
+         }
+      }
+
+   return NULL;
+   }
+
+int compactPathRunThreads(void *(*threadMain)(void *), void *pArguments, size_t uArgumentSize,
+                          unsigned int uThreads)
+   {
+   pthread_t *pThreads;
+   unsigned int u, uStarted;
+
+   pThreads = (pthread_t *)malloc(sizeof(pthread_t) * uThreads);
+   if (pThreads == NULL)
+      {
+      return FAILURE;
+      }
+
+   for (uStarted = 1; uStarted < uThreads; ++uStarted)
+      {
+      if (pthread_create(pThreads + uStarted, NULL, threadMain,
+                         (char *)pArguments + uArgumentSize * uStarted) != 0)
+         {
+         break;
+         }
+      }
+
+   threadMain(pArguments);
+
+   for (u = 1; u < uStarted; ++u)
+      {
+      pthread_join(pThreads[u], NULL);
+      }
+
+   free(pThreads);
+
+   return uStarted == uThreads;
+   }
+
+// This is the cleanup macro for the compactPathParallelWithCutoff function.
+#define COMPACT_PATH_PARALLEL_RETURN(iReturnValue)\
+   {\
+   for (u = 0; u < uQueuesInitialized; ++u)\
+      {\
+      pthread_mutex_destroy(&pool.pQueues[u].mutex);\
+      free(pool.pQueues[u].pTasks);\
+      }\
+   if (iCountMutexInitialized)\
+      {\
+      pthread_mutex_destroy(&pool.countMutex);\
+      }\
+   if (iConditionInitialized)\
+      {\
+      pthread_cond_destroy(&pool.workCondition);\
+      }\
+   free(pool.pQueues);\
+   free(pWorkers);\
+   free(pGathers);\
+   free(pKeepFlags);\
+   return iReturnValue;\
+   }
+
+int compactPathParallel(DVector2D *pPointArray, unsigned int uPointsInCurrentPath,
+                        DVector2D *pResultPointArray, unsigned int *puPointsInResultPath,
+                        double dEpsilon, DeviationMetric deviationMetric, unsigned int uThreads)
+   {
+   return compactPathParallelWithCutoff(pPointArray, uPointsInCurrentPath, pResultPointArray,
+                                        puPointsInResultPath, dEpsilon, deviationMetric, uThreads,
+                                        COMPACT_PATH_PARALLEL_CUTOFF);
+   }
+
+int compactPathParallelWithCutoff(DVector2D *pPointArray, unsigned int uPointsInCurrentPath,
+                                  DVector2D *pResultPointArray,
+                                  unsigned int *puPointsInResultPath, double dEpsilon,
+                                  DeviationMetric deviationMetric, unsigned int uThreads,
+                                  int iCutoff)
+   {
+   CompactPathParallelPool pool;
+   CompactPathParallelWorker *pWorkers;
+   CompactPathParallelGather *pGathers;
+   CompactPathParallelTask wholePath;
+   unsigned char *pKeepFlags;
+   unsigned int u, uQueuesInitialized, uBlockSize, uNumKept;
+   int iCountMutexInitialized, iConditionInitialized, iOverlapping;
+   uintptr_t uPointsBegin, uPointsEnd, uResultBegin, uResultEnd;
+
+   // Check for invalid values the same way compactPath does, so that a bad call fails the same way
+   // whether or not the path is long enough for threads. The tasks count their points with an int.
+   if (uPointsInCurrentPath > INT_MAX || pPointArray == NULL || pResultPointArray == NULL ||
+       puPointsInResultPath == NULL || !(dEpsilon >= 0.0) || deviationMetric == NULL)
+      {
+      return FAILURE;
+      }
+
+   if (iCutoff < COMPACT_PATH_PARALLEL_MIN_CUTOFF)
+      {
+      iCutoff = COMPACT_PATH_PARALLEL_MIN_CUTOFF;
+      }
+
+   // There is nothing to gain from threads on a path that would be marked by one thread anyway.
+   if (uThreads < 2 || uPointsInCurrentPath < 2 * (unsigned int)iCutoff)
+      {
+      return compactPath(pPointArray, uPointsInCurrentPath, pResultPointArray,
+                         puPointsInResultPath, dEpsilon, deviationMetric);
+      }
+
+   pool.pQueues = NULL;
+   pWorkers = NULL;
+   pGathers = NULL;
+   uQueuesInitialized = 0;
+   iCountMutexInitialized = 0;
+   iConditionInitialized = 0;
+
+   // The endpoints are always kept.
+   pKeepFlags = (unsigned char *)calloc(uPointsInCurrentPath, sizeof(unsigned char));
+   if (pKeepFlags == NULL)
+      {
+      COMPACT_PATH_PARALLEL_RETURN(FAILURE);
+      }
+   pKeepFlags[0] = 1;
+   pKeepFlags[uPointsInCurrentPath - 1] = 1;
+
+   pool.pPointArray = pPointArray;
+   pool.pKeepFlags = pKeepFlags;
+   pool.dEpsilon = dEpsilon;
+   pool.maxDeviationScan = compactPathSelectMaxDeviationScan(deviationMetric);
+   pool.deviationMetric = deviationMetric;
+   pool.uThreads = uThreads;
+   pool.iCutoff = iCutoff;
+   pool.iOutstandingTasks = 0;
+   pool.iFailed = 0;
+   pool.uPushes = 0;
+
+   pool.pQueues = (CompactPathParallelQueue *)calloc(uThreads, sizeof(CompactPathParallelQueue));
+   pWorkers = (CompactPathParallelWorker *)malloc(sizeof(CompactPathParallelWorker) * uThreads);
+   pGathers = (CompactPathParallelGather *)malloc(sizeof(CompactPathParallelGather) * uThreads);
+   if (pool.pQueues == NULL || pWorkers == NULL || pGathers == NULL)
+      {
+      COMPACT_PATH_PARALLEL_RETURN(FAILURE);
+      }
+
+   if (pthread_mutex_init(&pool.countMutex, NULL) != 0)
+      {
+      COMPACT_PATH_PARALLEL_RETURN(FAILURE);
+      }
+   iCountMutexInitialized = 1;
+
+   if (pthread_cond_init(&pool.workCondition, NULL) != 0)
+      {
+      COMPACT_PATH_PARALLEL_RETURN(FAILURE);
+      }
+   iConditionInitialized = 1;
+
+   for (u = 0; u < uThreads; ++u)
+      {
+      pool.pQueues[u].pTasks = (CompactPathParallelTask *)
+         malloc(sizeof(CompactPathParallelTask) * COMPACT_PATH_PARALLEL_QUEUE_UNIT);
+      if (pool.pQueues[u].pTasks == NULL)
+         {
+         COMPACT_PATH_PARALLEL_RETURN(FAILURE);
+         }
+      if (pthread_mutex_init(&pool.pQueues[u].mutex, NULL) != 0)
+         {
+         free(pool.pQueues[u].pTasks);
+         COMPACT_PATH_PARALLEL_RETURN(FAILURE);
+         }
+      pool.pQueues[u].iCapacity = COMPACT_PATH_PARALLEL_QUEUE_UNIT;
+      ++uQueuesInitialized;
+
+      pWorkers[u].pPool = &pool;
+      pWorkers[u].uIndex = u;
+      }
+
+   // Seed the calling thread's queue with the whole problem and let the threads divide it.
+   wholePath.iStart = 0;
+   wholePath.iPointsInCurrentPath = uPointsInCurrentPath;
+   if (!compactPathParallelPush(&pool, 0, &wholePath))
+      {
+      COMPACT_PATH_PARALLEL_RETURN(FAILURE);
+      }
+
+   if (!compactPathRunThreads(compactPathParallelWorkerMain, pWorkers,
+                               sizeof(CompactPathParallelWorker), uThreads) || pool.iFailed)
+      {
+      COMPACT_PATH_PARALLEL_RETURN(FAILURE);
+      }
+
+   // Gather the flagged points. Every block counts its kept points, a prefix sum over the counts
+   // gives each block its place in the result, and then the blocks copy their points in parallel.
+   uBlockSize = (uPointsInCurrentPath + uThreads - 1) / uThreads;
+   for (u = 0; u < uThreads; ++u)
+      {
+      pGathers[u].pKeepFlags = pKeepFlags;
+      pGathers[u].pPointArray = pPointArray;
+      pGathers[u].pResultPointArray = pResultPointArray;
+      pGathers[u].uStart = u * uBlockSize < uPointsInCurrentPath ?
+                           u * uBlockSize : uPointsInCurrentPath;
+      pGathers[u].uEnd = pGathers[u].uStart + uBlockSize < uPointsInCurrentPath ?
+                         pGathers[u].uStart + uBlockSize : uPointsInCurrentPath;
+      }
+
+   if (!compactPathRunThreads(compactPathParallelCountMain, pGathers,
+                               sizeof(CompactPathParallelGather), uThreads))
+      {
+      COMPACT_PATH_PARALLEL_RETURN(FAILURE);
+      }
+
+   uNumKept = 0;
+   for (u = 0; u < uThreads; ++u)
+      {
+      pGathers[u].uResultStart = uNumKept;
+      uNumKept += pGathers[u].uKept;
+      }
+
+   // When the result overlaps the input, a block could overwrite points that an earlier block
+   // hasn't read yet. Copying front to back on one thread is always safe, because no kept point
+   // ever moves to a higher index.
+   uPointsBegin = (uintptr_t)pPointArray;
+   uPointsEnd = (uintptr_t)(pPointArray + uPointsInCurrentPath);
+   uResultBegin = (uintptr_t)pResultPointArray;
+   uResultEnd = (uintptr_t)(pResultPointArray + uPointsInCurrentPath);
+   iOverlapping = uResultBegin < uPointsEnd && uPointsBegin < uResultEnd;
+
+   if (iOverlapping)
+      {
+      pGathers[0].uEnd = uPointsInCurrentPath;
+      compactPathParallelGatherMain(pGathers);
+      }
+   else if (!compactPathRunThreads(compactPathParallelGatherMain, pGathers,
+                                    sizeof(CompactPathParallelGather), uThreads))
+      {
+      COMPACT_PATH_PARALLEL_RETURN(FAILURE);
+      }
+
+   *puPointsInResultPath = uNumKept;
+
+   COMPACT_PATH_PARALLEL_RETURN(SUCCESS);
+   }
@@ -0,0 +1,109 @@
+/*
+   PathCompacterRadial.c
+   10/15/2026
+   Authors: Michael Casebolt, Brett Casebolt
+*/
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Michael Casebolt and Brett Casebolt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// This file uses lines up to 100 characters long. If this 100 character line fits then you're good.
+
+#include "PathCompacter.h"
+
+#include <limits.h> // For INT_MAX
+
+#define FAILURE 0
+#define SUCCESS 1
+
+int compactPathRadialDistance(DVector2D *pPointArray, unsigned int uPointsInCurrentPath,
+                              DVector2D *pResultPointArray, unsigned int *puPointsInResultPath,
+                              double dRadius)
+   {
+   DVector2D lastKept;
+   double dSquareRadius, dDX, dDY;
+   unsigned int u, uNumKept;
+
+   // Check for invalid values.
+   if (uPointsInCurrentPath > INT_MAX || pPointArray == NULL || pResultPointArray == NULL ||
+       puPointsInResultPath == NULL || dRadius < 0.0)
+      {
+      return FAILURE;
+      }
+
+   if (uPointsInCurrentPath == 0)
+      {
+      *puPointsInResultPath = 0;
+      return SUCCESS;
+      }
+
+   dSquareRadius = dRadius * dRadius;
+
+   // No kept point moves to a higher index, so this is safe in place.
+   lastKept = pPointArray[0];
+   pResultPointArray[0] = lastKept;
+   uNumKept = 1;
+
+   for (u = 1; u + 1 < uPointsInCurrentPath; ++u)
+      {
+      dDX = pPointArray[u].dX - lastKept.dX;
+      dDY = pPointArray[u].dY - lastKept.dY;
+
+      // Written this way around so that a point with a NaN in it is kept.
+      if (!(dDX * dDX + dDY * dDY < dSquareRadius))
+         {
+         lastKept = pPointArray[u];
+         pResultPointArray[uNumKept] = lastKept;
+         ++uNumKept;
+         }
+      }
+
+   // The last point is always kept.
+   if (uPointsInCurrentPath > 1)
+      {
+      pResultPointArray[uNumKept] = pPointArray[uPointsInCurrentPath - 1];
+      ++uNumKept;
+      }
+
+   *puPointsInResultPath = uNumKept;
+
+   return SUCCESS;
+   }
+
+int compactPathRadialThenRdp(DVector2D *pPointArray, unsigned int uPointsInCurrentPath,
+                             DVector2D *pResultPointArray, unsigned int *puPointsInResultPath,
+                             double dEpsilon, DeviationMetric deviationMetric)
+   {
+   unsigned int uPrefilteredPoints;
+
+   if (!compactPathRadialDistance(pPointArray, uPointsInCurrentPath, pResultPointArray,
+                                  &uPrefilteredPoints, 0.5 * dEpsilon))
+      {
+      return FAILURE;
+      }
+
+   // The prefiltered path is in the result array already, so compact it there in place.
+   return compactPath(pResultPointArray, uPrefilteredPoints, pResultPointArray,
+                      puPointsInResultPath, dEpsilon, deviationMetric);
+   }
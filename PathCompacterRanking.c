@@ -0,0 +1,304 @@
+/*
+   PathCompacterRanking.c
+   10/15/2026
+   Authors: Michael Casebolt, Brett Casebolt
+*/
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Michael Casebolt and Brett Casebolt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// This file uses lines up to 100 characters long. If this 100 character line fits then you're good.
+
+#include "PathCompacter.h"
+#include "PathCompacterInternal.h"
+
+#include <stdlib.h> // For memory management and qsort
+#include <limits.h> // For INT_MAX
+#include <math.h> // For HUGE_VAL
+
+#define FAILURE 0
+#define SUCCESS 1
+
+// A subproblem that has been scanned but not divided yet. These are out of order for the purposes
+// of struct packing.
+typedef struct CompactPathRankingCall
+   {
+   double dSignificance;
+   unsigned int uStart;
+   unsigned int uEnd;
+   unsigned int uDivisionIndex;
+   } CompactPathRankingCall;
+
+// The heap is ordered by significance, and ties go to the lowest division index so that the
+// ranking doesn't depend on the order in which subproblems were pushed.
+static int compactPathRankingCallBefore(const CompactPathRankingCall *pA,
+                                        const CompactPathRankingCall *pB)
+   {
+   if (pA->dSignificance != pB->dSignificance)
+      {
+      return pA->dSignificance > pB->dSignificance;
+      }
+   return pA->uDivisionIndex < pB->uDivisionIndex;
+   }
+
+static void compactPathRankingHeapPush(CompactPathRankingCall *pHeap, unsigned int *puHeapSize,
+                                       const CompactPathRankingCall *pCall)
+   {
+   unsigned int uChild, uParent;
+
+   uChild = *puHeapSize;
+   ++*puHeapSize;
+
+   while (uChild > 0)
+      {
+      uParent = (uChild - 1) / 2;
+      if (!compactPathRankingCallBefore(pCall, pHeap + uParent))
+         {
+         break;
+         }
+      pHeap[uChild] = pHeap[uParent];
+      uChild = uParent;
+      }
+
+   pHeap[uChild] = *pCall;
+   }
+
+static void compactPathRankingHeapPop(CompactPathRankingCall *pHeap, unsigned int *puHeapSize,
+                                      CompactPathRankingCall *pCall)
+   {
+   CompactPathRankingCall last;
+   unsigned int uParent, uChild;
+
+   *pCall = pHeap[0];
+   --*puHeapSize;
+   last = pHeap[*puHeapSize];
+
+   uParent = 0;
+   for (;;)
+      {
+      uChild = 2 * uParent + 1;
+      if (uChild >= *puHeapSize)
+         {
+         break;
+         }
+      if (uChild + 1 < *puHeapSize &&
+          compactPathRankingCallBefore(pHeap + uChild + 1, pHeap + uChild))
+         {
+         ++uChild;
+         }
+      if (!compactPathRankingCallBefore(pHeap + uChild, &last))
+         {
+         break;
+         }
+      pHeap[uParent] = pHeap[uChild];
+      uParent = uChild;
+      }
+
+   pHeap[uParent] = last;
+   }
+
+// Scans the subproblem from uStart to uEnd and pushes it if it has a point worth dividing at.
+// Its significance can't be more than that of the division that created it.
+static void compactPathRankingScan(const DVector2D *pPointArray, unsigned int uStart,
+                                   unsigned int uEnd, double dParentSignificance,
+                                   CompactPathMaxDeviationScan maxDeviationScan,
+                                   DeviationMetric deviationMetric,
+                                   CompactPathRankingCall *pHeap, unsigned int *puHeapSize)
+   {
+   CompactPathRankingCall call;
+   double dMaxSquareDeviation;
+   int iDivisionIndex;
+
+   if (uEnd - uStart < 2)
+      {
+      return;
+      }
+
+   iDivisionIndex = maxDeviationScan(pPointArray + uStart, (int)(uEnd - uStart + 1),
+                                     deviationMetric, &dMaxSquareDeviation);
+
+   // Every intermediate point lies on the segment, so none of them would ever be kept.
+   if (iDivisionIndex <= 0)
+      {
+      return;
+      }
+
+   call.dSignificance = dMaxSquareDeviation < dParentSignificance ?
+      dMaxSquareDeviation : dParentSignificance;
+   call.uStart = uStart;
+   call.uEnd = uEnd;
+   call.uDivisionIndex = uStart + (unsigned int)iDivisionIndex;
+
+   compactPathRankingHeapPush(pHeap, puHeapSize, &call);
+   }
+
+int compactPathRankVertices(const DVector2D *pPointArray, unsigned int uPointsInCurrentPath,
+                            double *pdSignificance, uint32_t *puRankedIndices,
+                            unsigned int *puRankedVertices, DeviationMetric deviationMetric)
+   {
+   CompactPathMaxDeviationScan maxDeviationScan;
+   CompactPathRankingCall *pHeap, call;
+   unsigned int u, uHeapSize, uNumRanked;
+
+   // Check for invalid values.
+   if (uPointsInCurrentPath > INT_MAX || pPointArray == NULL || pdSignificance == NULL ||
+       puRankedIndices == NULL || puRankedVertices == NULL || deviationMetric == NULL)
+      {
+      return FAILURE;
+      }
+
+   // The endpoints are always kept.
+   for (u = 0; u < uPointsInCurrentPath; ++u)
+      {
+      pdSignificance[u] = 0.0;
+      }
+   if (uPointsInCurrentPath > 0)
+      {
+      pdSignificance[0] = HUGE_VAL;
+      pdSignificance[uPointsInCurrentPath - 1] = HUGE_VAL;
+      }
+
+   *puRankedVertices = 0;
+   if (uPointsInCurrentPath < 3)
+      {
+      return SUCCESS;
+      }
+
+   // The subproblems waiting in the heap never overlap and each one has at least one
+   // intermediate point, so there can't be more than half as many of them as there are points.
+   pHeap = (CompactPathRankingCall *)malloc(sizeof(CompactPathRankingCall) *
+                                            (uPointsInCurrentPath / 2 + 1));
+   if (pHeap == NULL)
+      {
+      return FAILURE;
+      }
+
+   maxDeviationScan = compactPathSelectMaxDeviationScan(deviationMetric);
+
+   uHeapSize = 0;
+   uNumRanked = 0;
+   compactPathRankingScan(pPointArray, 0, uPointsInCurrentPath - 1, HUGE_VAL, maxDeviationScan,
+                          deviationMetric, pHeap, &uHeapSize);
+
+   // Always divide the most significant subproblem next. A division is never more significant
+   // than the one that created it, so every vertex comes out after the vertices it depends on.
+   while (uHeapSize > 0)
+      {
+      compactPathRankingHeapPop(pHeap, &uHeapSize, &call);
+
+      pdSignificance[call.uDivisionIndex] = call.dSignificance;
+      puRankedIndices[uNumRanked] = call.uDivisionIndex;
+      ++uNumRanked;
+
+      compactPathRankingScan(pPointArray, call.uStart, call.uDivisionIndex, call.dSignificance,
+                             maxDeviationScan, deviationMetric, pHeap, &uHeapSize);
+      compactPathRankingScan(pPointArray, call.uDivisionIndex, call.uEnd, call.dSignificance,
+                             maxDeviationScan, deviationMetric, pHeap, &uHeapSize);
+      }
+
+   free(pHeap);
+
+   *puRankedVertices = uNumRanked;
+
+   return SUCCESS;
+   }
+
+static int compactPathCompareIndices(const void *pA, const void *pB)
+   {
+   uint32_t uA, uB;
+
+   uA = *(const uint32_t *)pA;
+   uB = *(const uint32_t *)pB;
+
+   return (uA > uB) - (uA < uB);
+   }
+
+int compactPathSelectTopK(const uint32_t *puRankedIndices, unsigned int uRankedVertices,
+                          unsigned int uPointsInCurrentPath, unsigned int uMaxPoints,
+                          uint32_t *puKeptIndices, unsigned int *puPointsInResultPath)
+   {
+   unsigned int u, uFromRanking;
+
+   // A budget that can't even hold the endpoints is turned down before anything is written, since
+   // puKeptIndices only has to hold uMaxPoints entries.
+   if (uMaxPoints < uPointsInCurrentPath && uMaxPoints < 2)
+      {
+      return FAILURE;
+      }
+
+   // Short paths and budgets too small for anything but the endpoints get just those.
+   if (uPointsInCurrentPath < 3 || uMaxPoints < 3)
+      {
+      for (u = 0; u < uPointsInCurrentPath && u < 2; ++u)
+         {
+         puKeptIndices[u] = u == 0 ? 0 : uPointsInCurrentPath - 1;
+         }
+      *puPointsInResultPath = u;
+      return SUCCESS;
+      }
+
+   uFromRanking = uMaxPoints - 2;
+   if (uFromRanking > uRankedVertices)
+      {
+      uFromRanking = uRankedVertices;
+      }
+
+   puKeptIndices[0] = 0;
+   for (u = 0; u < uFromRanking; ++u)
+      {
+      puKeptIndices[u + 1] = puRankedIndices[u];
+      }
+   qsort(puKeptIndices + 1, uFromRanking, sizeof(uint32_t), compactPathCompareIndices);
+   puKeptIndices[uFromRanking + 1] = uPointsInCurrentPath - 1;
+
+   *puPointsInResultPath = uFromRanking + 2;
+
+   return SUCCESS;
+   }
+
+int compactPathSelectByEpsilon(const double *pdSignificance, unsigned int uPointsInCurrentPath,
+                               double dEpsilon, uint32_t *puKeptIndices,
+                               unsigned int *puPointsInResultPath)
+   {
+   unsigned int u, uNumKept;
+   double dSquareEpsilon;
+
+   dSquareEpsilon = dEpsilon * dEpsilon;
+
+   uNumKept = 0;
+   for (u = 0; u < uPointsInCurrentPath; ++u)
+      {
+      // Points that were never divided at have a significance of zero, and compactPath doesn't
+      // divide at them even when epsilon is zero.
+      if (pdSignificance[u] > 0.0 && pdSignificance[u] >= dSquareEpsilon)
+         {
+         puKeptIndices[uNumKept] = u;
+         ++uNumKept;
+         }
+      }
+
+   *puPointsInResultPath = uNumKept;
+
+   return SUCCESS;
+   }
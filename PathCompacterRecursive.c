@@ -31,24 +31,29 @@ THE SOFTWARE.
 // This file uses lines up to 100 characters long. If this 100 character line fits then you're good.
 
 #include "PathCompacter.h"
+#include "PathCompacterInternal.h"
 
-#include <string.h> // For memcpy
+#include <string.h> // For memcpy and memmove
+#include <limits.h> // For INT_MAX
 
 #define FAILURE 0
 #define SUCCESS 1
 
-// This keeps track of the location of the "compacter". This is just the spot in the result
-// array where the next points to be solved should be placed.
-// Only CompactPath and CompactPathRecursive should touch this variable.
-static DVector2D *pCompacterLocation;
+// Everything that stays the same for the whole compaction. This used to live in file-static
+// globals, which made it impossible for two threads to compact at the same time. Now it gets
+// passed down the recursion by pointer instead.
+typedef struct CompactPathRecursion
+   {
+   CompactPathMaxDeviationScan maxDeviationScan;
+   DeviationMetric deviationMetric;
+   double dEpsilon;
+   } CompactPathRecursion;
 
-// Save the deviation metric function pointer so that it doesn't have to be copied on the stack
-// a bunch of times.
-static DeviationMetric currentDeviationMetric;
-   
-static void compactPathRecursive(DVector2D *pPointArray, int uPointsInCurrentPath, double dEpsilon);
+static int compactPathRecursiveSolve(const CompactPathRecursion *pRecursion,
+                                     DVector2D *pPointArray, DVector2D *pResultSpan,
+                                     int uPointsInCurrentPath, DVector2D *pCompacterLocation);
 
-// This function iteratively simulates the recursive Ramer-Douglas-Peucker algorithm.
+// This function runs the recursive Ramer-Douglas-Peucker algorithm.
 // https://en.wikipedia.org/wiki/Ramer%E2%80%93Douglas%E2%80%93Peucker_algorithm
 // Please allocate the resultPointArray to be as large as the pointArray passed in.
 // It would be a good idea to resize the allocated space for resultPointArray after this
@@ -56,19 +61,32 @@ static void compactPathRecursive(DVector2D *pPointArray, int uPointsInCurrentPat
 // This algorithm works in-place. That is, you can use the same array for both pointArray
 // and resultPointArray, keeping in mind that doing so will likely alter pointArray.
 // Returns a true value (1) on successful completion, and returns a false value (0) otherwise.
-// This function might blow up the stack and crash your program.
-extern int compactPath(DVector2D *pPointArray, int uPointsInCurrentPath,
-                       DVector2D *pResultPointArray, int *puPointsInResultPath,
-                       double dEpsilon, DeviationMetric deviationMetric)
+// It only ever recurses into the smaller side of a division, so the recursion is never more
+// than about 32 calls deep, and it keeps no state outside of its arguments, so it is reentrant.
+int compactPathRecursive(DVector2D *pPointArray, unsigned int uPointsInCurrentPath,
+                         DVector2D *pResultPointArray, unsigned int *puPointsInResultPath,
+                         double dEpsilon, DeviationMetric deviationMetric)
    {
-   int iFinalSuccessValue;
+   CompactPathRecursion recursion;
+   int iPointsInResultPath;
 
    // Check for invalid values.
-   if (uPointsInCurrentPath < 0 || pPointArray == NULL || pResultPointArray == NULL ||
-       puPointsInResultPath == NULL || dEpsilon < 0.0)
+   if (uPointsInCurrentPath > INT_MAX || pPointArray == NULL || pResultPointArray == NULL ||
+       puPointsInResultPath == NULL || !(dEpsilon >= 0.0) || deviationMetric == NULL)
       {
       return FAILURE;
       }
+
+   // An empty path doesn't even have a first point to copy.
+   if (uPointsInCurrentPath == 0)
+      {
+      *puPointsInResultPath = 0;
+      return SUCCESS;
+      }
+
+   recursion.maxDeviationScan = compactPathSelectMaxDeviationScan(deviationMetric);
+   recursion.deviationMetric = deviationMetric;
+   recursion.dEpsilon = dEpsilon;
       
    // Copy the first point into the result. This can be done because its final location is
    // known (it will still be the first point), and it will certainly be in the final array
@@ -77,82 +95,115 @@ extern int compactPath(DVector2D *pPointArray, int uPointsInCurrentPath,
    // last point of the subproblem before it. Copying the very first point is necessary
    // because the leftmost subproblem has no prior subproblem.
    *pResultPointArray = *pPointArray;
-   pCompacterLocation = pResultPointArray + 1;
-
-   currentDeviationMetric = deviationMetric;
 
-   // Launch the first call of CompactPathRecursive.
-   compactPathRecursive(pPointArray, uPointsInCurrentPath, dEpsilon);
+   // Launch the first call of compactPathRecursiveSolve.
+   iPointsInResultPath = compactPathRecursiveSolve(&recursion, pPointArray, pResultPointArray,
+                                                   uPointsInCurrentPath, pResultPointArray + 1);
+   if (iPointsInResultPath < 0)
+      {
+      return FAILURE;
+      }
 
-   // Calculate and return through pointer the number of points in the resulting path.
-   *puPointsInResultPath = pCompacterLocation - pResultPointArray;
+   // Count the first point too.
+   *puPointsInResultPath = iPointsInResultPath + 1;
 
    return SUCCESS;
    }
 
-// If the result is COMPACT_PATH_RESULT_CODE_DIVIDE, it means that the algorithm needs to divide
-// the problem into two smaller subproblems. In this case, divisionIndex is set to the
-// index of the point that should be the end point of the first subproblem and the start point
-// of the second subproblem. pointsInCurrentPath is not set, because its value is not yet known.
-// If the result is COMPACT_PATH_RESULT_CODE_LINEARIZE, it means that all the intermediate points in
-// the subproblem were removed. In this case, divisionIndex is not set.
-// If the result is COMPACT_PATH_RESULT_CODE_SOLVED, it means that the algorithm does not need to
-// do any further work on the subproblem, because it is already solved. In this case, divisionIndex
-// is not set.
-static void compactPathRecursive(DVector2D *pPointArray, int uPointsInCurrentPath, double dEpsilon)
+// Solves the subproblem made up of uPointsInCurrentPath points at pPointArray. pResultSpan is the
+// spot in the result array that lines up with pPointArray. The points that survive, except for the
+// first one, are written to the "compacter" starting at pCompacterLocation, which is never past
+// pResultSpan + 1. Returns the number of points written, or -1 on failure.
+// A division is handled by recursing into the smaller side and looping on the larger one. When
+// the left side is smaller, that's easy, because its points go to the compacter first anyway.
+// When the right side is smaller, it gets solved first into its own span of the result array and
+// is then slid up against the end of the span, where the results of the right sides accumulate
+// until the left side is finished and they can be moved to the compacter together.
+static int compactPathRecursiveSolve(const CompactPathRecursion *pRecursion,
+                                     DVector2D *pPointArray, DVector2D *pResultSpan,
+                                     int uPointsInCurrentPath, DVector2D *pCompacterLocation)
    {
-   double dSquareSegLen, dDX, dDY, dArea, dSquareDeviation, dMaxSquareDeviationInThisSegment;
-   int i, iMaxPointIndex;
-   
-   // If there are fewer than three points provided, the problem is solved already.
-   if (uPointsInCurrentPath < 3)
+   double dMaxSquareDeviationInThisSegment;
+   int iMaxPointIndex, iStart, iEnd, iTailStart, iPointsInSide, iPointsWritten, iPointsSolved;
+
+   iStart = 0;
+   iEnd = uPointsInCurrentPath - 1;
+   iTailStart = uPointsInCurrentPath;
+   iPointsWritten = 0;
+
+   for (;;)
       {
-      // Just copy pointArray into the compacter.
-      if (uPointsInCurrentPath > 0)
+      // If there are fewer than three points left, the problem is solved already.
+      if (iEnd - iStart + 1 < 3)
          {
-            memcpy(pCompacterLocation, pPointArray + 1,
-                   sizeof(DVector2D) * (uPointsInCurrentPath - 1));
-            pCompacterLocation += uPointsInCurrentPath - 1;
+         // Just copy pointArray into the compacter.
+         if (iEnd > iStart)
+            {
+            memmove(pCompacterLocation + iPointsWritten, pPointArray + iStart + 1,
+                    sizeof(DVector2D) * (iEnd - iStart));
+            iPointsWritten += iEnd - iStart;
+            }
+         break;
          }
-         
-      return;
-      }
-   
-   dMaxSquareDeviationInThisSegment = 0.0;
-
-   dDX = pPointArray[uPointsInCurrentPath-1].dX - pPointArray[0].dX;
-   dDY = pPointArray[uPointsInCurrentPath-1].dY - pPointArray[0].dY;
-   dSquareSegLen = dDX * dDX + dDY * dDY;
-   
-   for (i = 1; i < uPointsInCurrentPath - 1; ++i)
-      {
-      dSquareDeviation = currentDeviationMetric(pPointArray[0],
-         pPointArray[uPointsInCurrentPath - 1], pPointArray[i], dSquareSegLen);
-      
-      if (dSquareDeviation > dMaxSquareDeviationInThisSegment)
+
+      iMaxPointIndex = pRecursion->maxDeviationScan(pPointArray + iStart, iEnd - iStart + 1,
+                                                    pRecursion->deviationMetric,
+                                                    &dMaxSquareDeviationInThisSegment);
+
+      // A subproblem whose points all lie on the segment linearizes even when epsilon is zero.
+      if (dMaxSquareDeviationInThisSegment < pRecursion->dEpsilon * pRecursion->dEpsilon ||
+          iMaxPointIndex <= 0)
          {
-         iMaxPointIndex = i;
-         dMaxSquareDeviationInThisSegment = dSquareDeviation;
+         // Linearize the points in the subproblem.
+         // To do this, we just copy the last point into the compacter.
+         pCompacterLocation[iPointsWritten] = pPointArray[iEnd];
+         ++iPointsWritten;
+         break;
          }
-      }
-   
-   if (dMaxSquareDeviationInThisSegment < dEpsilon * dEpsilon)
-      {
-      // Linearize the points in the subproblem.
-      // To do this, we just copy the last point into the compacter.
 
-      *pCompacterLocation = pPointArray[uPointsInCurrentPath - 1];
-      ++pCompacterLocation;
+      // Split the subproblem. The output still has to come out left to right.
+      if (iMaxPointIndex + 1 <= iEnd - iStart - iMaxPointIndex + 1)
+         {
+         iPointsSolved = compactPathRecursiveSolve(pRecursion, pPointArray + iStart,
+                                                   pResultSpan + iStart, iMaxPointIndex + 1,
+                                                   pCompacterLocation + iPointsWritten);
+         if (iPointsSolved < 0)
+            {
+            return -1;
+            }
+         iPointsWritten += iPointsSolved;
+         iStart += iMaxPointIndex;
+         }
+      else
+         {
+         iPointsInSide = iEnd - iStart - iMaxPointIndex + 1;
+         iStart += iMaxPointIndex;
+         iPointsSolved = compactPathRecursiveSolve(pRecursion, pPointArray + iStart,
+                                                   pResultSpan + iStart, iPointsInSide,
+                                                   pResultSpan + iStart + 1);
+         if (iPointsSolved < 0)
+            {
+            return -1;
+            }
+
+         // The side wrote at most iPointsInSide - 1 points, so the space between it and the
+         // tail is big enough to hold them.
+         iTailStart -= iPointsSolved;
+         memmove(pResultSpan + iTailStart, pResultSpan + iStart + 1,
+                 sizeof(DVector2D) * iPointsSolved);
+
+         iEnd = iStart;
+         iStart -= iMaxPointIndex;
+         }
       }
-   else
-      {
-      // Split the subproblem. Make sure to keep this left-recursive.
-      
-      compactPathRecursive(pPointArray, iMaxPointIndex + 1, dEpsilon);
 
-      compactPathRecursive(pPointArray + iMaxPointIndex, uPointsInCurrentPath - iMaxPointIndex,
-                           dEpsilon);
+   // Everything left of the tail is in the compacter now. The tail goes after it.
+   if (iTailStart < uPointsInCurrentPath)
+      {
+      memmove(pCompacterLocation + iPointsWritten, pResultSpan + iTailStart,
+              sizeof(DVector2D) * (uPointsInCurrentPath - iTailStart));
+      iPointsWritten += uPointsInCurrentPath - iTailStart;
       }
-      
-   return;
+
+   return iPointsWritten;
    }
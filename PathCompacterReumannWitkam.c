@@ -0,0 +1,121 @@
+/*
+   PathCompacterReumannWitkam.c
+   10/15/2026
+   Authors: Michael Casebolt, Brett Casebolt
+*/
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Michael Casebolt and Brett Casebolt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// This file uses lines up to 100 characters long. If this 100 character line fits then you're good.
+
+// This is the Reumann-Witkam algorithm. The line through a kept point and the point after it
+// defines a strip, 2 epsilon wide. The path is followed for as long as it stays inside the strip,
+// and the last point inside becomes the next kept point, along with the next strip. It makes one
+// pass over the path and needs no memory.
+// https://psimpl.sourceforge.net/reumann-witkam.html
+
+#include "PathCompacter.h"
+
+#include <limits.h> // For INT_MAX
+
+#define FAILURE 0
+#define SUCCESS 1
+
+int compactPathReumannWitkam(DVector2D *pPointArray, unsigned int uPointsInCurrentPath,
+                             DVector2D *pResultPointArray, unsigned int *puPointsInResultPath,
+                             double dEpsilon, DeviationMetric deviationMetric)
+   {
+   DVector2D key, direction;
+   double dSquareEpsilon, dSquareSegLen, dDX, dDY;
+   unsigned int uKey, uDirection, uPoint, uLastPoint, uNumKept;
+
+   // Check for invalid values.
+   if (uPointsInCurrentPath > INT_MAX || pPointArray == NULL || pResultPointArray == NULL ||
+       puPointsInResultPath == NULL || !(dEpsilon >= 0.0) || deviationMetric == NULL)
+      {
+      return FAILURE;
+      }
+
+   if (uPointsInCurrentPath == 0)
+      {
+      *puPointsInResultPath = 0;
+      return SUCCESS;
+      }
+
+   // The strip is made of the points near the line through the key and direction points, and
+   // most of the path lies beyond the direction point. The distance to the segment measures those
+   // from the direction point instead, which makes the strip a circle around it and the algorithm
+   // no better than radial distance, so that metric is measured from the line after all.
+   if (deviationMetric == shortestDistanceToSegmentDeviationMetric)
+      {
+      deviationMetric = perpendicularDistanceDeviationMetric;
+      }
+
+   dSquareEpsilon = dEpsilon * dEpsilon;
+   uLastPoint = uPointsInCurrentPath - 1;
+
+   // The kept points are written behind the point being looked at, so this is safe in place. The
+   // points that define the strip get copied out first, because the result can overwrite them.
+   uKey = 0;
+   key = pPointArray[0];
+   pResultPointArray[0] = key;
+   uNumKept = 1;
+
+   while (uKey < uLastPoint)
+      {
+      // Points on top of the key point don't give the strip a direction.
+      for (uDirection = uKey + 1;
+           uDirection < uLastPoint && pPointArray[uDirection].dX == key.dX &&
+           pPointArray[uDirection].dY == key.dY;
+           ++uDirection)
+         {
+         }
+
+      direction = pPointArray[uDirection];
+      dDX = direction.dX - key.dX;
+      dDY = direction.dY - key.dY;
+      dSquareSegLen = dDX * dDX + dDY * dDY;
+
+      for (uPoint = uDirection + 1; uPoint <= uLastPoint; ++uPoint)
+         {
+         if (!(deviationMetric(key, direction, pPointArray[uPoint], dSquareSegLen) <
+               dSquareEpsilon))
+            {
+            break;
+            }
+         }
+
+      // The point before the one that left the strip is the next kept point. If none left it,
+      // that's the last point of the path.
+      uKey = uPoint - 1;
+      key = pPointArray[uKey];
+      pResultPointArray[uNumKept] = key;
+      ++uNumKept;
+      }
+
+   *puPointsInResultPath = uNumKept;
+
+   return SUCCESS;
+   }
@@ -0,0 +1,729 @@
+/*
+   PathCompacterRings.c
+   10/15/2026
+   Authors: Michael Casebolt, Brett Casebolt
+*/
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Michael Casebolt and Brett Casebolt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// This file uses lines up to 100 characters long. If this 100 character line fits then you're good.
+
+// This file simplifies closed rings, like the outlines and holes of polygons.
+//
+// An open path has two endpoints that have to stay, but a ring doesn't, and whichever point
+// happens to come first is a poor choice for one. Instead, each ring is anchored at its leftmost
+// point and at the point furthest from that one. Those two are as far apart as the ring allows,
+// which is where compactPath would want to start anyway, and the two chains between them are
+// compacted like open paths. A ring always keeps at least three points, so it never collapses.
+//
+// Simplifying rings one at a time can make them cross themselves or each other. In the topology
+// preserving mode, every segment of the result is put into a grid and checked against the
+// segments near it. A segment that replaced some points and now crosses another segment gets
+// divided again at its farthest point, just like it would have been with a smaller epsilon, and
+// the check repeats until nothing crosses. Segments that come straight from the input are never
+// divided, so crossings that were already in the input are left alone, and the check always ends,
+// at worst with the input itself.
+
+#include "PathCompacter.h"
+#include "PathCompacterInternal.h"
+
+#include <stdlib.h> // For memory management
+#include <string.h> // For memset
+#include <limits.h> // For INT_MAX
+#include <math.h> // For sqrt
+
+#define FAILURE 0
+#define SUCCESS 1
+
+// The grid never has more cells than this on a side.
+#define COMPACT_PATH_RINGS_MAX_GRID_SIZE 4096
+
+// One ring, turned so that it starts at its first anchor and with that point repeated at the end.
+// That way each chain between two kept points is a contiguous run of points, with no wrapping.
+typedef struct CompactPathRing
+   {
+   DVector2D *pPointArray;
+   unsigned char *pKeepFlags;
+
+   // The number of distinct points. pPointArray has one more than that.
+   unsigned int uVertices;
+
+   // The index in the input of pPointArray[0].
+   unsigned int uAnchor;
+
+   // Whether the input repeated the first point at the end, which the result does too.
+   int iClosed;
+   } CompactPathRing;
+
+typedef struct CompactPathRingSegment
+   {
+   unsigned int uRing;
+   unsigned int uStart;
+   unsigned int uEnd;
+   } CompactPathRingSegment;
+
+typedef struct CompactPathRings
+   {
+   CompactPathRing *pRings;
+   unsigned int uRings;
+   CompactPathMaxDeviationScan maxDeviationScan;
+   DeviationMetric deviationMetric;
+
+   // The segments of the result and the grid over them. These are only used by the topology
+   // preserving mode, and they grow as needed.
+   CompactPathRingSegment *pSegments;
+   unsigned int uSegmentCapacity;
+   unsigned char *pDivideFlags;
+   unsigned int *puCellStarts;
+   unsigned int *puCellSegments;
+   size_t uCellSegmentCapacity;
+   } CompactPathRings;
+
+// Picks the anchors of a ring and compacts the chains between them.
+static int compactPathRingsCompact(CompactPathRings *pState, CompactPathRing *pRing,
+                                   const DVector2D *pInput, double dEpsilon)
+   {
+   DVector2D *pPoints;
+   double dDX, dDY, dSquareDistance, dFarthest, dFirstDeviation, dSecondDeviation;
+   unsigned int u, uVertices, uAnchor, uOpposite, uKept;
+   int iFirstIndex, iSecondIndex;
+
+   uVertices = pRing->uVertices;
+   pPoints = pRing->pPointArray;
+
+   // Small rings are kept whole.
+   if (uVertices < 4)
+      {
+      for (u = 0; u < uVertices; ++u)
+         {
+         pPoints[u] = pInput[u];
+         }
+      pPoints[uVertices] = pInput[0];
+      memset(pRing->pKeepFlags, 1, uVertices + 1);
+      pRing->uAnchor = 0;
+      return SUCCESS;
+      }
+
+   // The leftmost point, with the lowest one breaking ties.
+   uAnchor = 0;
+   for (u = 1; u < uVertices; ++u)
+      {
+      if (pInput[u].dX < pInput[uAnchor].dX ||
+          (pInput[u].dX == pInput[uAnchor].dX && pInput[u].dY < pInput[uAnchor].dY))
+         {
+         uAnchor = u;
+         }
+      }
+
+   for (u = 0; u < uVertices; ++u)
+      {
+      pPoints[u] = pInput[(uAnchor + u) % uVertices];
+      }
+   pPoints[uVertices] = pPoints[0];
+   pRing->uAnchor = uAnchor;
+
+   // The point furthest from it. If every point is in the same place, any other one will do.
+   uOpposite = uVertices / 2;
+   dFarthest = 0.0;
+   for (u = 1; u < uVertices; ++u)
+      {
+      dDX = pPoints[u].dX - pPoints[0].dX;
+      dDY = pPoints[u].dY - pPoints[0].dY;
+      dSquareDistance = dDX * dDX + dDY * dDY;
+      if (dSquareDistance > dFarthest)
+         {
+         dFarthest = dSquareDistance;
+         uOpposite = u;
+         }
+      }
+
+   memset(pRing->pKeepFlags, 0, uVertices + 1);
+   pRing->pKeepFlags[0] = 1;
+   pRing->pKeepFlags[uOpposite] = 1;
+   pRing->pKeepFlags[uVertices] = 1;
+
+   if ((uOpposite >= 2 &&
+        !compactPathMarkSubproblem(pPoints, (int)uOpposite + 1, pRing->pKeepFlags, dEpsilon,
+                                   pState->maxDeviationScan, pState->deviationMetric)) ||
+       (uVertices - uOpposite >= 2 &&
+        !compactPathMarkSubproblem(pPoints + uOpposite, (int)(uVertices - uOpposite) + 1,
+                                   pRing->pKeepFlags + uOpposite, dEpsilon,
+                                   pState->maxDeviationScan, pState->deviationMetric)))
+      {
+      return FAILURE;
+      }
+
+   uKept = 0;
+   for (u = 0; u < uVertices; ++u)
+      {
+      uKept += pRing->pKeepFlags[u];
+      }
+
+   // Two points would make a ring with no area. Keep the point furthest from the segment
+   // between them too.
+   if (uKept < 3)
+      {
+      iFirstIndex = 0;
+      iSecondIndex = 0;
+      dFirstDeviation = 0.0;
+      dSecondDeviation = 0.0;
+      if (uOpposite >= 2)
+         {
+         iFirstIndex = pState->maxDeviationScan(pPoints, (int)uOpposite + 1,
+                                                pState->deviationMetric, &dFirstDeviation);
+         }
+      if (uVertices - uOpposite >= 2)
+         {
+         iSecondIndex = pState->maxDeviationScan(pPoints + uOpposite,
+                                                 (int)(uVertices - uOpposite) + 1,
+                                                 pState->deviationMetric, &dSecondDeviation);
+         }
+
+      if (iSecondIndex > 0 && (iFirstIndex <= 0 || dSecondDeviation > dFirstDeviation))
+         {
+         pRing->pKeepFlags[uOpposite + iSecondIndex] = 1;
+         }
+      else if (iFirstIndex > 0)
+         {
+         pRing->pKeepFlags[iFirstIndex] = 1;
+         }
+      else
+         {
+         // Every point is on the line through the anchors.
+         pRing->pKeepFlags[uOpposite >= 2 ? uOpposite / 2 : uOpposite + 1] = 1;
+         }
+      }
+
+   return SUCCESS;
+   }
+
+// Returns which side of the line through pA and pB the point pC is on: positive for the left,
+// negative for the right, and zero for on the line.
+static double compactPathRingsOrientation(const DVector2D *pA, const DVector2D *pB,
+                                          const DVector2D *pC)
+   {
+   return (pB->dX - pA->dX) * (pC->dY - pA->dY) - (pB->dY - pA->dY) * (pC->dX - pA->dX);
+   }
+
+// Whether pC, which is on the line through pA and pB, is also between them.
+static int compactPathRingsWithin(const DVector2D *pA, const DVector2D *pB, const DVector2D *pC)
+   {
+   return pC->dX >= (pA->dX < pB->dX ? pA->dX : pB->dX) &&
+          pC->dX <= (pA->dX > pB->dX ? pA->dX : pB->dX) &&
+          pC->dY >= (pA->dY < pB->dY ? pA->dY : pB->dY) &&
+          pC->dY <= (pA->dY > pB->dY ? pA->dY : pB->dY);
+   }
+
+static int compactPathRingsSegmentsCross(const DVector2D *pA, const DVector2D *pB,
+                                         const DVector2D *pC, const DVector2D *pD)
+   {
+   double dC, dD, dA, dB;
+
+   dC = compactPathRingsOrientation(pA, pB, pC);
+   dD = compactPathRingsOrientation(pA, pB, pD);
+   dA = compactPathRingsOrientation(pC, pD, pA);
+   dB = compactPathRingsOrientation(pC, pD, pB);
+
+   if (((dC > 0.0 && dD < 0.0) || (dC < 0.0 && dD > 0.0)) &&
+       ((dA > 0.0 && dB < 0.0) || (dA < 0.0 && dB > 0.0)))
+      {
+      return 1;
+      }
+
+   // Touching counts too.
+   return (dC == 0.0 && compactPathRingsWithin(pA, pB, pC)) ||
+          (dD == 0.0 && compactPathRingsWithin(pA, pB, pD)) ||
+          (dA == 0.0 && compactPathRingsWithin(pC, pD, pA)) ||
+          (dB == 0.0 && compactPathRingsWithin(pC, pD, pB));
+   }
+
+// Decides whether two segments of the result get in each other's way. Neighbouring segments of a
+// ring always share a point, so they only count if they double back over each other.
+static int compactPathRingsConflict(const CompactPathRings *pState,
+                                    const CompactPathRingSegment *pFirst,
+                                    const CompactPathRingSegment *pSecond)
+   {
+   const CompactPathRing *pRing;
+   const DVector2D *pA, *pB, *pC, *pD, *pShared, *pFirstOther, *pSecondOther;
+   unsigned int uVertices;
+
+   pA = pState->pRings[pFirst->uRing].pPointArray + pFirst->uStart;
+   pB = pState->pRings[pFirst->uRing].pPointArray + pFirst->uEnd;
+   pC = pState->pRings[pSecond->uRing].pPointArray + pSecond->uStart;
+   pD = pState->pRings[pSecond->uRing].pPointArray + pSecond->uEnd;
+
+   if (pFirst->uRing == pSecond->uRing)
+      {
+      pRing = pState->pRings + pFirst->uRing;
+      uVertices = pRing->uVertices;
+
+      pShared = NULL;
+      pFirstOther = NULL;
+      pSecondOther = NULL;
+      if (pFirst->uEnd == pSecond->uStart ||
+          (pFirst->uEnd == uVertices && pSecond->uStart == 0))
+         {
+         pShared = pB;
+         pFirstOther = pA;
+         pSecondOther = pD;
+         }
+      else if (pSecond->uEnd == pFirst->uStart ||
+               (pSecond->uEnd == uVertices && pFirst->uStart == 0))
+         {
+         pShared = pA;
+         pFirstOther = pB;
+         pSecondOther = pC;
+         }
+
+      if (pShared != NULL)
+         {
+         return compactPathRingsOrientation(pShared, pFirstOther, pSecondOther) == 0.0 &&
+                (pFirstOther->dX - pShared->dX) * (pSecondOther->dX - pShared->dX) +
+                (pFirstOther->dY - pShared->dY) * (pSecondOther->dY - pShared->dY) > 0.0;
+         }
+      }
+
+   return compactPathRingsSegmentsCross(pA, pB, pC, pD);
+   }
+
+// Lists the segments of the result. Returns the number of them, or -1 if memory runs out.
+static long compactPathRingsListSegments(CompactPathRings *pState)
+   {
+   CompactPathRingSegment *pGrownSegments;
+   const CompactPathRing *pRing;
+   unsigned int uRing, u, uStart, uSegments;
+
+   uSegments = 0;
+   for (uRing = 0; uRing < pState->uRings; ++uRing)
+      {
+      pRing = pState->pRings + uRing;
+      if (pRing->uVertices < 2)
+         {
+         continue;
+         }
+
+      uStart = 0;
+      for (u = 1; u <= pRing->uVertices; ++u)
+         {
+         if (!pRing->pKeepFlags[u])
+            {
+            continue;
+            }
+
+         if (uSegments == pState->uSegmentCapacity)
+            {
+            pState->uSegmentCapacity = 2 * pState->uSegmentCapacity + 64;
+            pGrownSegments = (CompactPathRingSegment *)realloc(
+               pState->pSegments, sizeof(CompactPathRingSegment) * pState->uSegmentCapacity);
+            if (pGrownSegments == NULL)
+               {
+               return -1;
+               }
+            pState->pSegments = pGrownSegments;
+            }
+
+         pState->pSegments[uSegments].uRing = uRing;
+         pState->pSegments[uSegments].uStart = uStart;
+         pState->pSegments[uSegments].uEnd = u;
+         ++uSegments;
+         uStart = u;
+         }
+      }
+
+   return (long)uSegments;
+   }
+
+// Finds the segments that replaced some points and cross another segment, and flags them to be
+// divided. Returns the number flagged, or -1 if memory runs out or the points can't be laid on a
+// grid because they aren't finite or are spread too far apart.
+static long compactPathRingsFindConflicts(CompactPathRings *pState, unsigned int uSegments)
+   {
+   const CompactPathRingSegment *pSegment;
+   const DVector2D *pStart, *pEnd;
+   double dMinX, dMinY, dMaxX, dMaxY, dCellSize;
+   unsigned int *puGrown;
+   unsigned int u, v, uGridSize, uCell, uFirst, uSecond, uCellX, uCellY;
+   unsigned int auLow[2], auHigh[2];
+   size_t uInsertions;
+   long iFlagged;
+   int iPass;
+
+   if (uSegments < 2)
+      {
+      return 0;
+      }
+
+   dMinX = dMaxX = pState->pRings[pState->pSegments[0].uRing].pPointArray[0].dX;
+   dMinY = dMaxY = pState->pRings[pState->pSegments[0].uRing].pPointArray[0].dY;
+   for (u = 0; u < uSegments; ++u)
+      {
+      pStart = pState->pRings[pState->pSegments[u].uRing].pPointArray +
+               pState->pSegments[u].uStart;
+
+      // A grid can't be laid over points that aren't finite, so the crossings can't be checked.
+      if (!(pStart->dX - pStart->dX == 0.0 && pStart->dY - pStart->dY == 0.0))
+         {
+         return -1;
+         }
+
+      dMinX = pStart->dX < dMinX ? pStart->dX : dMinX;
+      dMaxX = pStart->dX > dMaxX ? pStart->dX : dMaxX;
+      dMinY = pStart->dY < dMinY ? pStart->dY : dMinY;
+      dMaxY = pStart->dY > dMaxY ? pStart->dY : dMaxY;
+      }
+
+   // The extent can still overflow.
+   if (!(dMaxX - dMinX < HUGE_VAL && dMaxY - dMinY < HUGE_VAL))
+      {
+      return -1;
+      }
+
+   // About one segment per cell.
+   uGridSize = (unsigned int)sqrt((double)uSegments) + 1;
+   if (uGridSize > COMPACT_PATH_RINGS_MAX_GRID_SIZE)
+      {
+      uGridSize = COMPACT_PATH_RINGS_MAX_GRID_SIZE;
+      }
+   dCellSize = (dMaxX - dMinX > dMaxY - dMinY ? dMaxX - dMinX : dMaxY - dMinY) / uGridSize;
+   if (!(dCellSize > 0.0))
+      {
+      dCellSize = 1.0;
+      }
+
+   puGrown = (unsigned int *)realloc(pState->puCellStarts,
+                                     sizeof(unsigned int) * (uGridSize * uGridSize + 1));
+   if (puGrown == NULL)
+      {
+      return -1;
+      }
+   pState->puCellStarts = puGrown;
+
+   // Every segment goes into each cell its bounding box touches. The first pass counts them, and
+   // the second one puts them in place.
+   for (iPass = 0; iPass < 2; ++iPass)
+      {
+      if (iPass == 0)
+         {
+         memset(pState->puCellStarts, 0, sizeof(unsigned int) * (uGridSize * uGridSize + 1));
+         }
+
+      for (u = 0; u < uSegments; ++u)
+         {
+         pSegment = pState->pSegments + u;
+         pStart = pState->pRings[pSegment->uRing].pPointArray + pSegment->uStart;
+         pEnd = pState->pRings[pSegment->uRing].pPointArray + pSegment->uEnd;
+
+         auLow[0] = (unsigned int)(((pStart->dX < pEnd->dX ? pStart->dX : pEnd->dX) - dMinX) /
+                                   dCellSize);
+         auHigh[0] = (unsigned int)(((pStart->dX > pEnd->dX ? pStart->dX : pEnd->dX) - dMinX) /
+                                    dCellSize);
+         auLow[1] = (unsigned int)(((pStart->dY < pEnd->dY ? pStart->dY : pEnd->dY) - dMinY) /
+                                   dCellSize);
+         auHigh[1] = (unsigned int)(((pStart->dY > pEnd->dY ? pStart->dY : pEnd->dY) - dMinY) /
+                                    dCellSize);
+         for (v = 0; v < 2; ++v)
+            {
+            auLow[v] = auLow[v] < uGridSize ? auLow[v] : uGridSize - 1;
+            auHigh[v] = auHigh[v] < uGridSize ? auHigh[v] : uGridSize - 1;
+            }
+
+         for (uCellY = auLow[1]; uCellY <= auHigh[1]; ++uCellY)
+            {
+            for (uCellX = auLow[0]; uCellX <= auHigh[0]; ++uCellX)
+               {
+               uCell = uCellY * uGridSize + uCellX;
+               if (iPass == 0)
+                  {
+                  ++pState->puCellStarts[uCell + 1];
+                  }
+               else
+                  {
+                  pState->puCellSegments[pState->puCellStarts[uCell]] = u;
+                  ++pState->puCellStarts[uCell];
+                  }
+               }
+            }
+         }
+
+      if (iPass == 0)
+         {
+         uInsertions = 0;
+         for (uCell = 0; uCell < uGridSize * uGridSize; ++uCell)
+            {
+            uInsertions += pState->puCellStarts[uCell + 1];
+            pState->puCellStarts[uCell + 1] = (unsigned int)uInsertions;
+            }
+         if (uInsertions > UINT_MAX)
+            {
+            return -1;
+            }
+
+         if (uInsertions > pState->uCellSegmentCapacity)
+            {
+            puGrown = (unsigned int *)realloc(pState->puCellSegments,
+                                              sizeof(unsigned int) * uInsertions);
+            if (puGrown == NULL)
+               {
+               return -1;
+               }
+            pState->puCellSegments = puGrown;
+            pState->uCellSegmentCapacity = uInsertions;
+            }
+         }
+      }
+
+   // Putting them in place moved every start up to where the next cell starts.
+   for (uCell = uGridSize * uGridSize; uCell > 0; --uCell)
+      {
+      pState->puCellStarts[uCell] = pState->puCellStarts[uCell - 1];
+      }
+   pState->puCellStarts[0] = 0;
+
+   memset(pState->pDivideFlags, 0, uSegments);
+   iFlagged = 0;
+
+   for (uCell = 0; uCell < uGridSize * uGridSize; ++uCell)
+      {
+      for (u = pState->puCellStarts[uCell]; u < pState->puCellStarts[uCell + 1]; ++u)
+         {
+         uFirst = pState->puCellSegments[u];
+         for (v = u + 1; v < pState->puCellStarts[uCell + 1]; ++v)
+            {
+            uSecond = pState->puCellSegments[v];
+
+            // Only segments that replaced some points can be divided, and there's no need to
+            // look again at a pair that is already flagged.
+            if ((pState->pSegments[uFirst].uEnd - pState->pSegments[uFirst].uStart < 2 ||
+                 pState->pDivideFlags[uFirst]) &&
+                (pState->pSegments[uSecond].uEnd - pState->pSegments[uSecond].uStart < 2 ||
+                 pState->pDivideFlags[uSecond]))
+               {
+               continue;
+               }
+
+            if (compactPathRingsConflict(pState, pState->pSegments + uFirst,
+                                         pState->pSegments + uSecond))
+               {
+               if (pState->pSegments[uFirst].uEnd - pState->pSegments[uFirst].uStart >= 2 &&
+                   !pState->pDivideFlags[uFirst])
+                  {
+                  pState->pDivideFlags[uFirst] = 1;
+                  ++iFlagged;
+                  }
+               if (pState->pSegments[uSecond].uEnd - pState->pSegments[uSecond].uStart >= 2 &&
+                   !pState->pDivideFlags[uSecond])
+                  {
+                  pState->pDivideFlags[uSecond] = 1;
+                  ++iFlagged;
+                  }
+               }
+            }
+         }
+      }
+
+   return iFlagged;
+   }
+
+// Divides segments until none of them cross. Returns a false value (0) if memory runs out.
+static int compactPathRingsPreserveTopology(CompactPathRings *pState)
+   {
+   const CompactPathRingSegment *pSegment;
+   CompactPathRing *pRing;
+   unsigned char *pGrownFlags;
+   double dMaxSquareDeviation;
+   unsigned int u, uFlagCapacity;
+   long iSegments, iFlagged;
+   int iDivisionIndex;
+
+   uFlagCapacity = 0;
+
+   for (;;)
+      {
+      iSegments = compactPathRingsListSegments(pState);
+      if (iSegments < 0)
+         {
+         return FAILURE;
+         }
+
+      if ((unsigned int)iSegments > uFlagCapacity)
+         {
+         pGrownFlags = (unsigned char *)realloc(pState->pDivideFlags, (size_t)iSegments);
+         if (pGrownFlags == NULL)
+            {
+            return FAILURE;
+            }
+         pState->pDivideFlags = pGrownFlags;
+         uFlagCapacity = (unsigned int)iSegments;
+         }
+
+      iFlagged = compactPathRingsFindConflicts(pState, (unsigned int)iSegments);
+      if (iFlagged < 0)
+         {
+         return FAILURE;
+         }
+      if (iFlagged == 0)
+         {
+         return SUCCESS;
+         }
+
+      for (u = 0; u < (unsigned int)iSegments; ++u)
+         {
+         if (!pState->pDivideFlags[u])
+            {
+            continue;
+            }
+
+         pSegment = pState->pSegments + u;
+         pRing = pState->pRings + pSegment->uRing;
+         iDivisionIndex = pState->maxDeviationScan(pRing->pPointArray + pSegment->uStart,
+                                                   (int)(pSegment->uEnd - pSegment->uStart + 1),
+                                                   pState->deviationMetric,
+                                                   &dMaxSquareDeviation);
+
+         // If the points are all on the segment, dividing anywhere will make progress.
+         if (iDivisionIndex <= 0)
+            {
+            iDivisionIndex = (int)(pSegment->uEnd - pSegment->uStart) / 2;
+            }
+         pRing->pKeepFlags[pSegment->uStart + iDivisionIndex] = 1;
+         }
+      }
+   }
+
+// This is the cleanup macro for the compactPathRings function.
+#define COMPACT_PATH_RINGS_RETURN(iReturnValue)\
+   {\
+   free(state.pRings);\
+   free(pRotatedPoints);\
+   free(pKeepFlags);\
+   free(state.pSegments);\
+   free(state.pDivideFlags);\
+   free(state.puCellStarts);\
+   free(state.puCellSegments);\
+   return iReturnValue;\
+   }
+
+int compactPathRings(DVector2D *pPointArray, const unsigned int *puRingOffsets,
+                     unsigned int uRings, DVector2D *pResultPointArray,
+                     unsigned int *puResultOffsets, double dEpsilon,
+                     DeviationMetric deviationMetric, int iPreserveTopology)
+   {
+   CompactPathRings state;
+   CompactPathRing *pRing;
+   const DVector2D *pInput;
+   DVector2D *pRotatedPoints;
+   unsigned char *pKeepFlags;
+   unsigned int u, uRing, uPoints, uNumSolvedPoints, uRingStart;
+
+   memset(&state, 0, sizeof(state));
+   pRotatedPoints = NULL;
+   pKeepFlags = NULL;
+
+   // Check for invalid values.
+   if (pPointArray == NULL || puRingOffsets == NULL || pResultPointArray == NULL ||
+       puResultOffsets == NULL || !(dEpsilon >= 0.0) || deviationMetric == NULL ||
+       uRings > INT_MAX || puRingOffsets[uRings] > INT_MAX - uRings)
+      {
+      return FAILURE;
+      }
+   for (uRing = 0; uRing < uRings; ++uRing)
+      {
+      if (puRingOffsets[uRing + 1] < puRingOffsets[uRing])
+         {
+         return FAILURE;
+         }
+      }
+
+   state.uRings = uRings;
+   state.maxDeviationScan = compactPathSelectMaxDeviationScan(deviationMetric);
+   state.deviationMetric = deviationMetric;
+
+   // Every ring gets one extra point, for its first point repeated at the end.
+   state.pRings = (CompactPathRing *)malloc(sizeof(CompactPathRing) * (uRings + 1));
+   pRotatedPoints = (DVector2D *)malloc(sizeof(DVector2D) * (puRingOffsets[uRings] + uRings + 1));
+   pKeepFlags = (unsigned char *)malloc(puRingOffsets[uRings] + uRings + 1);
+   if (state.pRings == NULL || pRotatedPoints == NULL || pKeepFlags == NULL)
+      {
+      COMPACT_PATH_RINGS_RETURN(FAILURE);
+      }
+
+   for (uRing = 0; uRing < uRings; ++uRing)
+      {
+      pRing = state.pRings + uRing;
+      pInput = pPointArray + puRingOffsets[uRing];
+      uPoints = puRingOffsets[uRing + 1] - puRingOffsets[uRing];
+
+      pRing->pPointArray = pRotatedPoints + puRingOffsets[uRing] + uRing;
+      pRing->pKeepFlags = pKeepFlags + puRingOffsets[uRing] + uRing;
+      pRing->iClosed = uPoints >= 2 && pInput[uPoints - 1].dX == pInput[0].dX &&
+                       pInput[uPoints - 1].dY == pInput[0].dY;
+      pRing->uVertices = uPoints - (unsigned int)pRing->iClosed;
+      pRing->uAnchor = 0;
+
+      if (uPoints == 0)
+         {
+         continue;
+         }
+
+      if (!compactPathRingsCompact(&state, pRing, pInput, dEpsilon))
+         {
+         COMPACT_PATH_RINGS_RETURN(FAILURE);
+         }
+      }
+
+   if (iPreserveTopology && !compactPathRingsPreserveTopology(&state))
+      {
+      COMPACT_PATH_RINGS_RETURN(FAILURE);
+      }
+
+   // Every point has been copied out of pPointArray by now, so the result can go anywhere. The
+   // kept points of each ring go back in their original order.
+   uNumSolvedPoints = 0;
+   for (uRing = 0; uRing < uRings; ++uRing)
+      {
+      pRing = state.pRings + uRing;
+      puResultOffsets[uRing] = uNumSolvedPoints;
+      uRingStart = uNumSolvedPoints;
+
+      for (u = 0; u < pRing->uVertices; ++u)
+         {
+         uPoints = (u + pRing->uVertices - pRing->uAnchor) % pRing->uVertices;
+         if (pRing->pKeepFlags[uPoints])
+            {
+            pResultPointArray[uNumSolvedPoints] = pRing->pPointArray[uPoints];
+            ++uNumSolvedPoints;
+            }
+         }
+
+      if (pRing->iClosed)
+         {
+         pResultPointArray[uNumSolvedPoints] = pResultPointArray[uRingStart];
+         ++uNumSolvedPoints;
+         }
+      }
+   puResultOffsets[uRings] = uNumSolvedPoints;
+
+   COMPACT_PATH_RINGS_RETURN(SUCCESS);
+   }
@@ -0,0 +1,522 @@
+/*
+   PathCompacterSimd.c
+   10/15/2026
+   Authors: Michael Casebolt, Brett Casebolt
+*/
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Michael Casebolt and Brett Casebolt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// This file uses lines up to 100 characters long. If this 100 character line fits then you're good.
+
+// These are vectorized versions of the specialized scans in DeviationMetrics.c. Every kernel does
+// the same IEEE operations in the same order as the scalar metric bodies, just on 2, 4 or 8 points
+// at a time, so the results are bit-identical. That only holds if the compiler doesn't fuse the
+// multiplies and adds into FMAs, which AVX-512 would otherwise allow, so contraction is turned off
+// for this whole file.
+// Each lane keeps its own maximum and the index it was found at, using the same strict greater
+// than comparison as the scalar loop. Each lane sees its points in increasing index order, so when
+// the lanes are combined, picking the lowest index among the lanes that share the maximum gives
+// the same point the scalar loop would have picked.
+
+#include "PathCompacter.h"
+#include "PathCompacterInternal.h"
+
+#include <stddef.h> // For NULL
+#include <pthread.h> // For pthread_once
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define COMPACT_PATH_HAVE_X86_SIMD 1
+#endif
+
+#ifdef COMPACT_PATH_HAVE_X86_SIMD
+
+#include <immintrin.h> // For the SSE2, AVX2 and AVX-512 intrinsics
+
+#if defined(__clang__)
+#pragma clang fp contract(off)
+#else
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+// Combines the per-lane maximums and indices that a kernel stored, then finishes the points that
+// didn't fill a whole vector with the scalar metric.
+#define COMPACT_PATH_SIMD_FINISH(iLanes, metricBody)\
+   dMaxSquareDeviationInThisSegment = 0.0;\
+   iMaxPointIndex = 0;\
+   for (iLane = 0; iLane < (iLanes); ++iLane)\
+      {\
+      if (adLaneMax[iLane] > dMaxSquareDeviationInThisSegment ||\
+          (adLaneMax[iLane] == dMaxSquareDeviationInThisSegment && iMaxPointIndex != 0 &&\
+           (int)adLaneIndex[iLane] < iMaxPointIndex))\
+         {\
+         dMaxSquareDeviationInThisSegment = adLaneMax[iLane];\
+         iMaxPointIndex = (int)adLaneIndex[iLane];\
+         }\
+      }\
+   for (; i < iPointsInCurrentPath - 1; ++i)\
+      {\
+      dSquareDeviation = metricBody(pStart, pEnd, pPointArray + i, dSquareSegLen);\
+      if (dSquareDeviation > dMaxSquareDeviationInThisSegment)\
+         {\
+         iMaxPointIndex = i;\
+         dMaxSquareDeviationInThisSegment = dSquareDeviation;\
+         }\
+      }\
+   *pdMaxSquareDeviation = dMaxSquareDeviationInThisSegment;\
+   return iMaxPointIndex;
+
+// The locals and setup that every kernel shares. Degenerate chords are left to the scalar scan.
+#define COMPACT_PATH_SIMD_BEGIN(iLanes)\
+   const DVector2D *pStart, *pEnd;\
+   double dSquareSegLen, dSquareDeviation, dMaxSquareDeviationInThisSegment, dDX, dDY;\
+   double adLaneMax[iLanes], adLaneIndex[iLanes];\
+   int i, iLane, iMaxPointIndex;\
+   (void)deviationMetric;\
+   pStart = pPointArray;\
+   pEnd = pPointArray + iPointsInCurrentPath - 1;\
+   dDX = pEnd->dX - pStart->dX;\
+   dDY = pEnd->dY - pStart->dY;\
+   dSquareSegLen = dDX * dDX + dDY * dDY;\
+   if (dSquareSegLen == 0.0)\
+      {\
+      return compactPathFindMaxStartDistance(pPointArray, iPointsInCurrentPath,\
+                                             pdMaxSquareDeviation);\
+      }
+
+// SSE2 kernels. Two points per iteration.
+
+static int perpendicularDistanceScanSse2(const DVector2D *pPointArray, int iPointsInCurrentPath,
+                                         DeviationMetric deviationMetric,
+                                         double *pdMaxSquareDeviation)
+   {
+   __m128d vStartX, vStartY, vEndX, vEndY, vEndMinusStartY, vSquareSegLen;
+   __m128d vA, vB, vX, vY, vArea, vDeviation, vGreater, vMax, vIndex, vMaxIndex, vStep;
+   COMPACT_PATH_SIMD_BEGIN(2)
+
+   vStartX = _mm_set1_pd(pStart->dX);
+   vStartY = _mm_set1_pd(pStart->dY);
+   vEndX = _mm_set1_pd(pEnd->dX);
+   vEndY = _mm_set1_pd(pEnd->dY);
+   vEndMinusStartY = _mm_sub_pd(vEndY, vStartY);
+   vSquareSegLen = _mm_set1_pd(dSquareSegLen);
+   vMax = _mm_setzero_pd();
+   vMaxIndex = _mm_setzero_pd();
+   vIndex = _mm_set_pd(2.0, 1.0);
+   vStep = _mm_set1_pd(2.0);
+
+   for (i = 1; i + 2 <= iPointsInCurrentPath - 1; i += 2)
+      {
+      vA = _mm_loadu_pd(&pPointArray[i].dX);
+      vB = _mm_loadu_pd(&pPointArray[i + 1].dX);
+      vX = _mm_unpacklo_pd(vA, vB);
+      vY = _mm_unpackhi_pd(vA, vB);
+
+      vArea = _mm_add_pd(_mm_add_pd(_mm_mul_pd(vStartX, _mm_sub_pd(vY, vEndY)),
+                                    _mm_mul_pd(vX, vEndMinusStartY)),
+                         _mm_mul_pd(vEndX, _mm_sub_pd(vStartY, vY)));
+      vDeviation = _mm_div_pd(_mm_mul_pd(vArea, vArea), vSquareSegLen);
+
+      vGreater = _mm_cmpgt_pd(vDeviation, vMax);
+      vMax = _mm_or_pd(_mm_and_pd(vGreater, vDeviation), _mm_andnot_pd(vGreater, vMax));
+      vMaxIndex = _mm_or_pd(_mm_and_pd(vGreater, vIndex), _mm_andnot_pd(vGreater, vMaxIndex));
+      vIndex = _mm_add_pd(vIndex, vStep);
+      }
+
+   _mm_storeu_pd(adLaneMax, vMax);
+   _mm_storeu_pd(adLaneIndex, vMaxIndex);
+
+   COMPACT_PATH_SIMD_FINISH(2, compactPathPerpendicularDistance)
+   }
+
+static int shortestDistanceToSegmentScanSse2(const DVector2D *pPointArray,
+                                             int iPointsInCurrentPath,
+                                             DeviationMetric deviationMetric,
+                                             double *pdMaxSquareDeviation)
+   {
+   __m128d vStartX, vStartY, vEndX, vEndY, vEndMinusStartY, vSquareSegLen, vZero, vHalf;
+   __m128d vAX, vAY, vBX, vBY, vCX, vCY, vAdotB, vBdotC, vStartCase, vEndCase, vInside, vNearStart;
+   __m128d vA, vB, vX, vY, vArea, vDeviation, vGreater, vMax, vIndex, vMaxIndex, vStep;
+   COMPACT_PATH_SIMD_BEGIN(2)
+
+   vStartX = _mm_set1_pd(pStart->dX);
+   vStartY = _mm_set1_pd(pStart->dY);
+   vEndX = _mm_set1_pd(pEnd->dX);
+   vEndY = _mm_set1_pd(pEnd->dY);
+   vEndMinusStartY = _mm_sub_pd(vEndY, vStartY);
+   vSquareSegLen = _mm_set1_pd(dSquareSegLen);
+   vZero = _mm_setzero_pd();
+   vHalf = _mm_set1_pd(0.5);
+   vAX = _mm_sub_pd(vEndX, vStartX);
+   vAY = vEndMinusStartY;
+   vStartCase = _mm_add_pd(_mm_mul_pd(vAX, vAX), _mm_mul_pd(vAY, vAY));
+   vMax = _mm_setzero_pd();
+   vMaxIndex = _mm_setzero_pd();
+   vIndex = _mm_set_pd(2.0, 1.0);
+   vStep = _mm_set1_pd(2.0);
+
+   for (i = 1; i + 2 <= iPointsInCurrentPath - 1; i += 2)
+      {
+      vA = _mm_loadu_pd(&pPointArray[i].dX);
+      vB = _mm_loadu_pd(&pPointArray[i + 1].dX);
+      vX = _mm_unpacklo_pd(vA, vB);
+      vY = _mm_unpackhi_pd(vA, vB);
+
+      vBX = _mm_sub_pd(vX, vStartX);
+      vBY = _mm_sub_pd(vY, vStartY);
+      vCX = _mm_sub_pd(vX, vEndX);
+      vCY = _mm_sub_pd(vY, vEndY);
+      vAdotB = _mm_add_pd(_mm_mul_pd(vAX, vBX), _mm_mul_pd(vAY, vBY));
+      vBdotC = _mm_add_pd(_mm_mul_pd(vBX, vCX), _mm_mul_pd(vBY, vCY));
+      vEndCase = _mm_add_pd(_mm_mul_pd(vCX, vCX), _mm_mul_pd(vCY, vCY));
+
+      vArea = _mm_mul_pd(vHalf,
+                 _mm_add_pd(_mm_add_pd(_mm_mul_pd(vStartX, _mm_sub_pd(vY, vEndY)),
+                                       _mm_mul_pd(vX, vEndMinusStartY)),
+                            _mm_mul_pd(vEndX, _mm_sub_pd(vStartY, vY))));
+      vDeviation = _mm_div_pd(_mm_mul_pd(vArea, vArea), vSquareSegLen);
+
+      vInside = _mm_and_pd(_mm_cmpgt_pd(vAdotB, vZero), _mm_cmplt_pd(vBdotC, vZero));
+      vNearStart = _mm_and_pd(_mm_cmplt_pd(vAdotB, vZero), _mm_cmplt_pd(vBdotC, vZero));
+      vEndCase = _mm_or_pd(_mm_and_pd(vNearStart, vStartCase),
+                           _mm_andnot_pd(vNearStart, vEndCase));
+      vDeviation = _mm_or_pd(_mm_and_pd(vInside, vDeviation), _mm_andnot_pd(vInside, vEndCase));
+
+      vGreater = _mm_cmpgt_pd(vDeviation, vMax);
+      vMax = _mm_or_pd(_mm_and_pd(vGreater, vDeviation), _mm_andnot_pd(vGreater, vMax));
+      vMaxIndex = _mm_or_pd(_mm_and_pd(vGreater, vIndex), _mm_andnot_pd(vGreater, vMaxIndex));
+      vIndex = _mm_add_pd(vIndex, vStep);
+      }
+
+   _mm_storeu_pd(adLaneMax, vMax);
+   _mm_storeu_pd(adLaneIndex, vMaxIndex);
+
+   COMPACT_PATH_SIMD_FINISH(2, compactPathShortestDistanceToSegment)
+   }
+
+// AVX2 kernels. Four points per iteration. Unpacking two loads of two points each leaves the
+// points in the order 0, 2, 1, 3, so the lane indices start out in that order too.
+
+__attribute__((target("avx2")))
+static int perpendicularDistanceScanAvx2(const DVector2D *pPointArray, int iPointsInCurrentPath,
+                                         DeviationMetric deviationMetric,
+                                         double *pdMaxSquareDeviation)
+   {
+   __m256d vStartX, vStartY, vEndX, vEndY, vEndMinusStartY, vSquareSegLen;
+   __m256d vA, vB, vX, vY, vArea, vDeviation, vGreater, vMax, vIndex, vMaxIndex, vStep;
+   COMPACT_PATH_SIMD_BEGIN(4)
+
+   vStartX = _mm256_set1_pd(pStart->dX);
+   vStartY = _mm256_set1_pd(pStart->dY);
+   vEndX = _mm256_set1_pd(pEnd->dX);
+   vEndY = _mm256_set1_pd(pEnd->dY);
+   vEndMinusStartY = _mm256_sub_pd(vEndY, vStartY);
+   vSquareSegLen = _mm256_set1_pd(dSquareSegLen);
+   vMax = _mm256_setzero_pd();
+   vMaxIndex = _mm256_setzero_pd();
+   vIndex = _mm256_set_pd(4.0, 2.0, 3.0, 1.0);
+   vStep = _mm256_set1_pd(4.0);
+
+   for (i = 1; i + 4 <= iPointsInCurrentPath - 1; i += 4)
+      {
+      vA = _mm256_loadu_pd(&pPointArray[i].dX);
+      vB = _mm256_loadu_pd(&pPointArray[i + 2].dX);
+      vX = _mm256_unpacklo_pd(vA, vB);
+      vY = _mm256_unpackhi_pd(vA, vB);
+
+      vArea = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(vStartX, _mm256_sub_pd(vY, vEndY)),
+                                          _mm256_mul_pd(vX, vEndMinusStartY)),
+                            _mm256_mul_pd(vEndX, _mm256_sub_pd(vStartY, vY)));
+      vDeviation = _mm256_div_pd(_mm256_mul_pd(vArea, vArea), vSquareSegLen);
+
+      vGreater = _mm256_cmp_pd(vDeviation, vMax, _CMP_GT_OQ);
+      vMax = _mm256_blendv_pd(vMax, vDeviation, vGreater);
+      vMaxIndex = _mm256_blendv_pd(vMaxIndex, vIndex, vGreater);
+      vIndex = _mm256_add_pd(vIndex, vStep);
+      }
+
+   _mm256_storeu_pd(adLaneMax, vMax);
+   _mm256_storeu_pd(adLaneIndex, vMaxIndex);
+
+   COMPACT_PATH_SIMD_FINISH(4, compactPathPerpendicularDistance)
+   }
+
+__attribute__((target("avx2")))
+static int shortestDistanceToSegmentScanAvx2(const DVector2D *pPointArray,
+                                             int iPointsInCurrentPath,
+                                             DeviationMetric deviationMetric,
+                                             double *pdMaxSquareDeviation)
+   {
+   __m256d vStartX, vStartY, vEndX, vEndY, vEndMinusStartY, vSquareSegLen, vZero, vHalf;
+   __m256d vAX, vAY, vBX, vBY, vCX, vCY, vAdotB, vBdotC, vStartCase, vEndCase, vInside, vNearStart;
+   __m256d vA, vB, vX, vY, vArea, vDeviation, vGreater, vMax, vIndex, vMaxIndex, vStep;
+   COMPACT_PATH_SIMD_BEGIN(4)
+
+   vStartX = _mm256_set1_pd(pStart->dX);
+   vStartY = _mm256_set1_pd(pStart->dY);
+   vEndX = _mm256_set1_pd(pEnd->dX);
+   vEndY = _mm256_set1_pd(pEnd->dY);
+   vEndMinusStartY = _mm256_sub_pd(vEndY, vStartY);
+   vSquareSegLen = _mm256_set1_pd(dSquareSegLen);
+   vZero = _mm256_setzero_pd();
+   vHalf = _mm256_set1_pd(0.5);
+   vAX = _mm256_sub_pd(vEndX, vStartX);
+   vAY = vEndMinusStartY;
+   vStartCase = _mm256_add_pd(_mm256_mul_pd(vAX, vAX), _mm256_mul_pd(vAY, vAY));
+   vMax = _mm256_setzero_pd();
+   vMaxIndex = _mm256_setzero_pd();
+   vIndex = _mm256_set_pd(4.0, 2.0, 3.0, 1.0);
+   vStep = _mm256_set1_pd(4.0);
+
+   for (i = 1; i + 4 <= iPointsInCurrentPath - 1; i += 4)
+      {
+      vA = _mm256_loadu_pd(&pPointArray[i].dX);
+      vB = _mm256_loadu_pd(&pPointArray[i + 2].dX);
+      vX = _mm256_unpacklo_pd(vA, vB);
+      vY = _mm256_unpackhi_pd(vA, vB);
+
+      vBX = _mm256_sub_pd(vX, vStartX);
+      vBY = _mm256_sub_pd(vY, vStartY);
+      vCX = _mm256_sub_pd(vX, vEndX);
+      vCY = _mm256_sub_pd(vY, vEndY);
+      vAdotB = _mm256_add_pd(_mm256_mul_pd(vAX, vBX), _mm256_mul_pd(vAY, vBY));
+      vBdotC = _mm256_add_pd(_mm256_mul_pd(vBX, vCX), _mm256_mul_pd(vBY, vCY));
+      vEndCase = _mm256_add_pd(_mm256_mul_pd(vCX, vCX), _mm256_mul_pd(vCY, vCY));
+
+      vArea = _mm256_mul_pd(vHalf,
+                 _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(vStartX, _mm256_sub_pd(vY, vEndY)),
+                                             _mm256_mul_pd(vX, vEndMinusStartY)),
+                               _mm256_mul_pd(vEndX, _mm256_sub_pd(vStartY, vY))));
+      vDeviation = _mm256_div_pd(_mm256_mul_pd(vArea, vArea), vSquareSegLen);
+
+      vInside = _mm256_and_pd(_mm256_cmp_pd(vAdotB, vZero, _CMP_GT_OQ),
+                              _mm256_cmp_pd(vBdotC, vZero, _CMP_LT_OQ));
+      vNearStart = _mm256_and_pd(_mm256_cmp_pd(vAdotB, vZero, _CMP_LT_OQ),
+                                 _mm256_cmp_pd(vBdotC, vZero, _CMP_LT_OQ));
+      vEndCase = _mm256_blendv_pd(vEndCase, vStartCase, vNearStart);
+      vDeviation = _mm256_blendv_pd(vEndCase, vDeviation, vInside);
+
+      vGreater = _mm256_cmp_pd(vDeviation, vMax, _CMP_GT_OQ);
+      vMax = _mm256_blendv_pd(vMax, vDeviation, vGreater);
+      vMaxIndex = _mm256_blendv_pd(vMaxIndex, vIndex, vGreater);
+      vIndex = _mm256_add_pd(vIndex, vStep);
+      }
+
+   _mm256_storeu_pd(adLaneMax, vMax);
+   _mm256_storeu_pd(adLaneIndex, vMaxIndex);
+
+   COMPACT_PATH_SIMD_FINISH(4, compactPathShortestDistanceToSegment)
+   }
+
+// AVX-512 kernels. Eight points per iteration. Unpacking works within each 128 bit lane, so the
+// points come out in the order 0, 4, 1, 5, 2, 6, 3, 7.
+
+__attribute__((target("avx512f")))
+static int perpendicularDistanceScanAvx512(const DVector2D *pPointArray,
+                                           int iPointsInCurrentPath,
+                                           DeviationMetric deviationMetric,
+                                           double *pdMaxSquareDeviation)
+   {
+   __m512d vStartX, vStartY, vEndX, vEndY, vEndMinusStartY, vSquareSegLen;
+   __m512d vA, vB, vX, vY, vArea, vDeviation, vMax, vIndex, vMaxIndex, vStep;
+   __mmask8 greater;
+   COMPACT_PATH_SIMD_BEGIN(8)
+
+   vStartX = _mm512_set1_pd(pStart->dX);
+   vStartY = _mm512_set1_pd(pStart->dY);
+   vEndX = _mm512_set1_pd(pEnd->dX);
+   vEndY = _mm512_set1_pd(pEnd->dY);
+   vEndMinusStartY = _mm512_sub_pd(vEndY, vStartY);
+   vSquareSegLen = _mm512_set1_pd(dSquareSegLen);
+   vMax = _mm512_setzero_pd();
+   vMaxIndex = _mm512_setzero_pd();
+   vIndex = _mm512_set_pd(8.0, 4.0, 7.0, 3.0, 6.0, 2.0, 5.0, 1.0);
+   vStep = _mm512_set1_pd(8.0);
+
+   for (i = 1; i + 8 <= iPointsInCurrentPath - 1; i += 8)
+      {
+      vA = _mm512_loadu_pd(&pPointArray[i].dX);
+      vB = _mm512_loadu_pd(&pPointArray[i + 4].dX);
+      vX = _mm512_unpacklo_pd(vA, vB);
+      vY = _mm512_unpackhi_pd(vA, vB);
+
+      vArea = _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(vStartX, _mm512_sub_pd(vY, vEndY)),
+                                          _mm512_mul_pd(vX, vEndMinusStartY)),
+                            _mm512_mul_pd(vEndX, _mm512_sub_pd(vStartY, vY)));
+      vDeviation = _mm512_div_pd(_mm512_mul_pd(vArea, vArea), vSquareSegLen);
+
+      greater = _mm512_cmp_pd_mask(vDeviation, vMax, _CMP_GT_OQ);
+      vMax = _mm512_mask_blend_pd(greater, vMax, vDeviation);
+      vMaxIndex = _mm512_mask_blend_pd(greater, vMaxIndex, vIndex);
+      vIndex = _mm512_add_pd(vIndex, vStep);
+      }
+
+   _mm512_storeu_pd(adLaneMax, vMax);
+   _mm512_storeu_pd(adLaneIndex, vMaxIndex);
+
+   COMPACT_PATH_SIMD_FINISH(8, compactPathPerpendicularDistance)
+   }
+
+__attribute__((target("avx512f")))
+static int shortestDistanceToSegmentScanAvx512(const DVector2D *pPointArray,
+                                               int iPointsInCurrentPath,
+                                               DeviationMetric deviationMetric,
+                                               double *pdMaxSquareDeviation)
+   {
+   __m512d vStartX, vStartY, vEndX, vEndY, vEndMinusStartY, vSquareSegLen, vZero, vHalf;
+   __m512d vAX, vAY, vBX, vBY, vCX, vCY, vAdotB, vBdotC, vStartCase, vEndCase;
+   __m512d vA, vB, vX, vY, vArea, vDeviation, vMax, vIndex, vMaxIndex, vStep;
+   __mmask8 inside, nearStart, greater;
+   COMPACT_PATH_SIMD_BEGIN(8)
+
+   vStartX = _mm512_set1_pd(pStart->dX);
+   vStartY = _mm512_set1_pd(pStart->dY);
+   vEndX = _mm512_set1_pd(pEnd->dX);
+   vEndY = _mm512_set1_pd(pEnd->dY);
+   vEndMinusStartY = _mm512_sub_pd(vEndY, vStartY);
+   vSquareSegLen = _mm512_set1_pd(dSquareSegLen);
+   vZero = _mm512_setzero_pd();
+   vHalf = _mm512_set1_pd(0.5);
+   vAX = _mm512_sub_pd(vEndX, vStartX);
+   vAY = vEndMinusStartY;
+   vStartCase = _mm512_add_pd(_mm512_mul_pd(vAX, vAX), _mm512_mul_pd(vAY, vAY));
+   vMax = _mm512_setzero_pd();
+   vMaxIndex = _mm512_setzero_pd();
+   vIndex = _mm512_set_pd(8.0, 4.0, 7.0, 3.0, 6.0, 2.0, 5.0, 1.0);
+   vStep = _mm512_set1_pd(8.0);
+
+   for (i = 1; i + 8 <= iPointsInCurrentPath - 1; i += 8)
+      {
+      vA = _mm512_loadu_pd(&pPointArray[i].dX);
+      vB = _mm512_loadu_pd(&pPointArray[i + 4].dX);
+      vX = _mm512_unpacklo_pd(vA, vB);
+      vY = _mm512_unpackhi_pd(vA, vB);
+
+      vBX = _mm512_sub_pd(vX, vStartX);
+      vBY = _mm512_sub_pd(vY, vStartY);
+      vCX = _mm512_sub_pd(vX, vEndX);
+      vCY = _mm512_sub_pd(vY, vEndY);
+      vAdotB = _mm512_add_pd(_mm512_mul_pd(vAX, vBX), _mm512_mul_pd(vAY, vBY));
+      vBdotC = _mm512_add_pd(_mm512_mul_pd(vBX, vCX), _mm512_mul_pd(vBY, vCY));
+      vEndCase = _mm512_add_pd(_mm512_mul_pd(vCX, vCX), _mm512_mul_pd(vCY, vCY));
+
+      vArea = _mm512_mul_pd(vHalf,
+                 _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(vStartX, _mm512_sub_pd(vY, vEndY)),
+                                             _mm512_mul_pd(vX, vEndMinusStartY)),
+                               _mm512_mul_pd(vEndX, _mm512_sub_pd(vStartY, vY))));
+      vDeviation = _mm512_div_pd(_mm512_mul_pd(vArea, vArea), vSquareSegLen);
+
+      inside = _mm512_cmp_pd_mask(vAdotB, vZero, _CMP_GT_OQ) &
+               _mm512_cmp_pd_mask(vBdotC, vZero, _CMP_LT_OQ);
+      nearStart = _mm512_cmp_pd_mask(vAdotB, vZero, _CMP_LT_OQ) &
+                  _mm512_cmp_pd_mask(vBdotC, vZero, _CMP_LT_OQ);
+      vEndCase = _mm512_mask_blend_pd(nearStart, vEndCase, vStartCase);
+      vDeviation = _mm512_mask_blend_pd(inside, vEndCase, vDeviation);
+
+      greater = _mm512_cmp_pd_mask(vDeviation, vMax, _CMP_GT_OQ);
+      vMax = _mm512_mask_blend_pd(greater, vMax, vDeviation);
+      vMaxIndex = _mm512_mask_blend_pd(greater, vMaxIndex, vIndex);
+      vIndex = _mm512_add_pd(vIndex, vStep);
+      }
+
+   _mm512_storeu_pd(adLaneMax, vMax);
+   _mm512_storeu_pd(adLaneIndex, vMaxIndex);
+
+   COMPACT_PATH_SIMD_FINISH(8, compactPathShortestDistanceToSegment)
+   }
+
+#endif
+
+// The processor doesn't change while the program runs, so it only gets asked once.
+static pthread_once_t simdLevelOnce = PTHREAD_ONCE_INIT;
+static CompactPathSimdLevel detectedSimdLevel = COMPACT_PATH_SIMD_LEVEL_NONE;
+
+static void compactPathDetectSimdLevelOnce(void)
+   {
+#ifdef COMPACT_PATH_HAVE_X86_SIMD
+   // __builtin_cpu_supports reads the cpuid results that the runtime gathered at startup, and
+   // only reports AVX support when the operating system saves the wider registers.
+   __builtin_cpu_init();
+
+   if (__builtin_cpu_supports("avx512f"))
+      {
+      detectedSimdLevel = COMPACT_PATH_SIMD_LEVEL_AVX512;
+      }
+   else if (__builtin_cpu_supports("avx2"))
+      {
+      detectedSimdLevel = COMPACT_PATH_SIMD_LEVEL_AVX2;
+      }
+   else if (__builtin_cpu_supports("sse2"))
+      {
+      detectedSimdLevel = COMPACT_PATH_SIMD_LEVEL_SSE2;
+      }
+#endif
+   }
+
+CompactPathSimdLevel compactPathDetectSimdLevel(void)
+   {
+   pthread_once(&simdLevelOnce, compactPathDetectSimdLevelOnce);
+
+   return detectedSimdLevel;
+   }
+
+CompactPathMaxDeviationScan compactPathSelectSimdMaxDeviationScan(DeviationMetric deviationMetric,
+                                                                  CompactPathSimdLevel simdLevel)
+   {
+#ifdef COMPACT_PATH_HAVE_X86_SIMD
+   if (deviationMetric == perpendicularDistanceDeviationMetric)
+      {
+      switch (simdLevel)
+         {
+         case COMPACT_PATH_SIMD_LEVEL_AVX512:
+            return &perpendicularDistanceScanAvx512;
+         case COMPACT_PATH_SIMD_LEVEL_AVX2:
+            return &perpendicularDistanceScanAvx2;
+         case COMPACT_PATH_SIMD_LEVEL_SSE2:
+            return &perpendicularDistanceScanSse2;
+         default:
+            break;
+         }
+      }
+   else if (deviationMetric == shortestDistanceToSegmentDeviationMetric)
+      {
+      switch (simdLevel)
+         {
+         case COMPACT_PATH_SIMD_LEVEL_AVX512:
+            return &shortestDistanceToSegmentScanAvx512;
+         case COMPACT_PATH_SIMD_LEVEL_AVX2:
+            return &shortestDistanceToSegmentScanAvx2;
+         case COMPACT_PATH_SIMD_LEVEL_SSE2:
+            return &shortestDistanceToSegmentScanSse2;
+         default:
+            break;
+         }
+      }
+#else
+   (void)deviationMetric;
+   (void)simdLevel;
+#endif
+
+   return NULL;
+   }
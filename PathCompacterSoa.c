@@ -0,0 +1,345 @@
+/*
+   PathCompacterSoa.c
+   10/15/2026
+   Authors: Michael Casebolt, Brett Casebolt
+*/
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Michael Casebolt and Brett Casebolt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// This file uses lines up to 100 characters long. If this 100 character line fits then you're good.
+
+// These compacters take the X and Y coordinates in separate arrays, as doubles, floats or scaled
+// 32 bit integers, and report the kept points by index. Nothing gets converted or copied first.
+// The built in metrics are computed in the precision of the input: in double for doubles, in
+// float for floats, and in double on the unscaled integers for integers, with the scale applied
+// to the maximum afterwards. The integers and their differences convert to double exactly, but
+// the products and squares of the differences reach about 2^66 and round like any other double,
+// so the integer version is exactly compactPath on the converted values, not exact arithmetic.
+// Any other metric gets every point converted to a DVector2D on the way into the callback.
+
+#include "PathCompacter.h"
+#include "PathCompacterInternal.h"
+
+#define FAILURE 0
+#define SUCCESS 1
+
+typedef struct CompactPathSoaPath
+   {
+   const void *pX;
+   const void *pY;
+   double dScale;
+   DeviationMetric deviationMetric;
+   } CompactPathSoaPath;
+
+// The built in metrics, taking their coordinates one by one. The double versions go through the
+// shared bodies so that they agree exactly with the DVector2D compacters.
+static inline double compactPathSoaPerpendicularDistance(double dStartX, double dStartY,
+                                                         double dEndX, double dEndY,
+                                                         double dMidX, double dMidY,
+                                                         double dSquareSegmentLength)
+   {
+   DVector2D start, end, mid;
+
+   start.dX = dStartX;
+   start.dY = dStartY;
+   end.dX = dEndX;
+   end.dY = dEndY;
+   mid.dX = dMidX;
+   mid.dY = dMidY;
+
+   return compactPathPerpendicularDistance(&start, &end, &mid, dSquareSegmentLength);
+   }
+
+static inline double compactPathSoaShortestDistanceToSegment(double dStartX, double dStartY,
+                                                             double dEndX, double dEndY,
+                                                             double dMidX, double dMidY,
+                                                             double dSquareSegmentLength)
+   {
+   DVector2D start, end, mid;
+
+   start.dX = dStartX;
+   start.dY = dStartY;
+   end.dX = dEndX;
+   end.dY = dEndY;
+   mid.dX = dMidX;
+   mid.dY = dMidY;
+
+   return compactPathShortestDistanceToSegment(&start, &end, &mid, dSquareSegmentLength);
+   }
+
+// These are the same formulas as the shared bodies, in single precision.
+static inline float compactPathSoaPerpendicularDistanceFloat(float fStartX, float fStartY,
+                                                             float fEndX, float fEndY,
+                                                             float fMidX, float fMidY,
+                                                             float fSquareSegmentLength)
+   {
+   float fArea, fDX, fDY;
+
+   if (fSquareSegmentLength == 0.0f)
+      {
+      fDX = fMidX - fStartX;
+      fDY = fMidY - fStartY;
+      return fDX * fDX + fDY * fDY;
+      }
+
+   fArea = fStartX * (fMidY - fEndY) +
+           fMidX * (fEndY - fStartY) +
+           fEndX * (fStartY - fMidY);
+
+   return fArea * fArea / fSquareSegmentLength;
+   }
+
+static inline float compactPathSoaShortestDistanceToSegmentFloat(float fStartX, float fStartY,
+                                                                 float fEndX, float fEndY,
+                                                                 float fMidX, float fMidY,
+                                                                 float fSquareSegmentLength)
+   {
+   float fAX, fAY, fBX, fBY, fCX, fCY, fAdotB, fBdotC, fArea;
+
+   fAX = fEndX - fStartX;
+   fAY = fEndY - fStartY;
+   fBX = fMidX - fStartX;
+   fBY = fMidY - fStartY;
+   fCX = fMidX - fEndX;
+   fCY = fMidY - fEndY;
+
+   fAdotB = fAX * fBX + fAY * fBY;
+   fBdotC = fBX * fCX + fBY * fCY;
+
+   if (fAdotB > 0.0f && fBdotC < 0.0f)
+      {
+      fArea = 0.5f * (fStartX * (fMidY - fEndY) +
+                      fMidX * (fEndY - fStartY) +
+                      fEndX * (fStartY - fMidY));
+
+      return fArea * fArea / fSquareSegmentLength;
+      }
+   else if (fAdotB < 0.0f && fBdotC < 0.0f)
+      {
+      return fAX * fAX + fAY * fAY;
+      }
+   else
+      {
+      return fCX * fCX + fCY * fCY;
+      }
+   }
+
+// This stamps out a range scan with metricBody inlined, working in valueType on coordinates of
+// coordinateType. It is the same loop as the one in compactPathFindMaxDeviation.
+#define COMPACT_PATH_DEFINE_SOA_SCAN(scanName, coordinateType, valueType, metricBody)\
+   static int scanName(const void *pPath, unsigned int uStart, int iPointsInCurrentPath,\
+                       double *pdMaxSquareDeviation)\
+      {\
+      const CompactPathSoaPath *pSoaPath;\
+      const coordinateType *pX, *pY;\
+      valueType startX, startY, endX, endY, dX, dY, squareSegLen, squareDeviation, maxDeviation;\
+      int i, iMaxPointIndex;\
+      \
+      pSoaPath = (const CompactPathSoaPath *)pPath;\
+      pX = (const coordinateType *)pSoaPath->pX + uStart;\
+      pY = (const coordinateType *)pSoaPath->pY + uStart;\
+      \
+      maxDeviation = 0;\
+      iMaxPointIndex = 0;\
+      \
+      startX = (valueType)pX[0];\
+      startY = (valueType)pY[0];\
+      endX = (valueType)pX[iPointsInCurrentPath - 1];\
+      endY = (valueType)pY[iPointsInCurrentPath - 1];\
+      dX = endX - startX;\
+      dY = endY - startY;\
+      squareSegLen = dX * dX + dY * dY;\
+      \
+      for (i = 1; i < iPointsInCurrentPath - 1; ++i)\
+         {\
+         squareDeviation = metricBody(startX, startY, endX, endY, (valueType)pX[i],\
+                                      (valueType)pY[i], squareSegLen);\
+         \
+         if (squareDeviation > maxDeviation)\
+            {\
+            iMaxPointIndex = i;\
+            maxDeviation = squareDeviation;\
+            }\
+         }\
+      \
+      *pdMaxSquareDeviation = (double)maxDeviation * pSoaPath->dScale * pSoaPath->dScale;\
+      return iMaxPointIndex;\
+      }
+
+// This stamps out a range scan that calls the metric callback for every intermediate point.
+#define COMPACT_PATH_DEFINE_SOA_GENERIC_SCAN(scanName, coordinateType)\
+   static int scanName(const void *pPath, unsigned int uStart, int iPointsInCurrentPath,\
+                       double *pdMaxSquareDeviation)\
+      {\
+      const CompactPathSoaPath *pSoaPath;\
+      const coordinateType *pX, *pY;\
+      DVector2D start, end, mid;\
+      double dSquareSegLen, dSquareDeviation, dMaxSquareDeviationInThisSegment, dDX, dDY;\
+      int i, iMaxPointIndex;\
+      \
+      pSoaPath = (const CompactPathSoaPath *)pPath;\
+      pX = (const coordinateType *)pSoaPath->pX + uStart;\
+      pY = (const coordinateType *)pSoaPath->pY + uStart;\
+      \
+      dMaxSquareDeviationInThisSegment = 0.0;\
+      iMaxPointIndex = 0;\
+      \
+      start.dX = (double)pX[0] * pSoaPath->dScale;\
+      start.dY = (double)pY[0] * pSoaPath->dScale;\
+      end.dX = (double)pX[iPointsInCurrentPath - 1] * pSoaPath->dScale;\
+      end.dY = (double)pY[iPointsInCurrentPath - 1] * pSoaPath->dScale;\
+      dDX = end.dX - start.dX;\
+      dDY = end.dY - start.dY;\
+      dSquareSegLen = dDX * dDX + dDY * dDY;\
+      \
+      for (i = 1; i < iPointsInCurrentPath - 1; ++i)\
+         {\
+         mid.dX = (double)pX[i] * pSoaPath->dScale;\
+         mid.dY = (double)pY[i] * pSoaPath->dScale;\
+         dSquareDeviation = pSoaPath->deviationMetric(start, end, mid, dSquareSegLen);\
+         \
+         if (dSquareDeviation > dMaxSquareDeviationInThisSegment)\
+            {\
+            iMaxPointIndex = i;\
+            dMaxSquareDeviationInThisSegment = dSquareDeviation;\
+            }\
+         }\
+      \
+      *pdMaxSquareDeviation = dMaxSquareDeviationInThisSegment;\
+      return iMaxPointIndex;\
+      }
+
+COMPACT_PATH_DEFINE_SOA_SCAN(perpendicularDistanceSoaScan, double, double,
+                             compactPathSoaPerpendicularDistance)
+COMPACT_PATH_DEFINE_SOA_SCAN(shortestDistanceToSegmentSoaScan, double, double,
+                             compactPathSoaShortestDistanceToSegment)
+COMPACT_PATH_DEFINE_SOA_GENERIC_SCAN(genericSoaScan, double)
+
+COMPACT_PATH_DEFINE_SOA_SCAN(perpendicularDistanceSoaFloatScan, float, float,
+                             compactPathSoaPerpendicularDistanceFloat)
+COMPACT_PATH_DEFINE_SOA_SCAN(shortestDistanceToSegmentSoaFloatScan, float, float,
+                             compactPathSoaShortestDistanceToSegmentFloat)
+COMPACT_PATH_DEFINE_SOA_GENERIC_SCAN(genericSoaFloatScan, float)
+
+COMPACT_PATH_DEFINE_SOA_SCAN(perpendicularDistanceSoaInt32Scan, int32_t, double,
+                             compactPathSoaPerpendicularDistance)
+COMPACT_PATH_DEFINE_SOA_SCAN(shortestDistanceToSegmentSoaInt32Scan, int32_t, double,
+                             compactPathSoaShortestDistanceToSegment)
+COMPACT_PATH_DEFINE_SOA_GENERIC_SCAN(genericSoaInt32Scan, int32_t)
+
+// Picks one of the three scans for a layout, based on the metric.
+static CompactPathRangeScan compactPathSelectSoaScan(DeviationMetric deviationMetric,
+                                                     CompactPathRangeScan perpendicularScan,
+                                                     CompactPathRangeScan shortestScan,
+                                                     CompactPathRangeScan genericScan)
+   {
+   if (deviationMetric == perpendicularDistanceDeviationMetric)
+      {
+      return perpendicularScan;
+      }
+   else if (deviationMetric == shortestDistanceToSegmentDeviationMetric)
+      {
+      return shortestScan;
+      }
+   else
+      {
+      return genericScan;
+      }
+   }
+
+int compactPathKeptIndicesSoa(const double *pdX, const double *pdY,
+                              unsigned int uPointsInCurrentPath, uint32_t *puKeptIndices,
+                              unsigned int *puPointsInResultPath, double dEpsilon,
+                              DeviationMetric deviationMetric)
+   {
+   CompactPathSoaPath soaPath;
+
+   if (pdX == NULL || pdY == NULL || deviationMetric == NULL)
+      {
+      return FAILURE;
+      }
+
+   soaPath.pX = pdX;
+   soaPath.pY = pdY;
+   soaPath.dScale = 1.0;
+   soaPath.deviationMetric = deviationMetric;
+
+   return compactPathKeptIndicesWithRangeScan(&soaPath, uPointsInCurrentPath, puKeptIndices,
+                                              puPointsInResultPath, dEpsilon,
+                                              compactPathSelectSoaScan(deviationMetric,
+                                                 perpendicularDistanceSoaScan,
+                                                 shortestDistanceToSegmentSoaScan,
+                                                 genericSoaScan));
+   }
+
+int compactPathKeptIndicesSoaFloat(const float *pfX, const float *pfY,
+                                   unsigned int uPointsInCurrentPath, uint32_t *puKeptIndices,
+                                   unsigned int *puPointsInResultPath, double dEpsilon,
+                                   DeviationMetric deviationMetric)
+   {
+   CompactPathSoaPath soaPath;
+
+   if (pfX == NULL || pfY == NULL || deviationMetric == NULL)
+      {
+      return FAILURE;
+      }
+
+   soaPath.pX = pfX;
+   soaPath.pY = pfY;
+   soaPath.dScale = 1.0;
+   soaPath.deviationMetric = deviationMetric;
+
+   return compactPathKeptIndicesWithRangeScan(&soaPath, uPointsInCurrentPath, puKeptIndices,
+                                              puPointsInResultPath, dEpsilon,
+                                              compactPathSelectSoaScan(deviationMetric,
+                                                 perpendicularDistanceSoaFloatScan,
+                                                 shortestDistanceToSegmentSoaFloatScan,
+                                                 genericSoaFloatScan));
+   }
+
+int compactPathKeptIndicesSoaInt32(const int32_t *piX, const int32_t *piY, double dScale,
+                                   unsigned int uPointsInCurrentPath, uint32_t *puKeptIndices,
+                                   unsigned int *puPointsInResultPath, double dEpsilon,
+                                   DeviationMetric deviationMetric)
+   {
+   CompactPathSoaPath soaPath;
+
+   if (piX == NULL || piY == NULL || !(dScale > 0.0) || deviationMetric == NULL)
+      {
+      return FAILURE;
+      }
+
+   soaPath.pX = piX;
+   soaPath.pY = piY;
+   soaPath.dScale = dScale;
+   soaPath.deviationMetric = deviationMetric;
+
+   return compactPathKeptIndicesWithRangeScan(&soaPath, uPointsInCurrentPath, puKeptIndices,
+                                              puPointsInResultPath, dEpsilon,
+                                              compactPathSelectSoaScan(deviationMetric,
+                                                 perpendicularDistanceSoaInt32Scan,
+                                                 shortestDistanceToSegmentSoaInt32Scan,
+                                                 genericSoaInt32Scan));
+   }
@@ -0,0 +1,227 @@
+/*
+   PathCompacterStream.c
+   10/15/2026
+   Authors: Michael Casebolt, Brett Casebolt
+*/
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Michael Casebolt and Brett Casebolt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// This file uses lines up to 100 characters long. If this 100 character line fits then you're good.
+
+#include "PathCompacter.h"
+#include "PathCompacterInternal.h"
+
+#include <stdlib.h> // For memory management
+#include <string.h> // For memmove and memset
+
+#define FAILURE 0
+#define SUCCESS 1
+
+// A window smaller than this couldn't make progress after pinning its midpoint.
+#define COMPACT_PATH_STREAM_MIN_WINDOW 4
+
+struct PathCompacterStream
+   {
+   DVector2D *pWindow;
+   unsigned char *pKeepFlags;
+   int iWindowSize;
+   int iPointsInWindow;
+   int iFirstPointEmitted;
+   double dEpsilon;
+   DeviationMetric deviationMetric;
+   CompactPathMaxDeviationScan maxDeviationScan;
+   PathCompacterEmitCallback emitCallback;
+   void *pUserData;
+   };
+
+PathCompacterStream *compactPathStreamCreate(unsigned int uWindowSize, double dEpsilon,
+                                             DeviationMetric deviationMetric,
+                                             PathCompacterEmitCallback emitCallback,
+                                             void *pUserData)
+   {
+   PathCompacterStream *pStream;
+
+   if (uWindowSize < COMPACT_PATH_STREAM_MIN_WINDOW || uWindowSize > 0x7fffffff ||
+       !(dEpsilon >= 0.0) || deviationMetric == NULL || emitCallback == NULL)
+      {
+      return NULL;
+      }
+
+   pStream = (PathCompacterStream *)malloc(sizeof(PathCompacterStream));
+   if (pStream == NULL)
+      {
+      return NULL;
+      }
+
+   pStream->pWindow = (DVector2D *)malloc(sizeof(DVector2D) * uWindowSize);
+   pStream->pKeepFlags = (unsigned char *)malloc(uWindowSize);
+   if (pStream->pWindow == NULL || pStream->pKeepFlags == NULL)
+      {
+      compactPathStreamDestroy(pStream);
+      return NULL;
+      }
+
+   pStream->iWindowSize = (int)uWindowSize;
+   pStream->iPointsInWindow = 0;
+   pStream->iFirstPointEmitted = 0;
+   pStream->dEpsilon = dEpsilon;
+   pStream->deviationMetric = deviationMetric;
+   pStream->maxDeviationScan = compactPathSelectMaxDeviationScan(deviationMetric);
+   pStream->emitCallback = emitCallback;
+   pStream->pUserData = pUserData;
+
+   return pStream;
+   }
+
+void compactPathStreamDestroy(PathCompacterStream *pStream)
+   {
+   if (pStream != NULL)
+      {
+      free(pStream->pWindow);
+      free(pStream->pKeepFlags);
+      free(pStream);
+      }
+   }
+
+// Compacts the first iLastPoint + 1 points of the window with both ends fixed, and emits every
+// kept point after the first one (which has always been emitted already).
+static int compactPathStreamEmitRange(PathCompacterStream *pStream, int iLastPoint)
+   {
+   int i;
+
+   memset(pStream->pKeepFlags, 0, iLastPoint + 1);
+   pStream->pKeepFlags[iLastPoint] = 1;
+
+   if (!compactPathMarkSubproblem(pStream->pWindow, iLastPoint + 1, pStream->pKeepFlags,
+                                  pStream->dEpsilon, pStream->maxDeviationScan,
+                                  pStream->deviationMetric))
+      {
+      return FAILURE;
+      }
+
+   for (i = 1; i <= iLastPoint; ++i)
+      {
+      if (pStream->pKeepFlags[i])
+         {
+         pStream->emitCallback(pStream->pUserData, pStream->pWindow[i]);
+         }
+      }
+
+   return SUCCESS;
+   }
+
+// The window is full. Compact it, emit everything up to the start of the last linearized run,
+// and slide that run to the front of the window so that it can keep growing.
+static int compactPathStreamAdvance(PathCompacterStream *pStream)
+   {
+   int i, iLastPoint, iLastKept;
+
+   iLastPoint = pStream->iWindowSize - 1;
+
+   memset(pStream->pKeepFlags, 0, pStream->iWindowSize);
+   pStream->pKeepFlags[iLastPoint] = 1;
+
+   if (!compactPathMarkSubproblem(pStream->pWindow, pStream->iWindowSize, pStream->pKeepFlags,
+                                  pStream->dEpsilon, pStream->maxDeviationScan,
+                                  pStream->deviationMetric))
+      {
+      return FAILURE;
+      }
+
+   // Everything before the last kept intermediate point is final. Only the run after it could
+   // still turn out differently once more points arrive.
+   for (iLastKept = iLastPoint - 1; iLastKept > 0 && !pStream->pKeepFlags[iLastKept]; --iLastKept)
+      {
+      }
+
+   if (iLastKept >= pStream->iWindowSize / 2)
+      {
+      for (i = 1; i <= iLastKept; ++i)
+         {
+         if (pStream->pKeepFlags[i])
+            {
+            pStream->emitCallback(pStream->pUserData, pStream->pWindow[i]);
+            }
+         }
+      }
+   else
+      {
+      // The last run covers more than half the window, so sliding it forward wouldn't free up
+      // enough room. Pin the midpoint instead and compact the first half on its own, so that
+      // every dropped point is still measured against the segment that actually replaces it.
+      iLastKept = pStream->iWindowSize / 2;
+      if (!compactPathStreamEmitRange(pStream, iLastKept))
+         {
+         return FAILURE;
+         }
+      }
+
+   pStream->iPointsInWindow = pStream->iWindowSize - iLastKept;
+   memmove(pStream->pWindow, pStream->pWindow + iLastKept,
+           sizeof(DVector2D) * pStream->iPointsInWindow);
+
+   return SUCCESS;
+   }
+
+int compactPathStreamPush(PathCompacterStream *pStream, DVector2D point)
+   {
+   if (pStream->iPointsInWindow == pStream->iWindowSize)
+      {
+      if (!compactPathStreamAdvance(pStream))
+         {
+         return FAILURE;
+         }
+      }
+
+   pStream->pWindow[pStream->iPointsInWindow] = point;
+   ++pStream->iPointsInWindow;
+
+   // The first point of a path is always kept, so it can go out right away.
+   if (!pStream->iFirstPointEmitted)
+      {
+      pStream->emitCallback(pStream->pUserData, point);
+      pStream->iFirstPointEmitted = 1;
+      }
+
+   return SUCCESS;
+   }
+
+int compactPathStreamFlush(PathCompacterStream *pStream)
+   {
+   int iSuccess;
+
+   iSuccess = SUCCESS;
+
+   if (pStream->iPointsInWindow >= 2)
+      {
+      iSuccess = compactPathStreamEmitRange(pStream, pStream->iPointsInWindow - 1);
+      }
+
+   // Start over with a new path.
+   pStream->iPointsInWindow = 0;
+   pStream->iFirstPointEmitted = 0;
+
+   return iSuccess;
+   }
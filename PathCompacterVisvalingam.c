@@ -0,0 +1,293 @@
+/*
+   PathCompacterVisvalingam.c
+   10/15/2026
+   Authors: Michael Casebolt, Brett Casebolt
+*/
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Michael Casebolt and Brett Casebolt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// This file uses lines up to 100 characters long. If this 100 character line fits then you're good.
+
+// This is the Visvalingam-Whyatt algorithm. Every intermediate point is rated by the area of the
+// triangle it forms with its neighbours, and the point with the smallest area keeps getting
+// removed until none is left below the threshold. Removing a point changes the triangles of its
+// two neighbours, so their areas are worked out again, but never allowed to drop below the area
+// of the point that was just removed. That way the points come off in a consistent order, and the
+// area of a point tells how much the path had already been simplified when it went.
+// https://en.wikipedia.org/wiki/Visvalingam%E2%80%93Whyatt_algorithm
+
+#include "PathCompacter.h"
+#include "PathCompacterInternal.h"
+
+#include <string.h> // For memmove and memset
+#include <stdint.h> // For uint32_t
+#include <limits.h> // For INT_MAX
+#include <math.h> // For fabs and HUGE_VAL
+
+#define FAILURE 0
+#define SUCCESS 1
+
+// The scratch memory holds all of these, one of each for every point of the path.
+typedef struct CompactPathVisvalingam
+   {
+   const DVector2D *pPointArray;
+   double *pdArea;
+   uint32_t *puPrevious;
+   uint32_t *puNext;
+   uint32_t *puHeapPosition;
+   uint32_t *puHeap;
+   unsigned int uHeapSize;
+   } CompactPathVisvalingam;
+
+#define COMPACT_PATH_VISVALINGAM_BYTES_PER_POINT (sizeof(double) + 4 * sizeof(uint32_t))
+
+static double compactPathVisvalingamArea(const CompactPathVisvalingam *pState, uint32_t uPoint)
+   {
+   const DVector2D *pA, *pB, *pC;
+   double dArea;
+
+   pA = pState->pPointArray + pState->puPrevious[uPoint];
+   pB = pState->pPointArray + uPoint;
+   pC = pState->pPointArray + pState->puNext[uPoint];
+
+   dArea = 0.5 * fabs(pA->dX * (pB->dY - pC->dY) +
+                      pB->dX * (pC->dY - pA->dY) +
+                      pC->dX * (pA->dY - pB->dY));
+
+   // A NaN would break the ordering of the heap. A point that can't be rated is never removed.
+   return dArea == dArea ? dArea : HUGE_VAL;
+   }
+
+// Smaller areas come first, and equal areas go in path order so that the result doesn't depend
+// on how the heap happens to be laid out.
+static int compactPathVisvalingamBefore(const CompactPathVisvalingam *pState, uint32_t uA,
+                                        uint32_t uB)
+   {
+   if (pState->pdArea[uA] != pState->pdArea[uB])
+      {
+      return pState->pdArea[uA] < pState->pdArea[uB];
+      }
+   return uA < uB;
+   }
+
+static void compactPathVisvalingamPlace(CompactPathVisvalingam *pState, unsigned int uPosition,
+                                        uint32_t uPoint)
+   {
+   pState->puHeap[uPosition] = uPoint;
+   pState->puHeapPosition[uPoint] = uPosition;
+   }
+
+// Moves the point at uPosition down the heap until it is in order again.
+static void compactPathVisvalingamSiftDown(CompactPathVisvalingam *pState, unsigned int uPosition)
+   {
+   uint32_t uPoint;
+   unsigned int uChild;
+
+   uPoint = pState->puHeap[uPosition];
+
+   for (;;)
+      {
+      uChild = 2 * uPosition + 1;
+      if (uChild >= pState->uHeapSize)
+         {
+         break;
+         }
+      if (uChild + 1 < pState->uHeapSize &&
+          compactPathVisvalingamBefore(pState, pState->puHeap[uChild + 1],
+                                       pState->puHeap[uChild]))
+         {
+         ++uChild;
+         }
+      if (!compactPathVisvalingamBefore(pState, pState->puHeap[uChild], uPoint))
+         {
+         break;
+         }
+      compactPathVisvalingamPlace(pState, uPosition, pState->puHeap[uChild]);
+      uPosition = uChild;
+      }
+
+   compactPathVisvalingamPlace(pState, uPosition, uPoint);
+   }
+
+// Moves the point at uPosition up or down the heap until it is in order again.
+static void compactPathVisvalingamSift(CompactPathVisvalingam *pState, unsigned int uPosition)
+   {
+   uint32_t uPoint;
+   unsigned int uParent;
+
+   uPoint = pState->puHeap[uPosition];
+
+   while (uPosition > 0)
+      {
+      uParent = (uPosition - 1) / 2;
+      if (!compactPathVisvalingamBefore(pState, uPoint, pState->puHeap[uParent]))
+         {
+         break;
+         }
+      compactPathVisvalingamPlace(pState, uPosition, pState->puHeap[uParent]);
+      uPosition = uParent;
+      }
+
+   compactPathVisvalingamPlace(pState, uPosition, uPoint);
+   compactPathVisvalingamSiftDown(pState, uPosition);
+   }
+
+// Works the area of an intermediate point out again after one of its neighbours went away.
+static void compactPathVisvalingamUpdate(CompactPathVisvalingam *pState, uint32_t uPoint,
+                                         uint32_t uLastPoint, double dRemovedArea)
+   {
+   double dArea;
+
+   if (uPoint == 0 || uPoint == uLastPoint)
+      {
+      return;
+      }
+
+   dArea = compactPathVisvalingamArea(pState, uPoint);
+   pState->pdArea[uPoint] = dArea > dRemovedArea ? dArea : dRemovedArea;
+   compactPathVisvalingamSift(pState, pState->puHeapPosition[uPoint]);
+   }
+
+int compactPathVisvalingamWithContext(PathCompacterContext *pContext, DVector2D *pPointArray,
+                                      unsigned int uPointsInCurrentPath,
+                                      DVector2D *pResultPointArray,
+                                      unsigned int *puPointsInResultPath, double dEpsilon)
+   {
+   CompactPathVisvalingam state;
+   unsigned char *pScratch;
+   double dThreshold, dRemovedArea;
+   uint32_t uPoint, uLastPoint;
+   unsigned int u, uNumKept;
+
+   // Check for invalid values.
+   if (uPointsInCurrentPath > INT_MAX || pPointArray == NULL || pResultPointArray == NULL ||
+       puPointsInResultPath == NULL || !(dEpsilon >= 0.0))
+      {
+      return FAILURE;
+      }
+
+   if (pContext->pStats != NULL)
+      {
+      memset(pContext->pStats, 0, sizeof(PathCompacterStats));
+      }
+
+   // Paths with fewer than three points are already solved.
+   if (uPointsInCurrentPath < 3)
+      {
+      if (pResultPointArray != pPointArray && uPointsInCurrentPath > 0)
+         {
+         memmove(pResultPointArray, pPointArray, sizeof(DVector2D) * uPointsInCurrentPath);
+         }
+      *puPointsInResultPath = uPointsInCurrentPath;
+      return SUCCESS;
+      }
+
+   pScratch = (unsigned char *)compactPathContextGrowScratch(
+      pContext, COMPACT_PATH_VISVALINGAM_BYTES_PER_POINT * uPointsInCurrentPath, 0);
+   if (pScratch == NULL)
+      {
+      return FAILURE;
+      }
+
+   state.pPointArray = pPointArray;
+   state.pdArea = (double *)pScratch;
+   state.puPrevious = (uint32_t *)(state.pdArea + uPointsInCurrentPath);
+   state.puNext = state.puPrevious + uPointsInCurrentPath;
+   state.puHeapPosition = state.puNext + uPointsInCurrentPath;
+   state.puHeap = state.puHeapPosition + uPointsInCurrentPath;
+
+   uLastPoint = uPointsInCurrentPath - 1;
+   for (u = 0; u < uPointsInCurrentPath; ++u)
+      {
+      state.puPrevious[u] = u - 1;
+      state.puNext[u] = u + 1;
+      }
+
+   // The intermediate points go into the heap in path order, and then it gets put in order from
+   // the bottom up.
+   state.uHeapSize = uPointsInCurrentPath - 2;
+   for (u = 1; u < uLastPoint; ++u)
+      {
+      state.pdArea[u] = compactPathVisvalingamArea(&state, u);
+      compactPathVisvalingamPlace(&state, u - 1, u);
+      }
+   for (u = state.uHeapSize / 2; u > 0; --u)
+      {
+      compactPathVisvalingamSiftDown(&state, u - 1);
+      }
+
+   dThreshold = dEpsilon * dEpsilon;
+   while (state.uHeapSize > 0 && state.pdArea[state.puHeap[0]] < dThreshold)
+      {
+      uPoint = state.puHeap[0];
+      dRemovedArea = state.pdArea[uPoint];
+
+      --state.uHeapSize;
+      if (state.uHeapSize > 0)
+         {
+         compactPathVisvalingamPlace(&state, 0, state.puHeap[state.uHeapSize]);
+         compactPathVisvalingamSiftDown(&state, 0);
+         }
+
+      state.puNext[state.puPrevious[uPoint]] = state.puNext[uPoint];
+      state.puPrevious[state.puNext[uPoint]] = state.puPrevious[uPoint];
+
+      compactPathVisvalingamUpdate(&state, state.puPrevious[uPoint], uLastPoint, dRemovedArea);
+      compactPathVisvalingamUpdate(&state, state.puNext[uPoint], uLastPoint, dRemovedArea);
+      }
+
+   // The remaining points are linked in path order, so no kept point moves to a higher index and
+   // this is safe in place.
+   uNumKept = 0;
+   for (uPoint = 0; uPoint != uLastPoint; uPoint = state.puNext[uPoint])
+      {
+      pResultPointArray[uNumKept] = pPointArray[uPoint];
+      ++uNumKept;
+      }
+   pResultPointArray[uNumKept] = pPointArray[uLastPoint];
+   ++uNumKept;
+
+   *puPointsInResultPath = uNumKept;
+
+   return SUCCESS;
+   }
+
+int compactPathVisvalingam(DVector2D *pPointArray, unsigned int uPointsInCurrentPath,
+                           DVector2D *pResultPointArray, unsigned int *puPointsInResultPath,
+                           double dEpsilon)
+   {
+   PathCompacterContext context;
+   int iSuccess;
+
+   compactPathContextInit(&context, NULL, NULL, NULL);
+
+   iSuccess = compactPathVisvalingamWithContext(&context, pPointArray, uPointsInCurrentPath,
+                                                pResultPointArray, puPointsInResultPath,
+                                                dEpsilon);
+
+   compactPathContextRelease(&context);
+
+   return iSuccess;
+   }